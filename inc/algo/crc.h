@@ -32,6 +32,11 @@ extern "C" {
 #include <tbx_types.h>
 #include <toolbox_defs.h>
 
+/*
+ * Polynomials for CRC7
+ */
+#define CRC7_MMC           (0x09)   /*!< MMC/SD command and register CRC */
+
 /*
  * Polynomials for CRC8
  */
@@ -97,6 +102,12 @@ uint8_t CRC8_buffer (uint8_t poly, CRC_BitOrder_en bo, uint8_t crc, const byte_t
 uint16_t CRC16_byte (uint16_t poly, CRC_BitOrder_en bo, uint16_t crc, byte_t b);
 uint16_t CRC16_buffer (uint16_t poly, CRC_BitOrder_en bo, uint16_t crc, const byte_t *data, bytecount_t size);
 
+/*
+ * Table driven CRCs of fixed polynomials
+ */
+uint8_t CRC7_MMC_buffer (uint8_t crc, const byte_t *data, bytecount_t size);
+uint16_t CRC16_CCITT_buffer (uint16_t crc, const byte_t *data, bytecount_t size);
+
 
 
 
@@ -48,6 +48,16 @@ extern "C" {
 #define NMEA_IS_DELIMITER(_c)    (_c == ',' || _c == '*' || _c == '\r')
 #define NMEA_TOKEN_SIZE          (12)
 
+/*!
+ * \name Push parser states
+ */
+//!@{
+#define NMEA_PS_HUNT             (0)   /*!< Waiting for '$' */
+#define NMEA_PS_BODY             (1)   /*!< Between '$' and '*' */
+#define NMEA_PS_CS_HI            (2)   /*!< Checksum high nibble */
+#define NMEA_PS_CS_LO            (3)   /*!< Checksum low nibble */
+//!@}
+
 
 /*
  * ============ Data types ============
@@ -250,6 +260,35 @@ typedef struct {
    int         zone_m;        //!< Local minutes time zone (minute offset)
 }nmea_zda_t;
 
+/*!
+ * Latest value table, kept by nmea_push(). As with the nmea_read_xxx()
+ * functions, an entry is written only when its sentence carries valid data.
+ */
+typedef struct {
+   nmea_gga_t     gga;        //!< Last valid GGA
+   nmea_gll_t     gll;        //!< Last valid GLL
+   nmea_gsa_t     gsa;        //!< Last valid GSA
+   nmea_gsv_t     gsv;        //!< Last valid GSV
+   nmea_rmc_t     rmc;        //!< Last valid RMC
+   nmea_vtg_t     vtg;        //!< Last valid VTG
+   nmea_zda_t     zda;        //!< Last valid ZDA
+   uint32_t       updated;    //!< Entries written since their nmea_get(), bit (1<<nmea_msgid_en)
+}nmea_data_t;
+
+/*!
+ * Push parser state
+ */
+typedef struct {
+   int            len;        //!< Sentence bytes in buffer
+   uint8_t        st;         //!< Parser state, NMEA_PS_xxx
+   byte_t         cs;         //!< Running checksum
+   byte_t         rcs;        //!< Received checksum
+   uint32_t       sentences;  //!< Checksum valid sentences
+   uint32_t       errors;     //!< Checksum errors, broken and too long sentences
+}nmea_push_t;
+
+struct nmea_s;
+
 /*!
  * \name interface types
  */
@@ -257,6 +296,13 @@ typedef struct {
 typedef byte_t (*nmea_in_ft) (void);      //!< Input function pointer
 typedef int    (*nmea_out_ft) (byte_t);   //!< Output function pointer
 
+/*!
+ * Sentence callback. Called by nmea_push() for each checksum valid sentence
+ * of a recognised type, after the latest value table update.
+ * \a st is DRV_READY if the sentence carried valid data, DRV_BUSY otherwise.
+ */
+typedef void (*nmea_sentence_ft) (struct nmea_s *nmea, nmea_msgid_en id, drv_status_en st);
+
 /*!
  * In/Out type
  */
@@ -269,10 +315,13 @@ typedef struct {
 /*!
  * NMEA public data type
  */
-typedef struct {
+typedef struct nmea_s {
    byte_t         *buf;       //!< Pointer to sentence buffer
    int            buf_size;   //!< Buffer size
    nmea_io_t      io;         //!< Module's input output
+   nmea_sentence_ft  sentence;   //!< Sentence callback - Optional
+   nmea_push_t    push;       //!< Push parser state
+   nmea_data_t    data;       //!< Latest value table
    drv_status_en  status;     //!< Driver's status
 }nmea_t;
 
@@ -290,6 +339,7 @@ void mnea_unused (void);
 void nmea_link_buffer (nmea_t *nmea, byte_t *b);
 void nmea_link_in (nmea_t *nmea, nmea_in_ft in);
 void nmea_link_out (nmea_t *nmea, nmea_out_ft out);
+void nmea_link_sentence (nmea_t *nmea, nmea_sentence_ft fun);
 //!@}
 
 /*
@@ -315,8 +365,37 @@ drv_status_en nmea_read_vtg (nmea_t *nmea, nmea_vtg_t *vtg);
 drv_status_en nmea_read_zda (nmea_t *nmea, nmea_zda_t *zdas);
 
 drv_status_en nmea_write( nmea_t *nmea, char *msg);
+
+int nmea_push (nmea_t *nmea, const byte_t *data, int n);
+drv_status_en nmea_get (nmea_t *nmea, nmea_msgid_en id, void *data);
 //!@}
 
+/*!
+ * \note
+ *    nmea_read_xxx() block on the input function until the requested sentence
+ *    arrives, and drop the others. nmea_push() instead takes whatever the
+ *    receiver has sent so far and never blocks. Each complete sentence updates
+ *    nmea->data and calls the sentence callback, so all sentence types are
+ *    served in one pass. Both use the sentence buffer, so do not mix them on
+ *    the same nmea_t.
+ *    nmea->data has no locking. Call nmea_push() and nmea_get() from the same
+ *    context, ex: a task that drains the rx interrupt's ring buffer or a DMA
+ *    buffer. A nmea_push() from the interrupt itself could rewrite an entry
+ *    while nmea_get() copies it.
+ * \code
+ *    static byte_t sen[83];                    // 82 characters max, plus the terminator
+ *    nmea_link_buffer (&gps, sen);
+ *    nmea_set_buffer_size (&gps, sizeof (sen));
+ *    nmea_link_sentence (&gps, on_sentence);   // optional
+ *    nmea_init (&gps);
+ *
+ *    n = uart_read (rx, sizeof (rx));          // from the rx ring buffer, in the task
+ *    nmea_push (&gps, rx, n);
+ *    if (nmea_get (&gps, NMEA_RMC, &rmc) == DRV_READY)
+ *       ...   // a new valid RMC
+ * \endcode
+ */
+
 
 
 #ifdef __cplusplus
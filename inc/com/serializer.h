@@ -69,6 +69,11 @@ extern "C" {
  *    {0,0,0}
  * };
  *
+ * Varint types have a variable serialized size. serialize_size() and
+ * ser_plan_t::size report their worst case of 3, 5 and 10 bytes for the
+ * 16, 32 and 64bit members. Delta types encode the difference from the
+ * previous record of a batch or sink, the first record against zero.
+ *
  * int main () {
  *    uint8_t buffer[32];
  *    serialize ((void*)buffer, (void*)&serTest, sch, SER_BIG_ENDIAN);
@@ -80,6 +85,9 @@ extern "C" {
 typedef struct {
    enum {
       s_none=0, s_pad, s_u8, s_u16, s_u32, s_u64, s_i8, s_i16, s_i32, s_i64, s_f32, s_f64,
+      s_uv16, s_uv32, s_uv64,    //!< Unsigned members as LEB128 varints
+      s_sv16, s_sv32, s_sv64,    //!< Signed members as zigzag varints
+      s_dv16, s_dv32, s_dv64,    //!< Members as zigzag varints of their difference from the previous record
    }           type;    //!< Type of data to transfer
    size_t      times;   //!< How many times to repeat the current, while advancing offset
                         //!  This is used for arrays
@@ -94,10 +102,97 @@ typedef enum {
    SER_LITTLE_ENDIAN    //!< Select LITTLE_ENDIAN
 }ser_endian_en;
 
+#ifndef SER_STACK_OPS
+#define SER_STACK_OPS      (16)     //!< Ops of the plan serialize()/deserialize() compile on stack
+#endif
+
+/*!
+ * Compiled schema instruction types
+ */
+typedef enum {
+   ser_op_copy =0,      //!< Copy \a len bytes as they are
+   ser_op_pad,          //!< Write \a len pad bytes of \a value, skip them when reading
+   ser_op_swap16,       //!< Byte swap \a len 16bit elements
+   ser_op_swap32,       //!< Byte swap \a len 32bit elements
+   ser_op_swap64,       //!< Byte swap \a len 64bit elements
+   ser_op_varint,       //!< Varint encode \a len elements, \a value holds the element size and kind
+}ser_op_en;
+
+/*!
+ * Compiled schema instruction. Adjacent schema entries that are also
+ * adjacent in the struct are merged to a single instruction.
+ */
+typedef struct {
+   uint8_t     type;    //!< Instruction type \sa ser_op_en
+   uint8_t     value;   //!< The pad value, or the varint element size and kind
+   size_t      offset;  //!< The struct offset of the first element
+   size_t      len;     //!< Bytes for copy and pad, elements for swaps and varints
+}ser_op_t;
+
+/*!
+ * Compiled schema. A flat instruction list for a schema and an endian
+ * \example
+ * \code
+ * ser_op_t       ops[8];
+ * ser_plan_t     plan;
+ *
+ * ser_compile (&plan, ops, 8, sch, SER_BIG_ENDIAN);
+ * serialize_plan ((void*)buffer, (void*)&serTest, &plan);
+ * deserialize_plan ((void*)&serTest, (void*)buffer, &plan);
+ * \endcode
+ */
+typedef struct {
+   ser_op_t       *op;     //!< The instruction list
+   size_t         n;       //!< Number of instructions
+   size_t         size;    //!< The serialized size, the worst case for varints
+   ser_endian_en  endian;  //!< The compiled endian
+}ser_plan_t;
+
+/*!
+ * Chunk write back-end of a serializer sink. Gets the back-end's context,
+ * the data and their size. Returns the number of written bytes.
+ */
+typedef int (*ser_write_ft) (void* ctx, const void* data, size_t n);
+
+/*!
+ * Serializer sink. Records are encoded straight to the sink's buffer, which
+ * can be the transport's own buffer, and the buffer is handed to \a write
+ * when the next record does not fit.
+ * All the records pushed to a sink form a single delta chain, as with
+ * serialize_batch(), so the back-end's data decode with deserialize_batch().
+ * The sink keeps a copy of the last record in \a prev for the next call.
+ */
+typedef struct {
+   ser_write_ft   write;   //!< The back-end
+   void*          ctx;     //!< The back-end's context
+   uint8_t*       buf;     //!< The chunk buffer
+   size_t         size;    //!< The chunk buffer's size
+   size_t         len;     //!< Used bytes in buffer
+   size_t         count;   //!< Total bytes encoded
+   uint8_t*       prev;    //!< The last record, the delta base of the next one
+   size_t         rec;     //!< The size of prev
+}ser_sink_t;
+
 size_t serialize_size (const ser_schema_t* schema);
 size_t serialize (void* to, void* from, const ser_schema_t* schema, ser_endian_en endian);
 size_t deserialize (void* to, void* from, const ser_schema_t* schema, ser_endian_en endian);
 
+int ser_compile (ser_plan_t* plan, ser_op_t* ops, size_t size, const ser_schema_t* schema, ser_endian_en endian);
+size_t serialize_plan (void* to, const void* from, const ser_plan_t* plan);
+size_t deserialize_plan (void* to, const void* from, const ser_plan_t* plan);
+size_t serialize_delta (void* to, const void* from, const void* prev, const ser_plan_t* plan);
+size_t deserialize_delta (void* to, const void* from, const void* prev, const ser_plan_t* plan);
+
+size_t serialize_batch (void* to, const void* from, size_t stride, size_t n, const ser_plan_t* plan);
+size_t deserialize_batch (void* to, const void* from, size_t stride, size_t n, const ser_plan_t* plan);
+
+void ser_sink_init (ser_sink_t* sk, ser_write_ft write, void* ctx, void* buf, size_t size, void* prev, size_t rec);
+int ser_sink_flush (ser_sink_t* sk);
+size_t serialize_sink (ser_sink_t* sk, const void* from, size_t stride, size_t n, const ser_plan_t* plan);
+
+size_t serialize_soa (void* to, const void* from, size_t stride, size_t n, const ser_schema_t* schema, ser_endian_en endian);
+size_t deserialize_soa (void* to, const void* from, size_t stride, size_t n, const ser_schema_t* schema, ser_endian_en endian);
+
 
 #ifdef __cplusplus
 }
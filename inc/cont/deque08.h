@@ -34,6 +34,7 @@ extern "C" {
 #include <stdarg.h>
 
 typedef void (*deque_callback_ft)(void);
+typedef void (*deque_notify_ft)(void*, uint32_t);   //!< Event notification. Gets the user's context and the events
 
 typedef enum {
    DISABLED =0,   //!< Disable the trigger
@@ -57,6 +58,28 @@ typedef struct {
 }deque08_trigger_t;
 
 
+/*!
+ * Edge triggered deque events
+ * \note
+ *    The deque, its pending events included, has no locking. Push, pop and
+ *    deque08_events() must run in the same context, ex: a task that drains
+ *    the rx interrupt's buffer to the deque. The notify function gets the
+ *    events of each push/pop in that context and can pass them on.
+ */
+#define  DEQUE08_EV_HIGH      (0x01)   //!< Size crossed up to high watermark
+#define  DEQUE08_EV_LOW       (0x02)   //!< Size crossed down to low watermark
+#define  DEQUE08_EV_DELIM     (0x04)   //!< A delimiter byte arrived
+
+typedef struct {
+   deque_notify_ft   notify;     /*!< Pointer to notification function (called in push/pop context) */
+   void              *ctx;       /*!< User's context for notify */
+   iterator_t        high, low;  /*!< The watermarks */
+   iterator_t        ndelim;     /*!< The number of delimiters currently in deque */
+   byte_t            delim;      /*!< The delimiter byte */
+   uint8_t           en;         /*!< Enabled events mask */
+   volatile uint8_t  pending;    /*!< Pending events mask, push/pop context only \sa deque08_events() */
+}deque08_event_t;
+
 typedef struct {
    byte_t      *m;         /*!< pointer to queue's buffer */
    iterator_t  capacity;   /*!< queue's max item capacity */
@@ -64,7 +87,8 @@ typedef struct {
    iterator_t  f, r;       /*!< queue iterators */
    deque08_trigger_t
                trigger;
-
+   deque08_event_t
+               ev;         /*!< Edge triggered events */
 }deque08_t;
 
 
@@ -86,6 +110,9 @@ void deque08_link_buffer (deque08_t *q, byte_t* buf);
 void deque08_set_capacity (deque08_t *q, size_t capacity);
 bool deque08_set_trigger (deque08_t *q, deque_callback_ft callback, trigger_mode_en mode, int value);
 void deque08_clear_trigger (deque08_t *q);
+void deque08_set_notify (deque08_t *q, deque_notify_ft notify, void* ctx);
+void deque08_set_watermarks (deque08_t *q, int low, int high);
+void deque08_set_delimiter (deque08_t *q, int delim);
 
 /*
  * User Functions
@@ -109,6 +136,16 @@ int  deque08_front (deque08_t *q, byte_t *b);
 
 bool deque08_check_trigger (deque08_t *q);
 
+size_t deque08_push_back_blk (deque08_t *q, const byte_t *b, size_t n);
+size_t deque08_pop_front_blk (deque08_t *q, byte_t *b, size_t n);
+size_t deque08_pop_frame (deque08_t *q, byte_t *b, size_t n);
+uint8_t deque08_events (deque08_t *q);
+int  deque08_delimiters (deque08_t *q);
+
+#if defined (__linux__)
+void deque08_eventfd_notify (void* ctx, uint32_t events);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
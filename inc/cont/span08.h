@@ -28,19 +28,35 @@ extern "C" {
 
 #include <tbx_types.h>
 #include <toolbox_defs.h>
+#include <sys/alloc.h>
 
 #include <stdarg.h>
 #include <string.h>
 
+/*
+ * User defines
+ */
+#define  SPAN08_MIN_GROW      (16)     /*!< The minimum capacity of a growing span */
+
 /*!
- * The main span type. This is a non-owning object to a collection of bytes
+ * The main span type. This is a non-owning object to a collection of bytes,
+ * or a buffer owning its data when created with \sa span08_alloc().
+ * \note
+ *    A capacity of 0 means unknown capacity. These spans (made with
+ *    \sa span08_init(), \sa span08_mk() or by {size, data} initialization)
+ *    are not bounds-checked.
  */
 typedef struct {
-   size_t   size;
-   byte_t   *data;
+   size_t   size;       /*!< The number of bytes in span */
+   byte_t   *data;      /*!< Pointer to span's data */
+   size_t   cap;        /*!< Capacity of data in bytes (0: unknown) */
+   const alc_t
+            *alc;       /*!< The allocator for owned data */
+   bool     own;        /*!< True if the span owns and can grow its data */
 }span08_t;
 
 span08_t span08_init (byte_t* data);
+span08_t span08_init_cap (byte_t* data, size_t cap);
 span08_t span08_mk (byte_t* data, size_t num, ...);
 span08_t span08_add (span08_t* span, byte_t it);
 span08_t span08_set (span08_t* span, size_t num, ...);
@@ -48,6 +64,18 @@ span08_t span08_cpy (span08_t* span, byte_t* data, size_t num);
 span08_t span08_cat (span08_t* span, span08_t src);
 byte_t* span08_get (span08_t* span);
 
+int  span08_alloc (span08_t* span, size_t cap, const alc_t *alc);
+void span08_free (span08_t* span);
+int  span08_reserve (span08_t* span, size_t cap);
+void span08_clear (span08_t* span);
+size_t span08_room (span08_t* span);
+
+int  span08_assign (span08_t* span, const byte_t* src, size_t num);
+int  span08_append (span08_t* span, const byte_t* src, size_t num);
+int  span08_insert (span08_t* span, size_t pos, const byte_t* src, size_t num);
+int  span08_erase (span08_t* span, size_t pos, size_t num);
+span08_t span08_slice (span08_t* span, size_t pos, size_t num);
+
 
 #ifdef __cplusplus
 }
@@ -33,6 +33,7 @@ extern "C" {
 /*
  * =================== User Defines =====================
  */
+#define EE_WB_PAGES           (4)            // Maximum write buffer pages
 
 /* ================   General Defines   ====================*/
 #define EE_WRITE     (0x0)
@@ -40,6 +41,7 @@ extern "C" {
 
 #define EE_PAGE_SZ_DEF        (64)           // 64 bytes
 #define EE_SECTOR_SIZE_DEF    (512)          // 512 bytes
+#define EE_WB_EMPTY           ((address_t)-1)   // Free write buffer page
 
 /* ================    General Types    ====================*/
 typedef enum {
@@ -59,6 +61,17 @@ typedef struct
    drv_i2c_ioctl_ft  i2c_ioctl;  /*!< I2C ioctl function */
 }ee_io_t;
 
+/*!
+ * Write buffer page descriptor
+ */
+typedef struct
+{
+   address_t      page;       /*!< The page's EEPROM address, or EE_WB_EMPTY */
+   uint32_t       lo;         /*!< Start of the dirty bytes in the page */
+   uint32_t       hi;         /*!< End of the dirty bytes in the page */
+   uint32_t       used;       /*!< Last use time stamp */
+}ee_wb_t;
+
 typedef volatile struct
 {
    address_t      hw_addr;    /*!< I2C hardware address function */
@@ -68,10 +81,20 @@ typedef volatile struct
    uint32_t       timeout;
 }ee_conf_t;
 
+typedef volatile struct
+{
+   byte_t*        mem;        /*!< Page buffers memory, page_size bytes each */
+   uint32_t       size;       /*!< The size of mem */
+   uint32_t       pages;      /*!< The number of page buffers in use */
+   uint32_t       tick;       /*!< Time base for the LRU */
+   ee_wb_t        wb[EE_WB_PAGES];
+}ee_wbuf_t;
+
 typedef volatile struct
 {
    ee_io_t        io;
    ee_conf_t      conf;
+   ee_wbuf_t      wbuf;       /*!< Write buffer - Optional */
    drv_status_en  status;
 }ee_t;
 
@@ -97,6 +120,7 @@ void ee_set_size (ee_t *ee, ee_size_en s);
 void ee_set_page_size (ee_t *ee, uint32_t ps);
 void ee_set_sector_size (ee_t *ee, uint32_t ss);
 void ee_set_timeout (ee_t *ee, uint32_t to);
+void ee_set_write_buffer (ee_t *ee, byte_t *mem, uint32_t size);
 
 /*
  * User Functions
@@ -114,6 +138,7 @@ drv_status_en ee_write (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
 drv_status_en  ee_read_sector (ee_t *ee, int sector, byte_t *buf, int count);
 drv_status_en ee_write_sector (ee_t *ee, int sector, byte_t *buf, int count);
 
+drv_status_en ee_sync (ee_t *ee);
 drv_status_en ee_clear (ee_t *ee, uint32_t size);
 drv_status_en ee_ioctl (ee_t *ee, ioctl_cmd_t cmd, ioctl_buf_t buf);
 
@@ -0,0 +1,145 @@
+/*!
+ * \file s25fs_ftl.h
+ * \brief
+ *    A flash translation layer for the s25fs spi flash driver. It exports
+ *    the flash as a re-writable 512 byte sector block device, suitable for
+ *    FatFs, with log structured sector mapping, garbage collection and
+ *    wear levelling.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __s25fs_ftl_h__
+#define __s25fs_ftl_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <tbx_ioctl.h>
+#include <tbx_types.h>
+#include <drv/s25fs_spi.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * =================== User Defines =====================
+ */
+#define S25FS_FTL_SPARE_BLOCKS   (3)      /*!< Erase blocks kept out of the exported capacity, min 3 */
+#define S25FS_FTL_WEAR_DELTA     (32)     /*!< Erase count spread that triggers static wear levelling */
+
+
+/*
+ * =================== General Defines =====================
+ */
+#define S25FS_FTL_MAGIC          (0x314C5446)   /*!< "FTL1" block header magic */
+#define S25FS_FTL_FREE           (0xFFFFFFFF)   /*!< Sequence of an erased block */
+#define S25FS_FTL_UNMAPPED       (0xFFFFFFFF)   /*!< Map entry of a never written sector */
+
+/*!
+ * RAM needed by s25fs_ftl_init() for \a _blocks erase blocks and
+ * \a _sectors exported sectors. See also s25fs_ftl_mem_size().
+ */
+#define S25FS_FTL_MEM_SIZE(_blocks, _sectors)   \
+   ((_blocks)*sizeof (s25fs_ftl_blk_t) + (_sectors)*sizeof (uint32_t))
+
+/*
+ * =================== Data types =====================
+ */
+
+/*!
+ * Erase block run time info
+ */
+typedef struct {
+   uint32_t       seq;     /*!< Allocation sequence, S25FS_FTL_FREE for erased blocks */
+   uint32_t       erase;   /*!< Erase count */
+   uint32_t       valid;   /*!< Sectors in the block still mapped */
+}s25fs_ftl_blk_t;
+
+/*!
+ * The FTL data type. Each one refers to an area of erase
+ * blocks of a s25fs flash.
+ */
+typedef struct {
+   s25fs_t*          flash;   /*!< The flash driver */
+   uint32_t          first;   /*!< First erase block of the area */
+   uint32_t          blocks;  /*!< Number of erase blocks in the area */
+   uint32_t          slots;   /*!< Data sectors per erase block */
+   uint32_t          sectors; /*!< Exported sectors */
+   s25fs_ftl_blk_t*  blk;     /*!< Block info table, in user's memory */
+   uint32_t*         map;     /*!< Sector to slot map, in user's memory */
+   uint32_t          active;  /*!< The block being written */
+   uint32_t          wp;      /*!< Next free slot in the active block */
+   uint32_t          seq;     /*!< Last allocation sequence */
+   uint32_t          nfree;   /*!< Number of erased blocks */
+   drv_status_en     status;  /*!< FTL status */
+}s25fs_ftl_t;
+
+
+/*
+ *  ============= PUBLIC S25FS FTL API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+void s25fs_ftl_link_flash (s25fs_ftl_t *ftl, s25fs_t *flash);
+
+/*
+ * Set functions
+ */
+void s25fs_ftl_set_area (s25fs_ftl_t *ftl, uint32_t first, uint32_t blocks);
+
+/*
+ * User Functions
+ */
+size_t s25fs_ftl_mem_size (s25fs_ftl_t *ftl);
+void s25fs_ftl_deinit (s25fs_ftl_t *ftl);
+drv_status_en s25fs_ftl_init (s25fs_ftl_t *ftl, void *mem, size_t size);
+drv_status_en s25fs_ftl_format (s25fs_ftl_t *ftl);
+
+drv_status_en  s25fs_ftl_read (s25fs_ftl_t *ftl, int sector, s25fs_data_t *buf, int count);
+drv_status_en s25fs_ftl_write (s25fs_ftl_t *ftl, int sector, s25fs_data_t *buf, int count);
+drv_status_en  s25fs_ftl_trim (s25fs_ftl_t *ftl, int sector, int count);
+drv_status_en s25fs_ftl_ioctl (s25fs_ftl_t *ftl, ioctl_cmd_t ctrl, ioctl_buf_t buf);
+
+/*!
+ * \note
+ *    The flash must be initialised first. The FTL uses the flash's erase page
+ *    and virtual sector sizes. Each erase block keeps its first sector for a
+ *    header and the sector tags, so a 64k block holds 122 data sectors.
+ * \code
+ *    static s25fs_ftl_t ftl;
+ *    static uint32_t ftl_mem[...];   // s25fs_ftl_mem_size() bytes
+ *
+ *    s25fs_init (&flash);
+ *    s25fs_ftl_link_flash (&ftl, &flash);
+ *    s25fs_ftl_set_area (&ftl, 0, 256);        // 16MB, all of the chip
+ *    s25fs_ftl_init (&ftl, ftl_mem, sizeof (ftl_mem));
+ *
+ *    DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, BYTE count) {
+ *       return (s25fs_ftl_write (&ftl, sector, (s25fs_data_t*)buff, count) == DRV_READY) ? RES_OK : RES_ERROR;
+ *    }
+ * \endcode
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   //#ifndef __s25fs_ftl_h__
@@ -36,6 +36,7 @@ extern "C" {
 
 #include <tbx_ioctl.h>
 #include <tbx_types.h>
+#include <algo/crc.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -46,6 +47,10 @@ extern "C" {
 #define SD_POWER_TIMEOUT         (250/SD_TIMEBASE_TICKS)    /*!< Delay in in msec/SD_TIMEBASE_TICKS after power on */
 #define SD_RX_TIMEOUT            (100/SD_TIMEBASE_TICKS)    /*!< Timeout in in msec/SD_TIMEBASE_TICKS for receive data */
 #define SD_INIT_TIMEOUT          (2000/SD_TIMEBASE_TICKS)   /*!< Initialisation timeout in in msec/SD_TIMEBASE_TICKS */
+#define SD_STREAM_TIMEOUT        (100/SD_TIMEBASE_TICKS)    /*!< Idle time in msec/SD_TIMEBASE_TICKS before an open multi block transaction closes */
+
+#define SD_QUEUE_SIZE            (4)                        /*!< Asynchronous requests per drive */
+#define SD_CRC_RETRIES           (3)                        /*!< Retries of a failed transfer in CRC mode */
 
 #define SD_NUMBER_OF_DRIVES      (2)
 
@@ -85,6 +90,7 @@ extern "C" {
 #define SD_CMD25  (0x40+25)   /*!< WRITE_MULTIPLE_BLOCK */
 #define SD_CMD55  (0x40+55)   /*!< APP_CMD */
 #define SD_CMD58  (0x40+58)   /*!< READ_OCR */
+#define SD_CMD59  (0x40+59)   /*!< CRC_ON_OFF */
 
 /* MMC card type flags (MMC_GET_TYPE) */
 #define CT_MMC    0x01     /* MMC ver 3 */
@@ -100,6 +106,15 @@ typedef drv_status_en (*spi_ioctl_t) (void *, ioctl_cmd_t, ioctl_buf_t);
 //typedef uint8_t (*spi_read_t) (void *, int);
 //typedef void    (*spi_write_t) (void *, uint8_t, int);
 typedef uint8_t (*spi_rw_t) (void *spi, uint8_t data);
+/*!
+ * Optional block transfer functions for the data phases, usually DMA driven.
+ * They return when the transfer is complete.
+ *  - rx clocks out 0xFF and stores \a n received bytes to \a buf.
+ *  - tx transmits \a n bytes from \a buf and discards the received ones.
+ * Both return DRV_READY on success.
+ */
+typedef drv_status_en (*spi_rx_block_t) (void *spi, uint8_t *buf, size_t n);
+typedef drv_status_en (*spi_tx_block_t) (void *spi, const uint8_t *buf, size_t n);
 
 typedef volatile struct
 {
@@ -110,6 +125,8 @@ typedef volatile struct
    void*          spi;           /*!< void SPI type structure */
    spi_ioctl_t    spi_ioctl;     /*!< SPI ioctl function */
    spi_rw_t       spi_rw;        /*!< SPI read/write function */
+   spi_rx_block_t spi_rx_block;  /*!< SPI block receive function, optional */
+   spi_tx_block_t spi_tx_block;  /*!< SPI block transmit function, optional */
 }sd_io_t;
 
 typedef volatile struct
@@ -117,14 +134,50 @@ typedef volatile struct
    uint32_t       speed;   /*!< speed setting */
    uint8_t        type;    /*!< Card type flags */
    uint8_t        pow;     /*!< power on flag */
+   uint8_t        crc;     /*!< CRC mode flag \sa sd_set_crc() */
    drv_status_en  status;  /*!< Disk status */
    uint32_t       t1, t2;  /*!< General decrement timers on time-base \sa SD_timebase() */
 }sd_data_t;
 
+/*!
+ * Asynchronous request completion callback. Gets the drive, the request's
+ * context and the request's status, DRV_READY or DRV_ERROR.
+ */
+typedef void (*sd_done_ft) (int drv, void *ctx, drv_status_en st);
+
+/*!
+ * Asynchronous request
+ */
+typedef struct
+{
+   sd_dat_t       *buf;    /*!< The request's data buffer */
+   sd_idx_t       sector;  /*!< Start sector number (LBA) */
+   size_t         count;   /*!< Sector count */
+   uint8_t        write;   /*!< Write request flag */
+   sd_done_ft     done;    /*!< Completion callback, optional */
+   void           *ctx;    /*!< Completion callback's context */
+}sd_req_t;
+
+/*!
+ * Asynchronous request queue of a drive
+ */
+typedef volatile struct
+{
+   sd_req_t       req[SD_QUEUE_SIZE];  /*!< Request ring buffer */
+   uint8_t        head, tail, cnt;     /*!< Ring buffer indexes and count */
+   uint8_t        state;   /*!< Open multi block transaction */
+   uint8_t        busy;    /*!< Card busy flag, polled before next transfer */
+   sd_idx_t       next;    /*!< Next sector of the open transaction */
+   size_t         blk;     /*!< Transferred blocks of the head request */
+   uint8_t        retry;   /*!< Failed attempts of the current block */
+   uint32_t       tb, ti;  /*!< Busy and stream idle decrement timers on time-base \sa sd_service() */
+}sd_queue_t;
+
 typedef volatile struct
 {
    sd_io_t        sd_io[SD_NUMBER_OF_DRIVES];      /*!< Connection to the driver functions */
    sd_data_t      drive[SD_NUMBER_OF_DRIVES];      /*!< Physical drive table */
+   sd_queue_t     queue[SD_NUMBER_OF_DRIVES];      /*!< Asynchronous request queues */
 }sd_spi_t;
 
 
@@ -157,11 +210,14 @@ void sd_link_cs (int drv, drv_pinout_ft fun);
 void sd_link_pw (int drv, drv_pinout_ft fun);
 void sd_link_spi_ioctl (int drv, spi_ioctl_t fun);
 void sd_link_spi_rw (int drv, spi_rw_t fun);
+void sd_link_spi_rx_block (int drv, spi_rx_block_t fun);
+void sd_link_spi_tx_block (int drv, spi_tx_block_t fun);
 void sd_link_spi (int drv, void* spi);
 
 /*
  * Set functions
  */
+drv_status_en sd_set_crc (int drv, uint8_t on);
 
 /*
  * User Functions
@@ -177,6 +233,10 @@ drv_status_en  sd_read (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count);
 drv_status_en sd_write (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count);
 drv_status_en sd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf);
 
+drv_status_en sd_read_async (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count, sd_done_ft done, void *ctx);
+drv_status_en sd_write_async (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count, sd_done_ft done, void *ctx);
+drv_status_en sd_poll (int drv);
+
 #ifdef __cplusplus
  }
 #endif
@@ -40,7 +40,7 @@
  * Is the size of each virtual word in SEE
  */
 #define SEE_MAX_WORD_SIZE           (8)      // 8 bytes
-#define SEE_FIND_LAST_BUFFER_SIZE   (64)
+#define SEE_FIND_LAST_BUFFER_SIZE   (64)     // Buffer for page scans and batched reads
 
 /*!
  * Use this define to select 16bit addressing scheme (max 64KBytes)
@@ -65,6 +65,12 @@ typedef  uint16_t    see_idx_t;     /*!< SEE byte addressing */
 #ifdef SEE_32BIT_ADDRESSING
 typedef  uint32_t    see_idx_t;     /*!< SEE byte addressing */
 #endif
+
+/*!
+ * Number of entries of the optional RAM index, for a page of \a _page_size
+ * bytes and \a _word_size byte words. See see_set_index().
+ */
+#define SEE_INDEX_SIZE(_page_size, _word_size)  ((_page_size) / ((_word_size) + sizeof (see_idx_t)))
 /*!<
  * \note
  *    The virtual EEPROM is byte addressed ONLY. This is true even
@@ -134,6 +140,10 @@ typedef volatile struct {
    see_iface_t    iface;      /*!< Interface */
    see_idx_t      last_cur;   /*!< Holds the last write flash address of current page */
    see_idx_t      last_pr;    /*!< Holds the last write flash address of previous page */
+   see_idx_t      page_cur;   /*!< The page last_cur refers to */
+   see_idx_t      page_pr;    /*!< The page last_pr refers to */
+   see_idx_t*     index;      /*!< Optional RAM index, flash address of each word's latest record */
+   uint32_t       index_size; /*!< The number of index entries */
    drv_status_en  status;     /*!< see driver status, NOT the device status */
 }see_t;
 
@@ -158,6 +168,7 @@ void see_set_page_size (see_t *see, uint32_t size);
 void see_set_flash_sector_size (see_t *see, uint32_t size);
 void see_set_word_size (see_t *see, uint8_t size);
 void see_set_sector_size (see_t *see, uint32_t size);
+void see_set_index (see_t *see, see_idx_t *index, uint32_t size);
 
 /*
  * User Functions
@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 #include <dsp/dsp.h>
+#include <sys/alloc.h>
 #include <string.h>
 
 /*
@@ -81,6 +82,13 @@ uint32_t fir_ma_init_ui32 (fir_ma_ui32_t* f, float fc);
 uint32_t fir_ma_init_cd (fir_ma_cd_t* f, double fc);
 uint32_t fir_ma_init_cf (fir_ma_cf_t* f, float fc);
 uint32_t fir_ma_init_ci (fir_ma_ci_t* f, float fc);
+uint32_t fir_ma_init_alc_d (fir_ma_d_t* f, double fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_f (fir_ma_f_t* f, float fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_i32 (fir_ma_i32_t* f, float fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_ui32 (fir_ma_ui32_t* f, float fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_cd (fir_ma_cd_t* f, double fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_cf (fir_ma_cf_t* f, float fc, const alc_t *alc);
+uint32_t fir_ma_init_alc_ci (fir_ma_ci_t* f, float fc, const alc_t *alc);
 
 
 double fir_ma_d (fir_ma_d_t* f, double in) __O3__ ;
@@ -117,6 +125,30 @@ complex_f_t fir_ma_ci (fir_ma_ci_t* f, complex_i_t in) __O3__ ;
           fir_ma_ci_t*: fir_ma_init_ci,           \
                default: fir_ma_init_f)(f, in)
 
+/*!
+ * A pseudo type-polymorphism mechanism using _Generic macro
+ * to simulate:
+ *
+ * template<typename T1, typename T2> uint32_t fir_ma_init_alc (T1 *f, T2 fc, const alc_t *alc);
+ *
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+#define fir_ma_init_alc(f, in, alc)    _Generic((f),   \
+           fir_ma_d_t*: fir_ma_init_alc_d,            \
+           fir_ma_f_t*: fir_ma_init_alc_f,            \
+         fir_ma_i32_t*: fir_ma_init_alc_i32,          \
+        fir_ma_ui32_t*: fir_ma_init_alc_ui32,         \
+          fir_ma_cd_t*: fir_ma_init_alc_cd,           \
+          fir_ma_cf_t*: fir_ma_init_alc_cf,           \
+          fir_ma_ci_t*: fir_ma_init_alc_ci,           \
+               default: fir_ma_init_alc_f)(f, in, alc)
+
 /*!
  * A pseudo type-polymorphism mechanism using _Generic macro
  * to simulate:
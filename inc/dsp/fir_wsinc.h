@@ -33,6 +33,7 @@ extern "C" {
 #include <dsp/fft.h>
 #include <dsp/conv.h>
 #include <dsp/vectors.h>
+#include <sys/alloc.h>
 #include <string.h>
 
 /*
@@ -89,6 +90,7 @@ typedef struct {
    uint32_t       N;    //!< The number of kernel points in frequncy complex domain
    window_pt      W;    //!< Pointer to window function
    wsinc_taps_pt  tp;   //!< Pointer to number of taps calculation function
+   const alc_t    *alc; //!< Pointer to allocator for kernel and temporary arrays (null for default)
 }fir_wsinc_t;
 
 
@@ -105,6 +107,7 @@ void fir_wsinc_set_wtype (fir_wsinc_t *f, fir_wtype_en t);
 void fir_wsinc_set_fc (fir_wsinc_t *f, double fc1, double fc2);
 void fir_wsinc_set_tb (fir_wsinc_t *f, double tb);
 void fir_wsic_set_cascade (fir_wsinc_t *f, uint32_t c);
+void fir_wsinc_set_alc (fir_wsinc_t *f, const alc_t *alc);
 
 /*
  * User Functions
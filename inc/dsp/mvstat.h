@@ -0,0 +1,229 @@
+/*!
+ * \file mvstat.h
+ * \brief
+ *    Moving window statistics (mean, variance, min, max) in O(1) per sample.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __mvstat_h__
+#define __mvstat_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dsp/dsp.h>
+#include <sys/alloc.h>
+#include <string.h>
+
+/*
+ * =================== Data types =====================
+ */
+
+/*!
+ * Moving statistics window make define
+ *
+ * bf          Pointer to sample buffer
+ * qmin, qmax  Monotonic deques of buffer positions for min/max
+ * sum, comp   Running sum and its compensation (rounding error)
+ * mean, m2    Welford's mean and sum of squared differences
+ * hmin, lmin  Min deque head and length
+ * hmax, lmax  Max deque head and length
+ * N           The window length
+ * n           The number of samples in window
+ * c           Buffer cursor
+ * alc         The allocator used for the buffers
+ */
+#define _mvstat_mktype(_type, _atype, _rtype, _type_name)  \
+typedef struct {           \
+      _type    *bf;        \
+      uint32_t *qmin;      \
+      uint32_t *qmax;      \
+      _atype   sum;        \
+      _atype   comp;       \
+      _rtype   mean;       \
+      _rtype   m2;         \
+      uint32_t hmin, lmin; \
+      uint32_t hmax, lmax; \
+      uint32_t N;          \
+      uint32_t n;          \
+      uint32_t c;          \
+      const alc_t *alc;    \
+}_type_name
+
+_mvstat_mktype (double, double, double, mvstat_d_t);      /*!< Moving statistics double precision */
+_mvstat_mktype (float, float, float, mvstat_f_t);         /*!< Moving statistics single precision */
+_mvstat_mktype (int32_t, int64_t, double, mvstat_i32_t);  /*!< Moving statistics signed int32 (exact sum) */
+
+
+/* =================== Public API ===================== */
+
+/*
+ * Link and Glue functions
+ */
+
+/*
+ * Set functions
+ */
+
+/*
+ * User Functions
+ */
+uint32_t mvstat_init_d (mvstat_d_t* w, uint32_t N);
+uint32_t mvstat_init_alc_d (mvstat_d_t* w, uint32_t N, const alc_t *alc);
+void mvstat_deinit_d (mvstat_d_t* w);
+void mvstat_resync_d (mvstat_d_t* w);
+double mvstat_d (mvstat_d_t* w, double in) __O3__ ;
+double mvstat_mean_d (mvstat_d_t* w);
+double mvstat_var_d (mvstat_d_t* w);
+double mvstat_min_d (mvstat_d_t* w);
+double mvstat_max_d (mvstat_d_t* w);
+
+uint32_t mvstat_init_f (mvstat_f_t* w, uint32_t N);
+uint32_t mvstat_init_alc_f (mvstat_f_t* w, uint32_t N, const alc_t *alc);
+void mvstat_deinit_f (mvstat_f_t* w);
+void mvstat_resync_f (mvstat_f_t* w);
+float mvstat_f (mvstat_f_t* w, float in) __O3__ ;
+float mvstat_mean_f (mvstat_f_t* w);
+float mvstat_var_f (mvstat_f_t* w);
+float mvstat_min_f (mvstat_f_t* w);
+float mvstat_max_f (mvstat_f_t* w);
+
+uint32_t mvstat_init_i32 (mvstat_i32_t* w, uint32_t N);
+uint32_t mvstat_init_alc_i32 (mvstat_i32_t* w, uint32_t N, const alc_t *alc);
+void mvstat_deinit_i32 (mvstat_i32_t* w);
+void mvstat_resync_i32 (mvstat_i32_t* w);
+double mvstat_i32 (mvstat_i32_t* w, int32_t in) __O3__ ;
+double mvstat_mean_i32 (mvstat_i32_t* w);
+double mvstat_var_i32 (mvstat_i32_t* w);
+int32_t mvstat_min_i32 (mvstat_i32_t* w);
+int32_t mvstat_max_i32 (mvstat_i32_t* w);
+
+#if __STDC_VERSION__ >= 201112L
+#ifndef mvstat
+
+/*!
+ * A pseudo type-polymorphism mechanism using _Generic macro
+ * to simulate:
+ *
+ * template<typename T> uint32_t mvstat_init (T *w, uint32_t N);
+ *
+ * \brief
+ *    Moving statistics initialization.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \return        The window length, or zero on failure
+ */
+#define mvstat_init(w, N)    _Generic((w),       \
+          mvstat_d_t*: mvstat_init_d,         \
+          mvstat_f_t*: mvstat_init_f,         \
+        mvstat_i32_t*: mvstat_init_i32,       \
+               default: mvstat_init_f)(w, N)
+
+/*!
+ * A pseudo type-polymorphism mechanism using _Generic macro
+ * to simulate:
+ *
+ * template<typename T> uint32_t mvstat_init_alc (T *w, uint32_t N, const alc_t *alc);
+ *
+ * \brief
+ *    Moving statistics initialization, using a specific allocator.
+ */
+#define mvstat_init_alc(w, N, alc)    _Generic((w), \
+          mvstat_d_t*: mvstat_init_alc_d,     \
+          mvstat_f_t*: mvstat_init_alc_f,     \
+        mvstat_i32_t*: mvstat_init_alc_i32,   \
+               default: mvstat_init_alc_f)(w, N, alc)
+
+/*!
+ * A pseudo type-polymorphism mechanism using _Generic macro
+ * to simulate:
+ *
+ * template<typename T> void mvstat_deinit (T *w);
+ *
+ * \brief
+ *    Moving statistics de-initialization.
+ */
+#define mvstat_deinit(w)    _Generic((w),        \
+          mvstat_d_t*: mvstat_deinit_d,         \
+          mvstat_f_t*: mvstat_deinit_f,         \
+        mvstat_i32_t*: mvstat_deinit_i32,       \
+               default: mvstat_deinit_f)(w)
+
+/*!
+ * A pseudo type-polymorphism mechanism using _Generic macro
+ * to simulate:
+ *
+ * template<typename T1, typename T2> T2 mvstat (T1 *w, T2 in);
+ *
+ * \brief
+ *    Push a sample to the window.
+ *
+ * \param  w      Which window to use
+ * \param  in     The input value.
+ *
+ * \return        The window's mean value
+ */
+#define mvstat(w, in)    _Generic((in),       \
+                double: mvstat_d,              \
+                 float: mvstat_f,              \
+               int32_t: mvstat_i32,            \
+               default: mvstat_f)(w, in)
+
+/*!
+ * A pseudo type-polymorphism mechanism for the window statistics getters.
+ * \param  w      Which window to use
+ */
+#define mvstat_mean(w)    _Generic((w),          \
+          mvstat_d_t*: mvstat_mean_d,         \
+          mvstat_f_t*: mvstat_mean_f,         \
+        mvstat_i32_t*: mvstat_mean_i32,       \
+               default: mvstat_mean_f)(w)
+#define mvstat_var(w)    _Generic((w),           \
+          mvstat_d_t*: mvstat_var_d,         \
+          mvstat_f_t*: mvstat_var_f,         \
+        mvstat_i32_t*: mvstat_var_i32,       \
+               default: mvstat_var_f)(w)
+#define mvstat_min(w)    _Generic((w),           \
+          mvstat_d_t*: mvstat_min_d,         \
+          mvstat_f_t*: mvstat_min_f,         \
+        mvstat_i32_t*: mvstat_min_i32,       \
+               default: mvstat_min_f)(w)
+#define mvstat_max(w)    _Generic((w),           \
+          mvstat_d_t*: mvstat_max_d,         \
+          mvstat_f_t*: mvstat_max_f,         \
+        mvstat_i32_t*: mvstat_max_i32,       \
+               default: mvstat_max_f)(w)
+#define mvstat_resync(w)    _Generic((w),        \
+          mvstat_d_t*: mvstat_resync_d,         \
+          mvstat_f_t*: mvstat_resync_f,         \
+        mvstat_i32_t*: mvstat_resync_i32,       \
+               default: mvstat_resync_f)(w)
+
+#endif   // #ifndef mvstat
+#endif   // #if __STDC_VERSION__ >= 201112L
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   // #ifndef __mvstat_h__
@@ -65,10 +65,12 @@ extern const char pr_flags[_IO_NUM_OF_FLAGS];
 
 #define _IO_FRACTIONAL_WIDTH        (3)
 #define _IO_WIDTH                   (5)
+#define _IO_G_SHORTEST_DIGITS       (17)     /*!< %g without precision switches to exp format from this exponent */
 #define _IO_MAX_INT_DIGITS          (15)
 #define _IO_MAX_INT32_DIGITS        (15)
 #define _IO_MAX_INT64_DIGITS        (22)
 #define _IO_MAX_DOUBLE_WIDTH        (20)
+#define _IO_MAX_SCAN_DIGITS         (40)     /*!< Number buffer of scanf's stream input */
 
 #define _IO_MAX_FLOAT               (1e18)
 #define _IO_MAX_FLOAT_EXP           (18)
@@ -85,6 +87,7 @@ typedef enum
    _IO_ST_WIDTH,
    _IO_ST_DOT,
    _IO_ST_FRAC,
+   _IO_ST_LEN,
    _IO_ST_TYPE,
    _IO_ST_ERROR
 }_parser_st_t;
@@ -101,6 +104,18 @@ typedef enum
    INT_i, INT_l, FL_L, INT_o, INT_s, INT_u, INT_x, INT_X, NO_TYPE
 }_io_types_en;
 
+/*!
+ * Enumerator for the length modifiers.
+ */
+typedef enum
+{
+   _IO_LEN_NONE=0,   /*!< No length modifier */
+   _IO_LEN_HH,       /*!< "hh" char */
+   _IO_LEN_H,        /*!< "h" short */
+   _IO_LEN_L,        /*!< "l" long, or double for scanf floating point */
+   _IO_LEN_LL        /*!< "ll" long long */
+}_io_len_en;
+
 /*!
  * Enumerator for supported flags.
  * \note
@@ -148,6 +163,7 @@ typedef struct {
    _io_flags_t    flags;   /*!< The flags enabled */
    int            width;   /*!< The desired width */
    int            frac;    /*!< The desired fractional part width */
+   _io_len_en     len;     /*!< The length modifier */
 }_io_frm_spec_t;
 
 /*!
@@ -170,14 +186,90 @@ typedef enum {
 }_io_frm_obj_type_en;
 
 
+/*!
+ * Argument classes. The way each format specifier takes its argument
+ * \sa _io_arg_class()
+ */
+typedef enum {
+   _IO_ARG_NONE = 0,    /*!< No argument */
+   _IO_ARG_INT,         /*!< signed int */
+   _IO_ARG_UINT,        /*!< unsigned int (and char) */
+   _IO_ARG_INT64,       /*!< long long (and long on LP64) */
+   _IO_ARG_UINT64,      /*!< unsigned long long (and unsigned long on LP64) */
+   _IO_ARG_DOUBLE,      /*!< double */
+   _IO_ARG_STR          /*!< char* */
+}_io_arg_class_en;
+
+/*!
+ * An already fetched format argument.
+ */
+typedef union {
+   int            i;
+   unsigned int   u;
+   long long      ll;
+   unsigned long long ull;
+   double         d;
+   const char     *s;
+}_io_arg_t;
+
+/*!
+ * Compiled format operation. A literal run or a format specifier.
+ */
+typedef struct {
+   _io_frm_obj_type_en  type;    /*!< _IO_FRM_STREAM for literal runs, _IO_FRM_SPECIFIER or _IO_FRM_CRAP */
+   const char           *lit;    /*!< The literal run, points inside the format string */
+   int                  len;     /*!< The literal run's length */
+   _io_frm_spec_t       spec;    /*!< The format specifier */
+}_io_op_t;
+
+/*!
+ * Compiled format string. The format is parsed once \sa _io_compile()
+ * and the op list can be executed repeatedly.
+ * \note
+ *    The literal runs point inside the format string, so the format
+ *    string must outlive the compiled one.
+ */
+typedef struct {
+   const char  *frm;    /*!< The source format string */
+   _io_op_t    *op;     /*!< The op list */
+   int         n;       /*!< The used ops, 0 for not compiled yet */
+   int         size;    /*!< The op list's capacity */
+}_io_frm_t;
+
+/*!
+ * The maximum number of ops for a format string of \a _len characters.
+ * Each op takes at least one character and no two literal runs are
+ * adjacent, so there are at most 2 ops every 3 characters.
+ */
+#define _IO_FRM_OPS(_len)     ((2*(_len))/3 + 1)
+
+/*!
+ * Declare a static compiled format from a string literal. The op list is
+ * sized at compile time and the format is compiled on its first use.
+ * For example:
+ * <pre>
+ *    io_frm_static (log_frm, "%d: t=%.2f\n");
+ *    ...
+ *    printf_frm (&log_frm, id, t);
+ * </pre>
+ */
+#define io_frm_static(_name, _lit)                                   \
+   static _io_op_t   _name##_ops[_IO_FRM_OPS (sizeof (_lit))];       \
+   static _io_frm_t  _name = {                                       \
+      _lit, _name##_ops, 0, _IO_FRM_OPS (sizeof (_lit))              \
+   }
+
 #define  __io_init_frm_obj(_obj_)   _obj_ = {      \
       .frm_specifier.type = INT_c,                 \
       .frm_specifier.flags = {0, 0, 0, 0, 0, ' '}, \
       .frm_specifier.width = 0,                    \
-      .frm_specifier.frac = 0                      \
+      .frm_specifier.frac = 0,                     \
+      .frm_specifier.len = _IO_LEN_NONE            \
 }
 
 int __Os__ _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type);
+int __Os__ _io_compile (_io_frm_t *cf, const char *frm, _io_op_t *op, int size);
+_io_arg_class_en _io_arg_class (const _io_frm_spec_t *fs);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,62 @@
+/*!
+ * \file _numconv.h
+ * \brief
+ *    Fast number to/from string conversion core for the std part
+ *
+ * this file is part of toolbox (std part)
+ *
+ * Copyright (C) 2026 Houtouridis Christos <houtouridis.ch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __numconv_h__
+#define __numconv_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <toolbox_defs.h>
+
+/*
+ * General defines
+ */
+#define _NC_CACHED_POWERS     (87)     /*!< Number of cached powers of ten */
+#define _NC_MAX_DIGITS        (20)     /*!< Maximum digits of a round trip double (17) or uint64 (20) */
+#define _NC_MAX_SIG_DIGITS    (64)     /*!< Significant digits taken exactly into account when parsing a double */
+
+/*
+ * ============================ Public Functions ============================
+ */
+char* _u32toa_r (uint32_t v, char *end);
+char* _u64toa_r (uint64_t v, char *end);
+char* _u64tox_r (uint64_t v, char *end, int upper);
+
+int _dtoa_shortest (double v, char *bf, int *dp);
+int _dround (double v, char *bf, int len, int *dp, int keep);
+
+int _atou64 (const char *s, const char *end, uint64_t *v);
+int _atoi64 (const char *s, const char *end, int64_t *v);
+int _xtou64 (const char *s, const char *end, uint64_t *v);
+int _atod (const char *s, const char *end, double *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //#ifndef __numconv_h__
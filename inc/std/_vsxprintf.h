@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 #include <std/_base_io.h>
+#include <std/_numconv.h>
 #include <toolbox_defs.h>
 
 /*!
@@ -47,21 +48,62 @@ extern "C" {
  *
  *  1) user's __putchar ()
  *  2) destination string for sprintf family
- *  3) file destination (fprintf family)
+ *
+ * The file printf family writes through a block sink instead, \sa fstdio.h
  */
 typedef int (*_putc_out_t) (char *, const char );
 
 int _putc_usr (char *dst, const char c);  /*!< back end for user's device stdout */
 int _putc_dst (char *dst, const char c);  /*!< back end for sprintf family */
-int _putc_fil (char *dst, const char c);  /*!< back end for file printf family */
+
+/*!
+ * Block write back-end for buffered sinks. Gets the back-end's context,
+ * the characters and their number. Returns the number of written characters.
+ */
+typedef int (*_io_write_ft) (void *, const char *, size_t);
+
+int _write_usr (void *ctx, const char *src, size_t n);   /*!< block back end for user's device stdout */
+
+/*!
+ * User defines
+ */
+#ifndef _IO_SINK_BUFFER_SIZE
+#define _IO_SINK_BUFFER_SIZE     (64)     /*!< The stack buffer size of the printf family */
+#endif
+
+/*!
+ * Output sink. The formatting engine streams characters to the sink's
+ * buffer, and the buffer is flushed in chunks to the \a write back-end.
+ * String sinks (no back-end) write directly to the destination and drop
+ * whatever does not fit.
+ */
+typedef struct {
+   _io_write_ft   write;   /*!< The back-end, null for string sinks */
+   void           *ctx;    /*!< The back-end's context */
+   char           *buf;    /*!< The buffer or the destination string */
+   size_t         size;    /*!< The buffer's size (without terminator for string sinks) */
+   size_t         len;     /*!< Used characters in buffer */
+   size_t         count;   /*!< Total characters streamed, even the dropped ones */
+   uint8_t        term;    /*!< String sink with room for terminator */
+}_io_sink_t;
 
 /*
  * ============================ Public Functions ============================
  */
 void _io_unused (void);
 
+void _sink_init_str (_io_sink_t *sk, char *dst, size_t size);
+void _sink_init (_io_sink_t *sk, _io_write_ft write, void *ctx, char *buf, size_t size);
+int  _sink_flush (_io_sink_t *sk);
+void _sink_end_str (_io_sink_t *sk);
+
+int vsxprintf_sink (_io_sink_t *sk, const char *frm, __VALIST ap);
+int vsxprintf_frm (_io_sink_t *sk, _io_frm_t *cf, __VALIST ap);
+int vsxprintf_args (_io_sink_t *sk, _io_frm_t *cf, const _io_arg_t *args, int nargs);
 int vsxprintf(_putc_out_t _putc_out, char *dst, char *pfrm, __VALIST ap);
 
+void printf_link_write (_io_write_ft w);
+
 /*!
  * Tailor this in order to connect printf functionality
  * to your hardware (stdout).
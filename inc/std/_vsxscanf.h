@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 #include <std/_base_io.h>
+#include <std/_numconv.h>
 
 /*!
  * Callback read mode type.
@@ -55,19 +56,19 @@ typedef enum {
  *
  *  1) user's __getchar ()
  *  2) source string for sscanf family
- *  3) source file for fscanf family
+ *  3) source file for fscanf family, \sa fstdio.h
  */
 typedef int (*_getc_in_t) (const char *, char **psrc, _io_getc_read_en);
 
 int _getc_usr (const char *src, char **psrc, _io_getc_read_en mode);  /*!< back end for user's device stdin */
 int _getc_src (const char *src, char **psrc, _io_getc_read_en mode);  /*!< back end for sscanf family */
-int _getc_fil (const char *src, char **psrc, _io_getc_read_en mode);  /*!< back end for file fscanf family */
 
 /*
  * ============================ Public Functions ============================
  */
 
 int vsxscanf (_getc_in_t _in, const char *src, const char *frm, __VALIST ap);
+int vsxscanf_frm (_getc_in_t _in, const char *src, _io_frm_t *cf, __VALIST ap);
 
 /*!
  * Tailor this in order to connect scanf functionality
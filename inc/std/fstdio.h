@@ -0,0 +1,126 @@
+/*!
+ * \file fstdio.h
+ * \brief
+ *    Buffered file streams with printf/scanf families on top of FatFs.
+ *
+ *    The stream keeps a sector sized buffer in front of the FatFs file.
+ *    Writes are collected and written back in whole, sector aligned chunks,
+ *    so FatFs transfers them directly to the disk. Reads are done ahead
+ *    in the same chunks, and the scanf family reads the characters from
+ *    the buffer \sa _getc_fil().
+ *
+ * <pre>
+ * FIL fil;
+ * fstream_t log;
+ *
+ * f_open (&fil, "log.txt", FA_WRITE | FA_OPEN_ALWAYS);
+ * f_lseek (&fil, f_size (&fil));
+ * fstream_init (&log, &fil);
+ * ...
+ * fstream_printf (&log, "%u, %.3f\n", t, temp);
+ * ...
+ * fstream_close (&log);
+ * </pre>
+ *
+ * this file is part of toolbox (std part)
+ *
+ * Copyright (C) 2026 Houtouridis Christos <houtouridis.ch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __fstdio_h__
+#define __fstdio_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <std/_vsxprintf.h>
+#include <std/_vsxscanf.h>
+#include <sys/fatfs.h>
+
+/*!
+ * User defines
+ */
+#ifndef _IO_FILE_BUFFER_SIZE
+#define _IO_FILE_BUFFER_SIZE     (_MAX_SS)   /*!< Stream buffer size, a multiple of the sector size */
+#endif
+
+#if (_IO_FILE_BUFFER_SIZE % _MAX_SS) != 0
+#error "_IO_FILE_BUFFER_SIZE must be a multiple of _MAX_SS"
+#endif
+
+/*!
+ * Stream's buffer mode
+ */
+typedef enum {
+   _FSTREAM_IDLE=0,     /*!< Empty buffer */
+   _FSTREAM_WRITE,      /*!< Buffer holds data to write */
+   _FSTREAM_READ        /*!< Buffer holds data read ahead */
+}_fstream_mode_en;
+
+/*!
+ * Buffered file stream. The buffer holds either data to write starting
+ * at the file's pointer, or data read ahead ending at the file's pointer.
+ */
+typedef struct {
+   FIL               *fp;     /*!< The FatFs file, opened by the user */
+   char              buf[_IO_FILE_BUFFER_SIZE];  /*!< The stream's buffer */
+   UINT              len;     /*!< Buffered bytes to write, or valid bytes read */
+   UINT              pos;     /*!< Read position in buffer */
+   _fstream_mode_en  mode;    /*!< The buffer's mode */
+   FRESULT           err;     /*!< The first error of the stream */
+}fstream_t;
+
+/*
+ * ============================ Public Functions ============================
+ */
+
+/*
+ * Set functions
+ */
+void fstream_init (fstream_t *s, FIL *fp);
+
+/*
+ * User Functions
+ */
+FRESULT fstream_flush (fstream_t *s);
+FRESULT fstream_close (fstream_t *s);
+FRESULT fstream_error (fstream_t *s);
+
+int fstream_write (fstream_t *s, const void *src, size_t n);
+int fstream_read (fstream_t *s, void *dst, size_t n);
+int fstream_putc (fstream_t *s, char c);
+int fstream_getc (fstream_t *s);
+int fstream_puts (fstream_t *s, const char *str);
+char* fstream_gets (fstream_t *s, char *dst, int size);
+
+int vfstream_printf (fstream_t *s, const char *frm, __VALIST ap);
+int fstream_printf (fstream_t *s, const char *frm, ...);
+int vfstream_printf_frm (fstream_t *s, _io_frm_t *cf, __VALIST ap);
+int fstream_printf_frm (fstream_t *s, _io_frm_t *cf, ...);
+
+int vfstream_scanf (fstream_t *s, const char *frm, __VALIST ap);
+int fstream_scanf (fstream_t *s, const char *frm, ...);
+
+int _write_fil (void *ctx, const char *src, size_t n);   /*!< block back end for file printf family */
+int _getc_fil (const char *src, char **psrc, _io_getc_read_en mode);  /*!< back end for file fscanf family */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //#ifndef __fstdio_h__
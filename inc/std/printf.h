@@ -48,6 +48,10 @@
  * %d      YES     singed int         YES    singed int
  * %u      YES    unsinged int        YES   unsinged int
  * %l      NO     (%d)                NO    (%d)
+ * %hh.    YES    char (d,i,u,x,X,o)  NO    (int)
+ * %h.     YES    short               NO    (int)
+ * %l.     YES    long                NO    (int)
+ * %ll.    YES    long long           NO    (int)
  * %x      YES    unsinged int        NO    (%u)
  * %X      YES    unsinged int        NO    (%u)
  * %o      NO     (%x)                NO    (%u)
@@ -58,9 +62,9 @@
  * %f      YES    double              YES   double
  * %L      NO     (%f)                NO    (%f)
  * %e      YES    double              NO    (%f)
- * %E      NO     (%e)                NO    (%f)
- * %g      NO     (%f)                NO    (%f)
- * %G      NO     (%f)                NO    (%f)
+ * %E      YES    double              NO    (%f)
+ * %g      YES    double              NO    (%f)
+ * %G      YES    double              NO    (%f)
  * NaN     YES    "NaN"               NO     --
  * INF     YES    "INF"               NO     --
  * OTHERS  NO     (%u)                NO    (%u)  (NOTE)
@@ -68,6 +72,13 @@
  *
  * NOTE: ALL other convertion types are interpreted as unsigned int (%u).
  *
+ * Doubles are converted to round trip digits (Grisu2, 17 at most) and then
+ * correctly rounded to the requested precision, so there is no range limit.
+ * Digits beyond the round trip ones are printed as zeros.
+ * %g without precision prints digits that read back to the same double,
+ * for example printf("%g", 0.1) prints "0.1". They are the shortest ones
+ * for almost all values, but not always; a rare value may get one more.
+ *
  * <pre>
  * Flags:
  * -----------
@@ -79,7 +90,7 @@
  *
  * '-'      Not supported, ignored
  * '''      Not supported, ignored
- * '#'      Not supported, ignored
+ * '#'      Keep trailing zeros in %g, ignored for all other types
  * '*'      Not supported, ignored
  *</pre>
  *
@@ -103,7 +114,24 @@
  *    * int fputc(int c, FILE *fp);
  *    * int fputs(const char *pdst, FILE *fp);
  *
- * To enable these just define PRINTF_FILES. This "#define" also changes the behavor
+ * 3) Compiled formats
+ *    * int vprintf_frm(_io_frm_t *cf, va_list ap);
+ *    * int printf_frm(_io_frm_t *cf, ...);
+ *    * int vsprintf_frm(char *pdst, _io_frm_t *cf, va_list ap);
+ *    * int sprintf_frm(char *pdst, _io_frm_t *cf, ...);
+ *    * int snprintf_frm(char *pdst, size_t size, _io_frm_t *cf, ...);
+ *    * printf_lit("literal", ...);
+ *
+ * The format is parsed once to a list of literal runs and specifiers,
+ * either with _io_compile() or lazily with io_frm_static(), and then it
+ * is executed without parsing:
+ * <pre>
+ *    io_frm_static (tlm_frm, "%d,%.3f\n");
+ *    ...
+ *    printf_frm (&tlm_frm, id, value);
+ * </pre>
+ *
+ * To enable the file functions just define PRINTF_FILES. This "#define" also changes the behavor
  * of puts and vprintf, so they use fputs().
  *
  * \section Tailing
@@ -120,10 +148,22 @@
  * }
  * </pre>
  *
+ * The printf family formats into a small stack buffer (_IO_SINK_BUFFER_SIZE)
+ * and flushes it in chunks. For faster output link a block write function
+ * and __putchar() is not used by printf/puts any more:
+ *
+ * <pre>
+ * int  usr_write(void *ctx, const char *s, size_t n)
+ * {
+ *    return USART_Write(s, n);  //This is example
+ * }
+ * ...
+ * printf_link_write (usr_write);
+ * </pre>
+ *
  * \todo
- * 1. Implement the long long int type
- * 2. Implement the long double type
- * 3. Report the bug and fix the code
+ * 1. Implement the long double type
+ * 2. Report the bug and fix the code
  *
  */
 
@@ -144,6 +184,17 @@ int vprintf (const char *frm, __VALIST ap);
 int  printf (const char *frm, ...);
 int    puts (const char *dst);
 
+int vprintf_frm (_io_frm_t *cf, __VALIST ap);
+int  printf_frm (_io_frm_t *cf, ...);
+
+/*!
+ * printf with a string literal format, compiled once on the first call.
+ */
+#define printf_lit(_lit, ...)    do {            \
+   io_frm_static (_printf_lit_frm, _lit);        \
+   printf_frm (&_printf_lit_frm, ##__VA_ARGS__); \
+} while (0)
+
 /*!
  * Tailor this in order to connect printf functionality
  * to your hardware (stdout).
@@ -48,6 +48,10 @@
  * %d      YES     singed int         YES    singed int
  * %u      YES    unsinged int        YES   unsinged int
  * %l      NO     (%d)                NO    (%d)
+ * %hh.    YES    char (d,i,u,x,X,o)  NO    (int)
+ * %h.     YES    short               NO    (int)
+ * %l.     YES    long                NO    (int)
+ * %ll.    YES    long long           NO    (int)
  * %x      YES    unsinged int        NO    (%u)
  * %X      YES    unsinged int        NO    (%u)
  * %o      NO     (%x)                NO    (%u)
@@ -58,9 +62,9 @@
  * %f      YES    double              YES   double
  * %L      NO     (%f)                NO    (%f)
  * %e      YES    double              NO    (%f)
- * %E      NO     (%e)                NO    (%f)
- * %g      NO     (%f)                NO    (%f)
- * %G      NO     (%f)                NO    (%f)
+ * %E      YES    double              NO    (%f)
+ * %g      YES    double              NO    (%f)
+ * %G      YES    double              NO    (%f)
  * NaN     YES    "NaN"               NO     --
  * INF     YES    "INF"               NO     --
  * OTHERS  NO     (%u)                NO    (%u)  (NOTE)
@@ -68,6 +72,13 @@
  *
  * NOTE: ALL other convertion types are interpreted as unsigned int (%u).
  *
+ * Doubles are converted to round trip digits (Grisu2, 17 at most) and then
+ * correctly rounded to the requested precision, so there is no range limit.
+ * Digits beyond the round trip ones are printed as zeros.
+ * %g without precision prints digits that read back to the same double,
+ * for example printf("%g", 0.1) prints "0.1". They are the shortest ones
+ * for almost all values, but not always; a rare value may get one more.
+ *
  * <pre>
  * Flags:
  * -----------
@@ -79,7 +90,7 @@
  *
  * '-'      Not supported, ignored
  * '''      Not supported, ignored
- * '#'      Not supported, ignored
+ * '#'      Keep trailing zeros in %g, ignored for all other types
  * '*'      Not supported, ignored
  *</pre>
  *
@@ -121,9 +132,8 @@
  * </pre>
  *
  * \todo
- * 1. Implement the long long int type
- * 2. Implement the long double type
- * 3. Report the bug and fix the code
+ * 1. Implement the long double type
+ * 2. Report the bug and fix the code
  *
  */
 
@@ -142,6 +152,13 @@ extern "C" {
  */
 int vsprintf(char *dst, const char *frm, __VALIST ap);
 int sprintf(char *dst, const char *frm, ...);
+int vsnprintf(char *dst, size_t size, const char *frm, __VALIST ap);
+int snprintf(char *dst, size_t size, const char *frm, ...);
+
+int vsprintf_frm(char *dst, _io_frm_t *cf, __VALIST ap);
+int sprintf_frm(char *dst, _io_frm_t *cf, ...);
+int vsnprintf_frm(char *dst, size_t size, _io_frm_t *cf, __VALIST ap);
+int snprintf_frm(char *dst, size_t size, _io_frm_t *cf, ...);
 
 /*!
  * Tailor this in order to connect printf functionality
@@ -44,6 +44,10 @@
  * %d      YES     singed int         YES    singed int
  * %u      YES    unsinged int        YES   unsinged int
  * %l      NO     (%d)                NO    (%d)
+ * %hh.    YES    char (d,i,u,x,X,o)  NO    (int)
+ * %h.     YES    short               NO    (int)
+ * %l.     YES    long                NO    (int)
+ * %ll.    YES    long long           NO    (int)
  * %x      YES    unsinged int        NO    (%u)
  * %X      YES    unsinged int        NO    (%u)
  * %o      NO     (%x)                NO    (%u)
@@ -51,9 +55,10 @@
  * %c      YES    char                YES   char
  * %s      YES    char *              YES   char *
  * ----------------------------------------------------------------
- * %f      YES    double              YES   double
+ * %f      YES    float               YES   float
+ * %lf     YES    double              NO    (%f)
  * %L      NO     (%f)                NO    (%f)
- * %e      YES    double              NO    (%f)
+ * %e      YES    float               NO    (%f)
  * %E      NO     (%e)                NO    (%f)
  * %g      NO     (%f)                NO    (%f)
  * %G      NO     (%f)                NO    (%f)
@@ -117,9 +122,8 @@
  * </pre>
  *
  * \todo
- * 1. Implement the long long int type
- * 2. Implement the long double type
- * 3. Report the bug and fix the code
+ * 1. Implement the long double type
+ * 2. Report the bug and fix the code
  *
  */
 
@@ -139,6 +143,9 @@ extern "C" {
 int vsscanf (const char *src, const char *frm, __VALIST ap);
 int sscanf (const char *src, const char *frm, ...);
 
+int vsscanf_frm (const char *src, _io_frm_t *cf, __VALIST ap);
+int sscanf_frm (const char *src, _io_frm_t *cf, ...);
+
 
 /*!
  * Tailor this in order to connect scanf functionality
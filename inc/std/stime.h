@@ -59,6 +59,8 @@ extern "C" {
 int isleap(int year);
 time_t smktime (struct tm *_timeptr);
 struct tm *sgmtime (const time_t *_timer);
+struct tm *sgmtime_r (const time_t *_timer, struct tm *_result);
+void sgmtime_batch (const time_t *_timers, struct tm *_results, size_t n);
 
 #ifdef __cplusplus
 }
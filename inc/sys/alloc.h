@@ -0,0 +1,138 @@
+/*
+ * \file alloc.h
+ * \brief
+ *    Arena and fixed block pool allocators, with a pluggable allocator
+ *    hook for the toolbox modules that allocate their state.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __alloc_h__
+#define __alloc_h__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tbx_types.h>
+#include <toolbox_defs.h>
+
+/*
+ * User defines
+ */
+#ifndef ALC_ALIGN
+#define ALC_ALIGN          (8)      /*!< Alignment of arena/pool allocations. Must be power of 2 */
+#endif
+
+/*
+ * General defines
+ */
+#define _alc_align(_s)     ( ((_s) + (ALC_ALIGN-1)) & ~((size_t)ALC_ALIGN-1) )
+
+/*
+ * =================== Data types =====================
+ */
+
+typedef void* (*alc_alloc_ft) (void*, size_t, size_t);   //!< calloc() like allocation function. Gets ctx, count and size
+typedef void  (*alc_free_ft) (void*, void*);             //!< free() like function. Gets ctx and pointer
+
+/*!
+ * Allocator hook. Toolbox modules that allocate their state, accept a
+ * pointer to this. A null pointer selects the default allocator
+ * \sa alc_link_default().
+ */
+typedef struct {
+   alc_alloc_ft   alloc;   /*!< Pointer to allocation function. Returns zeroed memory */
+   alc_free_ft    free;    /*!< Pointer to free function (can be null) */
+   void           *ctx;    /*!< Allocator's context (the arena or pool object) */
+}alc_t;
+
+/*!
+ * Arena (bump) allocator data type.
+ * Allocations are O(1) and there is no free of individual objects. The
+ * entire arena is released at once with \sa arena_reset(), or back to
+ * a previous mark with \sa arena_rollback().
+ */
+typedef struct {
+   byte_t   *base;      /*!< Pointer to arena's memory */
+   size_t   size;       /*!< Arena's size in bytes */
+   size_t   top;        /*!< The first free byte offset */
+}arena_t;
+
+/*!
+ * Fixed block pool allocator data type.
+ * The free blocks are kept in a single linked list inside the blocks.
+ */
+typedef struct {
+   byte_t   *base;      /*!< Pointer to pool's memory */
+   void     *head;      /*!< Free list head */
+   size_t   bsize;      /*!< Block size (aligned) */
+   uint32_t blocks;     /*!< Total number of blocks */
+   uint32_t nfree;      /*!< Number of free blocks */
+}pool_t;
+
+
+/*
+ *  ============= PUBLIC alloc API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+void alc_link_default (const alc_t *alc);
+
+/*
+ * User Functions
+ */
+void* alc_calloc (const alc_t *alc, size_t n, size_t size);
+void alc_free (const alc_t *alc, void *p);
+
+void arena_init (arena_t *a, void *mem, size_t size);
+void* arena_alloc (arena_t *a, size_t size);
+void* arena_calloc (arena_t *a, size_t n, size_t size);
+size_t arena_mark (arena_t *a);
+void arena_rollback (arena_t *a, size_t mark);
+void arena_reset (arena_t *a);
+size_t arena_used (arena_t *a);
+void arena_alc (arena_t *a, alc_t *alc);
+
+uint32_t pool_init (pool_t *p, void *mem, size_t size, size_t bsize);
+void* pool_alloc (pool_t *p);
+void pool_free (pool_t *p, void *b);
+void pool_reset (pool_t *p);
+void pool_alc (pool_t *p, alc_t *alc);
+
+/*!
+ * \note
+ *    Static sizing helpers. The memory needed for an arena of objects is
+ *    the sum of ARENA_SIZE() for each allocation. For example:
+ *    \code
+ *       static byte_t dsp_mem [ARENA_SIZE (100, sizeof(double)) * CHANNELS];
+ *    \endcode
+ */
+#define ARENA_SIZE(_n, _size)          ( _alc_align ((size_t)(_n) * (_size)) )
+#define POOL_SIZE(_blocks, _bsize)     ( (size_t)(_blocks) * _alc_align ((_bsize) < sizeof(void*) ? sizeof(void*) : (_bsize)) )
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif   //#ifndef __alloc_h__
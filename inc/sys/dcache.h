@@ -0,0 +1,131 @@
+/*!
+ * \file dcache.h
+ * \brief
+ *    A target independent sector cache for block devices, to sit
+ *    between FatFs's diskio layer and the drivers.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __dcache_h__
+#define __dcache_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <tbx_ioctl.h>
+#include <tbx_types.h>
+#include <stdint.h>
+#include <string.h>
+
+/* =================== User Defines ===================== */
+
+#define DC_NUMBER_OF_DRIVES      (2)      /*!< Number of cached drives */
+#define DC_SECTOR_SIZE           (512)    /*!< Sector size in bytes */
+#define DC_MAX_LINES             (32)     /*!< Maximum number of cache lines (sectors) per drive */
+#define DC_READ_AHEAD            (4)      /*!< Sectors to read ahead on sequential reads */
+
+/* =================== Data types ===================== */
+
+/*!
+ * Back-end function types. They match the sd_spi driver's API, so
+ * sd_read(), sd_write() and sd_ioctl() can be linked directly.
+ * Other drivers need a small glue function.
+ */
+typedef drv_status_en (*dc_read_ft)  (int drv, uint32_t sector, uint8_t *buf, size_t count);
+typedef drv_status_en (*dc_write_ft) (int drv, uint32_t sector, const uint8_t *buf, size_t count);
+typedef drv_status_en (*dc_ioctl_ft) (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf);
+
+/*!
+ * Cache line descriptor
+ */
+typedef struct {
+   uint32_t       sector;  /*!< The cached sector */
+   uint32_t       used;    /*!< Last use time stamp for LRU */
+   uint8_t        valid;   /*!< Line holds a sector */
+   uint8_t        dirty;   /*!< Line is not written to the back-end yet */
+}dc_line_t;
+
+/*!
+ * Cached drive
+ */
+typedef struct {
+   dc_read_ft     read;    /*!< Back-end's read function */
+   dc_write_ft    write;   /*!< Back-end's write function, optional */
+   dc_ioctl_ft    ioctl;   /*!< Back-end's ioctl function, optional */
+   dc_line_t      line[DC_MAX_LINES];  /*!< Line descriptors */
+   uint8_t*       mem;     /*!< Line data, contiguous, DC_SECTOR_SIZE per line */
+   int            lines;   /*!< Number of lines */
+   uint32_t       tick;    /*!< LRU time base */
+   uint32_t       next;    /*!< The sector after the last read, for sequential detection */
+   uint32_t       hits;    /*!< Sectors served from the cache */
+   uint32_t       misses;  /*!< Sectors read from the back-end */
+   drv_status_en  status;  /*!< Cache status */
+}dc_drive_t;
+
+
+/*
+ *  ============= PUBLIC dcache API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+void dc_link_read (int drv, dc_read_ft fun);
+void dc_link_write (int drv, dc_write_ft fun);
+void dc_link_ioctl (int drv, dc_ioctl_ft fun);
+
+/*
+ * Set functions
+ */
+
+/*
+ * User Functions
+ */
+drv_status_en dc_init (int drv, void *mem, size_t size);
+void dc_deinit (int drv);
+
+drv_status_en dc_read (int drv, uint32_t sector, uint8_t *buf, size_t count);
+drv_status_en dc_write (int drv, uint32_t sector, const uint8_t *buf, size_t count);
+drv_status_en dc_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf);
+drv_status_en dc_sync (int drv);
+drv_status_en dc_invalidate (int drv);
+
+/*!
+ * \note
+ *    The diskio glue calls the cache instead of the driver:
+ * \code
+ *    static uint8_t sd_cache[8*DC_SECTOR_SIZE];
+ *
+ *    dc_link_read (0, sd_read);
+ *    dc_link_write (0, sd_write);
+ *    dc_link_ioctl (0, sd_ioctl);
+ *    dc_init (0, sd_cache, sizeof (sd_cache));
+ *
+ *    DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, BYTE count) {
+ *       return (dc_read (pdrv, sector, buff, count) == DRV_READY) ? RES_OK : RES_ERROR;
+ *    }
+ * \endcode
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   //#ifndef __dcache_h__
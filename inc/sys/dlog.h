@@ -0,0 +1,145 @@
+/*
+ * \file dlog.h
+ * \brief
+ *    Binary deferred logging. The hot path captures the format, a
+ *    timestamp and the raw arguments to a lock-free ring and the
+ *    formatting is done later by a background consumer.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __dlog_h__
+#define __dlog_h__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <tbx_types.h>
+#include <toolbox_defs.h>
+#include <std/_vsxprintf.h>
+#include <sys/jiffies.h>
+
+/*
+ * User defines
+ */
+#ifndef DLOG_MAX_RECORD
+#define DLOG_MAX_RECORD    (128)    /*!< Maximum record size in bytes, header included */
+#endif
+#ifndef DLOG_MAX_ARGS
+#define DLOG_MAX_ARGS      (16)     /*!< Maximum captured arguments per record */
+#endif
+#ifndef DLOG_MAX_STR
+#define DLOG_MAX_STR       (32)     /*!< Maximum captured characters of a %s argument */
+#endif
+
+/*
+ * General defines
+ */
+#define DLOG_REC_TRUNC     (0x01)   /*!< Record flag, some arguments did not fit */
+
+/*
+ * =================== Data types =====================
+ */
+
+/*!
+ * Record header. The raw arguments follow, packed, in the order of the
+ * format's specifiers: 4 bytes for ints, 8 for long longs and doubles,
+ * and for strings a length byte followed by the characters and the terminator.
+ */
+typedef struct {
+   uint16_t    size;       /*!< Record size, header included */
+   uint8_t     nargs;      /*!< Captured arguments */
+   uint8_t     flags;      /*!< Record flags */
+   _io_frm_t   *cf;        /*!< The compiled format. Host-side decoders resolve it against the firmware image */
+   jiffy64_t   ts;         /*!< Timestamp */
+}dlog_rec_t;
+
+/*!
+ * Deferred log data type. A single producer, single consumer byte ring.
+ * The indexes run free and wrap with the ring's (power of 2) size.
+ */
+typedef struct {
+   byte_t            *buf;       /*!< Ring buffer */
+   uint32_t          size;       /*!< Ring size, power of 2 */
+   volatile uint32_t head;       /*!< Producer's index */
+   volatile uint32_t tail;       /*!< Consumer's index */
+   volatile uint32_t dropped;    /*!< Records dropped because the ring was full */
+   jf_clock64_pt     clock;      /*!< Timestamp source */
+   uint32_t          freq;       /*!< Timestamp source frequency, 0 for jiffies' \sa jf_get_freq64() */
+   uint8_t           stamp;      /*!< Prefix the formatted records with their timestamp */
+}dlog_t;
+
+
+/*
+ *  ============= PUBLIC dlog API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+void dlog_link_clock (dlog_t *lg, jf_clock64_pt clk, uint32_t freq);
+
+/*
+ * Set functions
+ */
+void dlog_set_stamp (dlog_t *lg, uint8_t en);
+
+/*
+ * User Functions
+ */
+int dlog_init (dlog_t *lg, void *mem, uint32_t size);
+uint32_t dlog_dropped (dlog_t *lg);
+
+int vdlog_frm (dlog_t *lg, _io_frm_t *cf, __VALIST ap);
+int dlog_frm (dlog_t *lg, _io_frm_t *cf, ...);
+
+uint32_t dlog_pop (dlog_t *lg, void *rec, uint32_t size);
+int dlog_format (dlog_t *lg, const void *rec, _io_sink_t *sk);
+int dlog_flush (dlog_t *lg, _io_sink_t *sk);
+
+/*!
+ * Deferred log with a string literal format, compiled once on the first call.
+ * For example:
+ * \code
+ *    dlog_lit (&lg, "adc %d: %u mV\n", ch, mv);   // ISR, no formatting here
+ *    ...
+ *    dlog_flush (&lg, &uart_sink);                // background task
+ * \endcode
+ */
+#define dlog_lit(_lg, _lit, ...)    do {              \
+   io_frm_static (_dlog_lit_frm, _lit);               \
+   dlog_frm ((_lg), &_dlog_lit_frm, ##__VA_ARGS__);   \
+} while (0)
+
+/*!
+ * \note
+ *    There must be only one producer per dlog_t (a thread or an ISR) and
+ *    one consumer. Use a dlog_t per producer for more. Records that do not
+ *    fit in the ring are dropped and counted \sa dlog_dropped().
+ *    String arguments are copied (up to DLOG_MAX_STR characters), all the
+ *    other arguments are captured as raw values.
+ */
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif   //#ifndef __dlog_h__
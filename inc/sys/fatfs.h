@@ -205,6 +205,7 @@ typedef enum {
 
 FRESULT f_mount (BYTE vol, FATFS* fs);								/* Mount/Unmount a logical drive */
 FRESULT f_open (FIL* fp, const TCHAR* path, BYTE mode);				/* Open or create a file */
+FRESULT f_openmap (FIL* fp, const TCHAR* path, BYTE mode, DWORD* tbl);	/* Open a file in fast seek mode */
 FRESULT f_read (FIL* fp, void* buff, UINT btr, UINT* br);			/* Read data from a file */
 FRESULT f_lseek (FIL* fp, DWORD ofs);								/* Move file pointer of a file object */
 FRESULT f_close (FIL* fp);											/* Close an open file object */
@@ -0,0 +1,151 @@
+/*!
+ * \file hostdisk.h
+ * \brief
+ *    RAM-disk and host image file block device, with I/O statistics and
+ *    timing injection, for testing and benchmarking the diskio path.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __hostdisk_h__
+#define __hostdisk_h__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <tbx_ioctl.h>
+#include <tbx_types.h>
+#include <sys/jiffies.h>
+#include <stdint.h>
+#include <string.h>
+
+/* =================== User Defines ===================== */
+
+#define HD_NUMBER_OF_DRIVES      (2)      /*!< Number of host disks */
+#define HD_SECTOR_SIZE           (512)    /*!< Sector size in bytes */
+#define HD_HIST_SIZE             (8)      /*!< Request size histogram buckets, 1, 2-3, 4-7, ... sectors */
+
+/* =================== Data types ===================== */
+
+/*!
+ * Timing model of the emulated media. The delays are busy waits on
+ * jf_get_nsec64(), as a polled driver would spend them.
+ */
+typedef struct {
+   uint32_t       cmd_nsec;   /*!< Per call overhead, command and response */
+   uint32_t       seek_nsec;  /*!< Extra for a call not sequential to the previous one */
+   uint32_t       rd_nsec;    /*!< Per sector read */
+   uint32_t       wr_nsec;    /*!< Per sector write, including programming */
+}hd_timing_t;
+
+/*!
+ * Timing presets
+ */
+#define HD_TIMING_SD_SPI      { 100000, 0,      210000, 460000 }  /*!< SD card on a 20MHz SPI bus */
+#define HD_TIMING_NOR_FLASH   { 2000,   0,      26000,  600000 }  /*!< Serial NOR flash, 80MHz SPI, page programming */
+
+/*!
+ * I/O statistics
+ */
+typedef struct {
+   uint32_t       reads;         /*!< Read calls */
+   uint32_t       writes;        /*!< Write calls */
+   uint64_t       rd_sectors;    /*!< Sectors read */
+   uint64_t       wr_sectors;    /*!< Sectors written */
+   uint32_t       rd_seq;        /*!< Read calls sequential to the previous call */
+   uint32_t       wr_seq;        /*!< Write calls sequential to the previous call */
+   uint64_t       rd_nsec;       /*!< Total read latency */
+   uint64_t       wr_nsec;       /*!< Total write latency */
+   uint32_t       rd_max_nsec;   /*!< Worst read call latency */
+   uint32_t       wr_max_nsec;   /*!< Worst write call latency */
+   uint32_t       hist[HD_HIST_SIZE];  /*!< Calls per request size, log2 buckets */
+}hd_stats_t;
+
+/*!
+ * Access trace callback. Gets the drive, the direction, the request
+ * and its latency, after each read or write call.
+ */
+typedef void (*hd_trace_ft) (int drv, uint8_t write, uint32_t sector, size_t count, uint32_t nsec);
+
+/*!
+ * Host disk
+ */
+typedef struct {
+   uint8_t*       mem;     /*!< The disk's data */
+   uint32_t       sectors; /*!< The disk's size in sectors */
+   int            fd;      /*!< Image file descriptor, or -1 for RAM disks */
+   uint8_t        wp;      /*!< Write protect flag */
+   uint32_t       next;    /*!< The sector after the last access */
+   hd_timing_t    timing;  /*!< Injected timing */
+   hd_stats_t     stats;   /*!< I/O statistics */
+   hd_trace_ft    trace;   /*!< Access trace callback, optional */
+   drv_status_en  status;  /*!< Disk status */
+}hd_drive_t;
+
+
+/*
+ *  ============= PUBLIC hostdisk API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+void hd_link_trace (int drv, hd_trace_ft fun);
+
+/*
+ * Set functions
+ */
+void hd_set_timing (int drv, const hd_timing_t *t);
+void hd_set_wp (int drv, uint8_t on);
+
+/*
+ * User Functions
+ */
+drv_status_en hd_init_ram (int drv, void *mem, uint32_t sectors);
+#if defined (__linux__)
+drv_status_en hd_init_file (int drv, const char *path, uint32_t sectors);
+#endif
+void hd_deinit (int drv);
+
+drv_status_en hd_read (int drv, uint32_t sector, uint8_t *buf, size_t count);
+drv_status_en hd_write (int drv, uint32_t sector, const uint8_t *buf, size_t count);
+drv_status_en hd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf);
+
+void hd_get_stats (int drv, hd_stats_t *st);
+void hd_clear_stats (int drv);
+
+/*!
+ * \note
+ *    hd_read(), hd_write() and hd_ioctl() have the sd_spi signatures, so the
+ *    same diskio glue serves both, and they can be linked under sys/dcache.
+ *    Latencies are measured with jf_get_nsec64(). On a host link a clock first:
+ * \code
+ *    const hd_timing_t sd = HD_TIMING_SD_SPI;
+ *
+ *    jf_link_clock64 (jf_clock64_monotonic, 1000000000);
+ *    hd_init_file (0, "sd.img", 65536);
+ *    hd_set_timing (0, &sd);
+ * \endcode
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   //#ifndef __hostdisk_h__
@@ -34,8 +34,11 @@
 #include <toolbox_defs.h>
 
 typedef uint16_t     jiffy_t;       //!< Jiffy type 2 byte unsigned integer
+typedef uint64_t     jiffy64_t;     //!< Extended (wrap counted) monotonic jiffy type
 typedef int32_t      jtime_t;        //!< Jiffy time type for delay functionalities usec/msec
 typedef int          (*jf_setfreq_pt) (uint32_t, uint32_t);   //!< Pointer to setfreq function \sa setfreq
+typedef jiffy64_t    (*jf_clock64_pt) (void);   //!< Pointer to a free running 64bit clock source
+typedef void         (*jf_lock_pt) (void);      //!< Pointer to a critical section enter/exit function
 
 /*!
  * Jiffy inner structure,
@@ -60,6 +63,12 @@ typedef volatile struct {
    jiffy_t        jp1ms;         /*!< Jiffies per 1 msec to use in delay function */
    jiffy_t        jp1us;         /*!< Jiffies per 1 usec to use in delay function */
    jiffy_t        jp100ns;       /*!< Jiffies per 100 nsec to use in delay function */
+   jf_clock64_pt  clock64;       /*!< Pointer to an optional 64bit clock source (cycle counter, clock_gettime() etc) */
+   uint32_t       freq64;        /*!< 64bit clock source frequency */
+   jiffy64_t      ext;           /*!< Wrap counted jiffies, up to the last read of the timer */
+   jiffy_t        last;          /*!< The last timer value read by the extended clock */
+   jf_lock_pt     lock;          /*!< Critical section enter, guards ext and last - Optional */
+   jf_lock_pt     unlock;        /*!< Critical section exit - Optional */
    drv_status_en  status;
 }jf_t;
 
@@ -73,6 +82,8 @@ typedef volatile struct {
  */
 void jf_link_setfreq (jf_setfreq_pt pfun);
 void jf_link_value (jiffy_t* v);
+void jf_link_clock64 (jf_clock64_pt pfun, uint32_t freq);
+void jf_link_lock (jf_lock_pt lock, jf_lock_pt unlock);
 
 /*
  * Set functions
@@ -98,10 +109,35 @@ int jf_check_msec (jtime_t msec);
 int jf_check_usec (jtime_t usec);
 int jf_check_100nsec (jtime_t _100nsec);
 
+/*
+ * 64bit monotonic time base
+ */
+jiffy64_t jf_get_jiffy64 (void);
+uint32_t  jf_get_freq64 (void);
+uint64_t  jf_jiffy2nsec (jiffy64_t j);
+jiffy64_t jf_nsec2jiffy (uint64_t nsec);
+uint64_t  jf_get_nsec64 (void);
+
+#if defined (__linux__)
+jiffy64_t jf_clock64_monotonic (void);
+#endif
+
 /*!
  * \note
  * The Jiffy lib has no jiffy_t target pointer in the API. This means
  * that IT CAN BE ONLY ONE jiffy timer per application.
+ *
+ * The 64bit time base extends the jiffy timer by counting its wraps
+ * in software. So \sa jf_get_jiffy64() has to be called at least once
+ * every timer period (a call from the SysTick handler is enough).
+ * If a 64bit clock source is linked with \sa jf_link_clock64() it is
+ * used instead and there is no such restriction.
+ *
+ * The wrap counting updates a 64bit value, which is not atomic. If
+ * jf_get_jiffy64() is called from more than one context, ex: the SysTick
+ * handler and thread code, link a critical section with \sa jf_link_lock(),
+ * ex: functions that disable and re-enable the timer's interrupt level.
+ * Without it, jf_get_jiffy64() must have a single caller context.
  */
 
 
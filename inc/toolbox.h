@@ -104,6 +104,7 @@ extern "C" {
 #include <drv/sd_spi.h>
 #include <drv/ss_display.h>
 #include <drv/s25fs_spi.h>
+#include <drv/s25fs_ftl.h>
 #include <drv/ds2431.h>
 #include <drv/ds28ec20.h>
 
@@ -117,6 +118,7 @@ extern "C" {
  */
 #include <dsp/leaky_int.h>
 #include <dsp/filter_mova.h>
+#include <dsp/mvstat.h>
 #include <dsp/fir_wsinc.h>
 #include <dsp/vectors.h>
 #include <dsp/conv.h>
@@ -137,6 +139,7 @@ extern "C" {
 #include <std/sprintf.h>
 #include <std/printf.h>
 #include <std/stime.h>
+//#include <std/fstdio.h>
 
 /*!
  * \defgroup System
@@ -145,6 +148,8 @@ extern "C" {
 //#include <sys/fatfs.h>
 //#include <sys/ffconf.h>
 //#include <sys/integer.h>
+#include <sys/alloc.h>
+#include <sys/dlog.h>
 #include <sys/jiffies.h>
 #include <sys/semaphore.h>
 #include <sys/make_shared.h>
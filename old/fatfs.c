@@ -1060,29 +1060,78 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 /*-----------------------------------------------------------------------*/
 
 #if _USE_FASTSEEK
+static
+DWORD* clmt_frag (	/* 0:Error, else pointer to the fragment's {end, top} pair */
+	FIL* fp,		/* Pointer to the file object */
+	DWORD cl		/* Cluster order from top of the file */
+)
+{
+	DWORD *tbl;
+	UINT lo, hi, mid;
+
+
+	tbl = fp->cltbl + 1;	/* Top of CLMT, {cumulative end, top cluster} pairs */
+	lo = 0; hi = (UINT)(fp->cltbl[0] - 2) / 2;	/* Number of fragments */
+	while (lo < hi) {		/* Binary search the first fragment ending beyond cl */
+		mid = (lo + hi) / 2;
+		if (cl < tbl[mid * 2]) hi = mid;
+		else lo = mid + 1;
+	}
+	if (!tbl[lo * 2]) return 0;	/* End of table? (error) */
+	return &tbl[lo * 2];
+}
+
 static
 DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
 	FIL* fp,		/* Pointer to the file object */
 	DWORD ofs		/* File offset to be converted to cluster# */
 )
 {
-	DWORD cl, ncl, *tbl;
+	DWORD cl, *frag;
 
 
-	tbl = fp->cltbl + 1;	/* Top of CLMT */
 	cl = ofs / SS(fp->fs) / fp->fs->csize;	/* Cluster order from top of the file */
-	for (;;) {
-		ncl = *tbl++;			/* Number of cluters in the fragment */
-		if (!ncl) return 0;		/* End of table? (error) */
-		if (cl < ncl) break;	/* In this fragment? */
-		cl -= ncl; tbl++;		/* Next fragment */
-	}
-	return cl + *tbl;	/* Return the cluster number */
+	frag = clmt_frag(fp, cl);
+	if (!frag) return 0;
+	return frag[1] + cl - ((frag > fp->cltbl + 1) ? frag[-2] : 0);	/* Return the cluster number */
 }
 #endif	/* _USE_FASTSEEK */
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Count contiguous clusters                              */
+/*-----------------------------------------------------------------------*/
+
+static
+DWORD clust_run (	/* Number of contiguous clusters from clst (1..max) */
+	FIL* fp,		/* Pointer to the file object */
+	DWORD clst,		/* Cluster to start from */
+	DWORD max		/* Maximum clusters wanted */
+)
+{
+	DWORD n, cl;
+#if _USE_FASTSEEK
+	DWORD *frag;
+
+	if (fp->cltbl) {	/* The CLMT has the fragment's bounds */
+		cl = fp->fptr / SS(fp->fs) / fp->fs->csize;	/* Cluster order of clst */
+		frag = clmt_frag(fp, cl);
+		if (!frag) return 1;
+		n = frag[0] - cl;
+		return (n < max) ? n : max;
+	}
+#endif
+	for (n = 1; n < max; n++) {	/* Follow the FAT while the chain is contiguous */
+		cl = get_fat(fp->fs, clst + n - 1);
+		if (cl != clst + n) break;
+	}
+	return n;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Set directory index                              */
 /*-----------------------------------------------------------------------*/
@@ -2456,6 +2505,37 @@ FRESULT f_open (
 
 
 
+#if _USE_FASTSEEK && _FS_MINIMIZE <= 2
+/*-----------------------------------------------------------------------*/
+/* Open a File in Fast Seek Mode                                         */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_openmap (
+	FIL *fp,			/* Pointer to the blank file object */
+	const TCHAR *path,	/* Pointer to the file name */
+	BYTE mode,			/* Access mode and file open mode flags */
+	DWORD *tbl			/* Cluster link map table, tbl[0] is its size in items */
+)
+{
+	FRESULT res;
+
+
+	res = f_open(fp, path, mode);
+	if (res == FR_OK && tbl && fp->sclust) {
+		fp->cltbl = tbl;
+		res = f_lseek(fp, CREATE_LINKMAP);	/* Create the CLMT */
+		if (res == FR_NOT_ENOUGH_CORE) {	/* Too fragmented, stay in normal seek mode. */
+			fp->cltbl = 0;					/* tbl[0] has the required size */
+			res = FR_OK;
+		}
+	}
+	return res;
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Read File                                                             */
 /*-----------------------------------------------------------------------*/
@@ -2508,8 +2588,13 @@ FRESULT f_read (
 			sect += csect;
 			cc = btr / SS(fp->fs);				/* When remaining bytes >= sector size, */
 			if (cc) {							/* Read maximum contiguous sectors directly */
-				if (csect + cc > fp->fs->csize)	/* Clip at cluster boundary */
-					cc = fp->fs->csize - csect;
+				if (cc > 255) cc = 255;			/* disk_read() takes up to 255 sectors */
+				if (csect + cc > fp->fs->csize) {	/* Crosses the cluster boundary? */
+					clst = clust_run(fp, fp->clust, (csect + cc + fp->fs->csize - 1) / fp->fs->csize);
+					if (csect + cc > clst * fp->fs->csize)	/* Clip at the end of the contiguous run */
+						cc = clst * fp->fs->csize - csect;
+					fp->clust += (csect + cc - 1) / fp->fs->csize;	/* Last cluster read */
+				}
 				if (disk_read(fp->fs->drv, rbuff, sect, (BYTE)cc) != RES_OK)
 					ABORT(fp->fs, FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */
@@ -2912,11 +2997,12 @@ FRESULT f_lseek (
 
 #if _USE_FASTSEEK
 	if (fp->cltbl) {	/* Fast seek */
-		DWORD cl, pcl, ncl, tcl, dsc, tlen, ulen, *tbl;
+		DWORD cl, pcl, ncl, tcl, dsc, tlen, ulen, tot, *tbl;
 
 		if (ofs == CREATE_LINKMAP) {	/* Create CLMT */
 			tbl = fp->cltbl;
 			tlen = *tbl++; ulen = 2;	/* Given table size and required table size */
+			tot = 0;					/* Clusters up to the end of the fragment */
 			cl = fp->sclust;			/* Top of the chain */
 			if (cl) {
 				do {
@@ -2928,8 +3014,9 @@ FRESULT f_lseek (
 						if (cl <= 1) ABORT(fp->fs, FR_INT_ERR);
 						if (cl == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
 					} while (cl == pcl + 1);
-					if (ulen <= tlen) {		/* Store the length and top of the fragment */
-						*tbl++ = ncl; *tbl++ = tcl;
+					tot += ncl;
+					if (ulen <= tlen) {		/* Store the cumulative end and top of the fragment */
+						*tbl++ = tot; *tbl++ = tcl;
 					}
 				} while (cl < fp->fs->n_fatent);	/* Repeat until end of chain */
 			}
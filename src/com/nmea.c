@@ -100,6 +100,7 @@ static float _dec2nmea (float c);
 static int _match (char *sen, char *word, int n);
 static nmea_msgid_en _msgid_type (char *str);
 static char * _msgid_str (nmea_msgid_en id);
+static int _hex (char c);
 //!@}
 
 //! \name Extract tools
@@ -135,6 +136,18 @@ static int _get_token (char *str, char *token);
 static int _checksum_chk (char *str);
 static int _read_until (nmea_t *nmea, nmea_msgid_en id);
 static int _tokenise (nmea_t *nmea, const parse_obj_en *format, nmea_common_t *obj);
+static int _dispatch (nmea_t *nmea);
+//!@}
+
+//! \name Sentence extraction
+//!@{
+static drv_status_en _extract_gga (nmea_t *nmea, nmea_gga_t *gga);
+static drv_status_en _extract_gll (nmea_t *nmea, nmea_gll_t *gll);
+static drv_status_en _extract_gsa (nmea_t *nmea, nmea_gsa_t *gsa);
+static drv_status_en _extract_gsv (nmea_t *nmea, nmea_gsv_t *gsv);
+static drv_status_en _extract_rmc (nmea_t *nmea, nmea_rmc_t *rmc);
+static drv_status_en _extract_vtg (nmea_t *nmea, nmea_vtg_t *vtg);
+static drv_status_en _extract_zda (nmea_t *nmea, nmea_zda_t *zda);
 //!@}
 
 
@@ -223,6 +236,19 @@ static char * _msgid_str (nmea_msgid_en id)
    return NULL;
 }
 
+/*!
+ * \brief
+ *    Converts a hex digit to its value
+ * \return  The value, or -1 for non hex characters
+ */
+static int _hex (char c)
+{
+   if (c >= '0' && c <= '9')  return c - '0';
+   if (c >= 'A' && c <= 'F')  return c - 'A' + 10;
+   if (c >= 'a' && c <= 'f')  return c - 'a' + 10;
+   return -1;
+}
+
 
 /*
  * ============== Extract tools ==============
@@ -642,7 +668,8 @@ static int _get_sen (nmea_t *nmea)
 
 /*!
  * \brief
- *    Get the next token from string
+ *    Get the next token from string. Tokens longer than NMEA_TOKEN_SIZE-1
+ *    are truncated and past the end of the string all tokens are empty.
  * \param   str   Pointer to string to search into
  * \param   token Pointer to token to return
  * \return        The size of token
@@ -650,14 +677,21 @@ static int _get_sen (nmea_t *nmea)
 static int _get_token (char *str, char *token)
 {
    char *s = str;
+   int  n = 0;
    while (1) {
-      if (NMEA_IS_DELIMITER (*s)) {
+      if (*s == 0) {
+         *token = 0;
+         return s - str;   // end of sentence
+      }
+      else if (NMEA_IS_DELIMITER (*s)) {
          ++s;
          *token = 0;
          return s - str;   // eat next delimiter
       }
-      else
+      else if (++n < NMEA_TOKEN_SIZE)
          *token++ = *s++;
+      else
+         ++s;
    }
    return 0;
 }
@@ -675,10 +709,13 @@ static int _checksum_chk (char *str)
    char *s, *d;   // Star and dollar pointers
    int sc, cc;    // string and calculated checksum
 
-   d = strchr (str, '$');  // find where is '$'
-   s = strchr (d, '*');    // find where is '*'
+   if ((d = strchr (str, '$')) == NULL)   // find where is '$'
+      return 0;
+   if ((s = strchr (d, '*')) == NULL)     // find where is '*'
+      return 0;
 
-   sscanf (s, "*%2X\r\n", &sc);
+   if (sscanf (s, "*%2X", &sc) != 1)
+      return 0;
    for (cc=0,++d ; d<s ; ++d)
       cc ^= *d;
 
@@ -699,6 +736,8 @@ static int _read_until (nmea_t *nmea, nmea_msgid_en id)
 {
    nmea_msgid_en s=NMEA_NULL;
 
+   if (!nmea->io.in)
+      return 0;
    _get_sen (nmea);
    if ( !_checksum_chk ((char *)nmea->buf) )
       return 0;
@@ -762,6 +801,249 @@ static int _tokenise (nmea_t *nmea, const parse_obj_en *format, nmea_common_t *o
    return tk;
 }
 
+/*!
+ * \brief
+ *    Extract a complete sentence from buffer into the latest value
+ *    table and call the sentence callback.
+ * \param   nmea  Pointer to linked data to use
+ * \return        The result
+ *    \arg  0     Not a recognised sentence
+ *    \arg  1     Recognised
+ */
+static int _dispatch (nmea_t *nmea)
+{
+   char           token[NMEA_TOKEN_SIZE];
+   nmea_msgid_en  id;
+   drv_status_en  st;
+
+   // Address field, '$', 2 characters talker id and the sentence id
+   _get_token ((char*)nmea->buf, token);
+   if (strlen (token) != 6 || (id = _msgid_type (token+3)) == NMEA_NULL)
+      return 0;
+
+   switch (id) {
+      case NMEA_GGA: st = _extract_gga (nmea, &nmea->data.gga);  break;
+      case NMEA_GLL: st = _extract_gll (nmea, &nmea->data.gll);  break;
+      case NMEA_GSA: st = _extract_gsa (nmea, &nmea->data.gsa);  break;
+      case NMEA_GSV: st = _extract_gsv (nmea, &nmea->data.gsv);  break;
+      case NMEA_RMC: st = _extract_rmc (nmea, &nmea->data.rmc);  break;
+      case NMEA_VTG: st = _extract_vtg (nmea, &nmea->data.vtg);  break;
+      case NMEA_ZDA: st = _extract_zda (nmea, &nmea->data.zda);  break;
+      default:       return 0;
+   }
+   if (st == DRV_READY)
+      nmea->data.updated |= (1 << id);
+   if (nmea->sentence)
+      nmea->sentence (nmea, id, st);
+   return 1;
+}
+
+/*
+ * ============== Sentence extraction ==============
+ */
+
+/*!
+ * \brief
+ *    Extract GGA data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   gga   Pointer to gga data for the results
+ *                The gga variable is written only when we have position fix
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ */
+static drv_status_en _extract_gga (nmea_t *nmea, nmea_gga_t *gga)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.fix = NMEA_NOT_FIX;                         // mark data
+   _tokenise (nmea, _GGA, &obj);                   // tokenise
+
+   // Check to return
+   if (obj.fix != NMEA_NOT_FIX) {
+      gga->fix = obj.fix;
+      gga->sats = obj.sats;
+      gga->time = obj.time;
+      gga->latitude = obj.latitude;
+      gga->longitude = obj.longitude;
+      gga->elevation = obj.elevation;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
+/*!
+ * \brief
+ *    Extract GLL data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   gll   Pointer to gll data for the results
+ *                The gll variable is written only when we have position fix
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ */
+static drv_status_en _extract_gll (nmea_t *nmea, nmea_gll_t *gll)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.valid = NMEA_NOT_VALID;                     // mark data
+   _tokenise (nmea, _GLL, &obj);                   // tokenise
+
+   // Check to return
+   if (obj.valid != NMEA_NOT_VALID) {
+      gll->valid = obj.valid;
+      gll->time = obj.time;
+      gll->latitude = obj.latitude;
+      gll->longitude = obj.longitude;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
+/*!
+ * \brief
+ *    Extract GSA data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   gsa   Pointer to gsa data for the results
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ * \note    Not implemented yet
+ */
+static drv_status_en _extract_gsa (nmea_t *nmea, nmea_gsa_t *gsa)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   _tokenise (nmea, _GSA, &obj);             // tokenise
+
+   gsa->crap = 0;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Extract GSV data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   gsv   Pointer to gsv data for the results
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ * \note    Not implemented yet
+ */
+static drv_status_en _extract_gsv (nmea_t *nmea, nmea_gsv_t *gsv)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.sats = 0;                                   // mark data
+   _tokenise (nmea, _GSV, &obj);                   // tokenise
+
+   // Check to return
+   if (obj.sats != 0) {
+      gsv->sats = obj.sats;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
+/*!
+ * \brief
+ *    Extract RMC data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   rmc   Pointer to rmc data for the results
+ *                The rmc variable is written only when we have position fix
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ */
+static drv_status_en _extract_rmc (nmea_t *nmea, nmea_rmc_t *rmc)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.valid = NMEA_NOT_VALID;                     // mark data
+   _tokenise (nmea, _RMC, &obj);                   // tokenise
+
+   // Check to return
+   if (obj.valid != NMEA_NOT_VALID) {
+      rmc->valid = obj.valid;
+      rmc->date = obj.date;
+      rmc->time = obj.time;
+      rmc->latitude = obj.latitude;
+      rmc->longitude = obj.longitude;
+      rmc->speed_knt = obj.speed_knt;
+      rmc->course_t = obj.course_t;
+      rmc->mag_var = obj.mag_var;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
+/*!
+ * \brief
+ *    Extract VTG data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   vtg   Pointer to vtg data for the results
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ */
+static drv_status_en _extract_vtg (nmea_t *nmea, nmea_vtg_t *vtg)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.speed_knt = -1;                             // mark data
+   _tokenise (nmea, _VTG, &obj);                   // tokenise
+
+   if (obj.speed_knt != -1) {
+      vtg->course_m = obj.course_m;
+      vtg->course_t = obj.course_t;
+      vtg->speed_knt = obj.speed_knt;
+      vtg->speed_kmh = obj.speed_kmh;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
+/*!
+ * \brief
+ *    Extract ZDA data from the sentence in buffer
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   zda   Pointer to zda data for the results
+ * \return        The status of the operation
+ *    \arg  DRV_BUSY    No GPS fix
+ *    \arg  DRV_READY   Success, GPS fix
+ */
+static drv_status_en _extract_zda (nmea_t *nmea, nmea_zda_t *zda)
+{
+   nmea_common_t obj;
+
+   memset ((void*)&obj, 0, sizeof (obj));
+   obj.year = 0;                                   // mark data
+   _tokenise (nmea, _ZDA, &obj);                   // tokenise
+
+   if (obj.year != 0) {
+      zda->time = obj.time;
+      zda->day = obj.day;
+      zda->month = obj.month;
+      zda->year = obj.year;
+      zda->zone_h = obj.zone_h;
+      zda->zone_m = obj.zone_m;
+      return DRV_READY;
+   }
+   else
+      return DRV_BUSY;
+}
+
 /*!
  * \brief
  *    Stream out a string
@@ -816,6 +1098,12 @@ void nmea_link_in (nmea_t *nmea, nmea_in_ft in) {
 void nmea_link_out (nmea_t *nmea, nmea_out_ft out) {
    nmea->io.out = out;
 }
+/*!
+ * Link sentence callback to nmea data
+ */
+void nmea_link_sentence (nmea_t *nmea, nmea_sentence_ft fun) {
+   nmea->sentence = fun;
+}
 
 
 /*
@@ -851,22 +1139,25 @@ void nmea_deinit (nmea_t *nmea)
 /*!
  * \brief
  *    Initializes nmea.
+ *    The input and output functions are optional. Without them
+ *    nmea_read_xxx() and nmea_write() return DRV_ERROR and the
+ *    instance is fed by nmea_push() only.
  *
  * \param  nmea   Pointer to linked nmea data stuct to use
  * \return        The status of the operation
  */
 drv_status_en nmea_init (nmea_t *nmea)
 {
-   #define _bad_link(_link)   (!nmea->io._link) ? 1:0
-
-   if (_bad_link (in))     return nmea->status = DRV_ERROR;
-   if (_bad_link (out))    return nmea->status = DRV_ERROR;
+   if (!nmea->buf || nmea->buf_size < 2)
+      return nmea->status = DRV_ERROR;
 
    if (nmea->status == DRV_BUSY || nmea->status == DRV_NODEV)
       return nmea->status = DRV_ERROR;
 
+   memset ((void*)&nmea->push, 0, sizeof (nmea_push_t));
+   memset ((void*)&nmea->data, 0, sizeof (nmea_data_t));
+   nmea->push.st = NMEA_PS_HUNT;
    return nmea->status = DRV_READY;
-   #undef _bad_link
 }
 
 /*!
@@ -882,25 +1173,9 @@ drv_status_en nmea_init (nmea_t *nmea)
  */
 drv_status_en nmea_read_gga (nmea_t *nmea, nmea_gga_t *gga)
 {
-   nmea_common_t obj;
-
-   obj.fix = NMEA_NOT_FIX;                         // mark data
    if (_read_until (nmea, NMEA_GGA) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _GGA, &obj);                   // tokenise
-
-   // Check to return
-   if (obj.fix != NMEA_NOT_FIX) {
-      gga->fix = obj.fix;
-      gga->sats = obj.sats;
-      gga->time = obj.time;
-      gga->latitude = obj.latitude;
-      gga->longitude = obj.longitude;
-      gga->elevation = obj.elevation;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_gga (nmea, gga);
 }
 
 /*!
@@ -916,23 +1191,9 @@ drv_status_en nmea_read_gga (nmea_t *nmea, nmea_gga_t *gga)
  */
 drv_status_en nmea_read_gll (nmea_t *nmea, nmea_gll_t *gll)
 {
-   nmea_common_t obj;
-
-   obj.valid = NMEA_NOT_VALID;                     // mark data
    if (_read_until (nmea, NMEA_GLL) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _GLL, &obj);                   // tokenise
-
-   // Check to return
-   if (obj.valid != NMEA_NOT_VALID) {
-      gll->valid = obj.valid;
-      gll->time = obj.time;
-      gll->latitude = obj.latitude;
-      gll->longitude = obj.longitude;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_gll (nmea, gll);
 }
 
 /*!
@@ -948,15 +1209,9 @@ drv_status_en nmea_read_gll (nmea_t *nmea, nmea_gll_t *gll)
  */
 drv_status_en nmea_read_gsa (nmea_t *nmea, nmea_gsa_t *gsa)
 {
-   nmea_common_t obj;
-
-   // Read sentences until we find GSA
-   if (_read_until (nmea, NMEA_GSA) == 0)    // Read next sentences
+   if (_read_until (nmea, NMEA_GSA) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _GSA, &obj);             // tokenise
-
-   gsa->crap = 0;
-   return DRV_READY;
+   return _extract_gsa (nmea, gsa);
 }
 
 /*!
@@ -972,20 +1227,9 @@ drv_status_en nmea_read_gsa (nmea_t *nmea, nmea_gsa_t *gsa)
  */
 drv_status_en nmea_read_gsv (nmea_t *nmea, nmea_gsv_t *gsv)
 {
-   nmea_common_t obj;
-
-   obj.sats = 0;                                   // mark data
    if (_read_until (nmea, NMEA_GSV) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _GSV, &obj);                   // tokenise
-
-   // Check to return
-   if (obj.sats != 0) {
-      gsv->sats = obj.sats;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_gsv (nmea, gsv);
 }
 
 /*!
@@ -1001,27 +1245,9 @@ drv_status_en nmea_read_gsv (nmea_t *nmea, nmea_gsv_t *gsv)
  */
 drv_status_en nmea_read_rmc (nmea_t *nmea, nmea_rmc_t *rmc)
 {
-   nmea_common_t obj;
-
-   obj.valid = NMEA_NOT_VALID;                     // mark data
    if (_read_until (nmea, NMEA_RMC) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _RMC, &obj);                   // tokenise
-
-   // Check to return
-   if (obj.valid != NMEA_NOT_VALID) {
-      rmc->valid = obj.valid;
-      rmc->date = obj.date;
-      rmc->time = obj.time;
-      rmc->latitude = obj.latitude;
-      rmc->longitude = obj.longitude;
-      rmc->speed_knt = obj.speed_knt;
-      rmc->course_t = obj.course_t;
-      rmc->mag_var = obj.mag_var;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_rmc (nmea, rmc);
 }
 
 /*!
@@ -1036,22 +1262,9 @@ drv_status_en nmea_read_rmc (nmea_t *nmea, nmea_rmc_t *rmc)
  */
 drv_status_en nmea_read_vtg (nmea_t *nmea, nmea_vtg_t *vtg)
 {
-   nmea_common_t obj;
-
-   obj.speed_knt = -1;                             // mark data
    if (_read_until (nmea, NMEA_VTG) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _VTG, &obj);                   // tokenise
-
-   if (obj.speed_knt != -1) {
-      vtg->course_m = obj.course_m;
-      vtg->course_t = obj.course_t;
-      vtg->speed_knt = obj.speed_knt;
-      vtg->speed_kmh = obj.speed_kmh;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_vtg (nmea, vtg);
 }
 
 /*!
@@ -1066,24 +1279,9 @@ drv_status_en nmea_read_vtg (nmea_t *nmea, nmea_vtg_t *vtg)
  */
 drv_status_en nmea_read_zda (nmea_t *nmea, nmea_zda_t *zda)
 {
-   nmea_common_t obj;
-
-   obj.year = 0;                                   // mark data
    if (_read_until (nmea, NMEA_ZDA) == 0)          // Read next sentences
       return DRV_ERROR;
-   _tokenise (nmea, _ZDA, &obj);                   // tokenise
-
-   if (obj.year != 0) {
-      zda->time = obj.time;
-      zda->day = obj.day;
-      zda->month = obj.month;
-      zda->year = obj.year;
-      zda->zone_h = obj.zone_h;
-      zda->zone_m = obj.zone_m;
-      return DRV_READY;
-   }
-   else
-      return DRV_BUSY;
+   return _extract_zda (nmea, zda);
 }
 
 /*!
@@ -1094,11 +1292,14 @@ drv_status_en nmea_read_zda (nmea_t *nmea, nmea_zda_t *zda)
  * \param   msg   Pointer to message to send
  * \return        The status of the operation
  *    \arg  DRV_READY  Success
+ *    \arg  DRV_ERROR  No output function
  */
 drv_status_en nmea_write (nmea_t *nmea, char *msg)
 {
    char cs[6];
 
+   if (!nmea->io.out)
+      return DRV_ERROR;
    // Create checksum
    sprintf (cs, "*%02X\r\n", _checksum (msg));
 
@@ -1109,3 +1310,111 @@ drv_status_en nmea_write (nmea_t *nmea, char *msg)
 
    return DRV_READY;
 }
+
+/*!
+ * \brief
+ *    Push received data to the parser. The data may hold any number of
+ *    sentences, or parts of them. Each sentence is checked while it
+ *    arrives and, when complete, is extracted to the latest value
+ *    table nmea->data and passed to the sentence callback.
+ *    Does not block and does not use the input function.
+ * \note    Call it from the same context as nmea_get(), not from the rx
+ *          interrupt, as the latest value table has no locking.
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   data  Pointer to received data
+ * \param   n     The number of bytes in data
+ * \return        The number of recognised sentences completed
+ */
+int nmea_push (nmea_t *nmea, const byte_t *data, int n)
+{
+   nmea_push_t *p = &nmea->push;
+   byte_t      ch;
+   int         h, cnt = 0;
+
+   while (n-- > 0) {
+      ch = *data++;
+      if (ch == '$') {
+         // Sentence start, drop any unfinished one
+         if (p->st != NMEA_PS_HUNT)
+            ++p->errors;
+         p->st = NMEA_PS_BODY;
+         p->cs = 0;
+         p->len = 0;
+         nmea->buf[p->len++] = ch;
+         continue;
+      }
+      switch (p->st) {
+         default:
+         case NMEA_PS_HUNT:
+            break;
+         case NMEA_PS_BODY:
+            if (ch < ' ' || ch > '~' || p->len >= nmea->buf_size-1) {
+               // Broken or too long
+               ++p->errors;
+               p->st = NMEA_PS_HUNT;
+               break;
+            }
+            nmea->buf[p->len++] = ch;
+            if (ch == '*') p->st = NMEA_PS_CS_HI;
+            else           p->cs ^= ch;
+            break;
+         case NMEA_PS_CS_HI:
+         case NMEA_PS_CS_LO:
+            if ((h = _hex (ch)) < 0) {
+               ++p->errors;
+               p->st = NMEA_PS_HUNT;
+               break;
+            }
+            if (p->st == NMEA_PS_CS_HI) {
+               p->rcs = h << 4;
+               p->st = NMEA_PS_CS_LO;
+               break;
+            }
+            p->rcs |= h;
+            p->st = NMEA_PS_HUNT;
+            if (p->rcs != p->cs) {
+               ++p->errors;
+               break;
+            }
+            nmea->buf[p->len] = 0;
+            ++p->sentences;
+            cnt += _dispatch (nmea);
+            break;
+      }
+   }
+   return cnt;
+}
+
+/*!
+ * \brief
+ *    Get an entry of the latest value table, if it was written
+ *    since the last nmea_get() for the same sentence.
+ * \param   nmea  Pointer to linked nmea data struct to use
+ * \param   id    The sentence
+ * \param   data  Pointer to the sentence's data type, nmea_gga_t for NMEA_GGA etc.
+ * \return        The status of the operation
+ *    \arg  DRV_ERROR   Unknown sentence
+ *    \arg  DRV_BUSY    No new valid data
+ *    \arg  DRV_READY   Success, data written
+ */
+drv_status_en nmea_get (nmea_t *nmea, nmea_msgid_en id, void *data)
+{
+   void     *src;
+   size_t   sz;
+
+   switch (id) {
+      case NMEA_GGA: src = &nmea->data.gga; sz = sizeof (nmea_gga_t);   break;
+      case NMEA_GLL: src = &nmea->data.gll; sz = sizeof (nmea_gll_t);   break;
+      case NMEA_GSA: src = &nmea->data.gsa; sz = sizeof (nmea_gsa_t);   break;
+      case NMEA_GSV: src = &nmea->data.gsv; sz = sizeof (nmea_gsv_t);   break;
+      case NMEA_RMC: src = &nmea->data.rmc; sz = sizeof (nmea_rmc_t);   break;
+      case NMEA_VTG: src = &nmea->data.vtg; sz = sizeof (nmea_vtg_t);   break;
+      case NMEA_ZDA: src = &nmea->data.zda; sz = sizeof (nmea_zda_t);   break;
+      default:       return DRV_ERROR;
+   }
+   if (!(nmea->data.updated & (1 << id)))
+      return DRV_BUSY;
+   memcpy (data, src, sz);
+   nmea->data.updated &= ~(1 << id);
+   return DRV_READY;
+}
@@ -194,6 +194,263 @@ static size_t _deser_liten64 (void *to, void *from) {
    return 8;
 }
 
+/*
+ * Compiled schema machinery
+ */
+
+#if defined (__GNUC__)
+#define _ser_bswap16(_x)   __builtin_bswap16 (_x)
+#define _ser_bswap32(_x)   __builtin_bswap32 (_x)
+#define _ser_bswap64(_x)   __builtin_bswap64 (_x)
+#else
+#define _ser_bswap16(_x)   ((uint16_t)(((_x) >> 8) | ((_x) << 8)))
+#define _ser_bswap32(_x)   ((uint32_t)(((uint32_t)_ser_bswap16 ((uint16_t)(_x)) << 16) | _ser_bswap16 ((uint16_t)((_x) >> 16))))
+#define _ser_bswap64(_x)   ((uint64_t)(((uint64_t)_ser_bswap32 ((uint32_t)(_x)) << 32) | _ser_bswap32 ((uint32_t)((_x) >> 32))))
+#endif
+
+//! \return The host's endian
+static ser_endian_en _host_endian (void) {
+   const uint16_t one = 1;
+   return (*(const uint8_t*)&one) ? SER_LITTLE_ENDIAN : SER_BIG_ENDIAN;
+}
+
+//! \return The size of a schema type's element
+static size_t _ser_width (int type) {
+   switch (type) {
+      case s_pad:
+      case s_u8:
+      case s_i8:  return 1;
+      case s_u16:
+      case s_i16: return 2;
+      case s_u32:
+      case s_i32:
+      case s_f32: return 4;
+      case s_u64:
+      case s_i64:
+      case s_f64: return 8;
+      case s_uv16:
+      case s_sv16:
+      case s_dv16: return 2;
+      case s_uv32:
+      case s_sv32:
+      case s_dv32: return 4;
+      case s_uv64:
+      case s_sv64:
+      case s_dv64: return 8;
+      default:    return 0;
+   }
+}
+
+/*
+ * Varint machinery
+ */
+#define _SER_VAR_WIDTH     (0x0F)   //!< varint op value mask for the element size
+#define _SER_VAR_ZIGZAG    (0x10)   //!< varint op value flag for zigzag signed elements
+#define _SER_VAR_DELTA     (0x20)   //!< varint op value flag for zigzag differences from the previous record
+
+//! \return The varint op value of a schema type, or 0 for fixed size types
+static uint8_t _ser_var (int type) {
+   switch (type) {
+      case s_uv16: return 2;
+      case s_uv32: return 4;
+      case s_uv64: return 8;
+      case s_sv16: return 2 | _SER_VAR_ZIGZAG;
+      case s_sv32: return 4 | _SER_VAR_ZIGZAG;
+      case s_sv64: return 8 | _SER_VAR_ZIGZAG;
+      case s_dv16: return 2 | _SER_VAR_DELTA;
+      case s_dv32: return 4 | _SER_VAR_DELTA;
+      case s_dv64: return 8 | _SER_VAR_DELTA;
+      default:     return 0;
+   }
+}
+
+//! \return The worst case encoded size of a \p w bytes element
+#define _ser_vsize(_w)     ((8*(_w) + 6) / 7)
+
+//! \return The struct bytes the delta varints of \p plan read, 0 if it has none
+static size_t _ser_delta_end (const ser_plan_t *plan) {
+   const ser_op_t *op = plan->op, *end = plan->op + plan->n;
+   size_t e, max =0;
+
+   for ( ; op < end ; ++op) {
+      if (op->type != ser_op_varint || !(op->value & _SER_VAR_DELTA))
+         continue;
+      e = op->offset + op->len * (op->value & _SER_VAR_WIDTH);
+      if (e > max)
+         max = e;
+   }
+   return max;
+}
+
+//! load an unsigned element of \p w bytes in host's endian
+static uint64_t _ser_load (const uint8_t *p, size_t w) {
+   uint16_t v16;
+   uint32_t v32;
+   uint64_t v64;
+   switch (w) {
+      case 2:  memcpy ((void*)&v16, (const void*)p, 2); return v16;
+      case 4:  memcpy ((void*)&v32, (const void*)p, 4); return v32;
+      default: memcpy ((void*)&v64, (const void*)p, 8); return v64;
+   }
+}
+
+//! store the \p w low bytes of \p v as an element in host's endian
+static void _ser_store (uint8_t *p, size_t w, uint64_t v) {
+   uint16_t v16 = (uint16_t)v;
+   uint32_t v32 = (uint32_t)v;
+   switch (w) {
+      case 2:  memcpy ((void*)p, (const void*)&v16, 2); break;
+      case 4:  memcpy ((void*)p, (const void*)&v32, 4); break;
+      default: memcpy ((void*)p, (const void*)&v, 8);   break;
+   }
+}
+
+/*!
+ * varint encode \p n elements of kind \p var from \p from to \p to.
+ * \p prev points to the previous record's elements for deltas, or 0.
+ * Returns \p to's end
+ */
+static uint8_t* _varint_enc (uint8_t *to, const uint8_t *from, const uint8_t *prev, size_t n, uint8_t var) {
+   size_t w = var & _SER_VAR_WIDTH;
+   unsigned sh = 64 - 8*w;
+   uint64_t u;
+   int64_t s;
+
+   for ( ; n ; --n, from += w) {
+      u = _ser_load (from, w);
+      if (var & _SER_VAR_DELTA && prev) {
+         u -= _ser_load (prev, w);
+         prev += w;
+      }
+      if (var & (_SER_VAR_ZIGZAG | _SER_VAR_DELTA)) {
+         s = (int64_t)(u << sh) >> sh;                // sign extend the element
+         u = ((uint64_t)s << 1) ^ (uint64_t)(s >> 63);
+      }
+      for ( ; u >= 0x80 ; u >>= 7)
+         *to++ = (uint8_t)u | 0x80;
+      *to++ = (uint8_t)u;
+   }
+   return to;
+}
+
+//! store a decoded varint \p u of kind \p var to \p to, adding \p prev's element for deltas
+static void _varint_put (uint8_t *to, const uint8_t *prev, uint64_t u, uint8_t var) {
+   size_t w = var & _SER_VAR_WIDTH;
+
+   if (var & (_SER_VAR_ZIGZAG | _SER_VAR_DELTA))
+      u = (u >> 1) ^ (0 - (u & 1));
+   if (var & _SER_VAR_DELTA && prev)
+      u += _ser_load (prev, w);
+   _ser_store (to, w, u);
+}
+
+/*!
+ * varint decode \p n elements of kind \p var from \p from to \p to.
+ * \p prev points to the previous record's elements for deltas, or 0.
+ * Runs of single byte varints are detected and decoded 8 at a time.
+ * Returns \p from's end
+ */
+static const uint8_t* _varint_dec (uint8_t *to, const uint8_t *from, const uint8_t *prev, size_t n, uint8_t var) {
+   size_t w = var & _SER_VAR_WIDTH;
+   unsigned sh;
+   uint64_t u, c;
+
+   while (n) {
+      if (n >= 8) {
+         // Every element takes at least a byte, so the next 8 bytes are ours
+         memcpy ((void*)&c, (const void*)from, 8);
+         if (!(c & 0x8080808080808080ULL)) {
+            for (int i =0 ; i<8 ; ++i, to += w) {
+               _varint_put (to, prev, from[i], var);
+               if (prev)   prev += w;
+            }
+            from += 8;
+            n -= 8;
+            continue;
+         }
+      }
+      for (u =0, sh =0 ; *from & 0x80 ; sh += 7, ++from)
+         if (sh < 64)   u |= (uint64_t)(*from & 0x7F) << sh;
+      if (sh < 64)      u |= (uint64_t)*from << sh;
+      ++from;
+      _varint_put (to, prev, u, var);
+      to += w;
+      if (prev)   prev += w;
+      --n;
+   }
+   return from;
+}
+
+//! byte swap \p n 16bit elements from \p from to \p to. Works both ways, returns \p to's end
+static uint8_t* _swap16 (uint8_t *to, const uint8_t *from, size_t n) {
+   uint16_t v;
+   for ( ; n ; --n, to += 2, from += 2) {
+      memcpy ((void*)&v, (const void*)from, 2);    // don't trust any memory layout
+      v = _ser_bswap16 (v);
+      memcpy ((void*)to, (const void*)&v, 2);
+   }
+   return to;
+}
+
+//! byte swap \p n 32bit elements from \p from to \p to. Works both ways, returns \p to's end
+static uint8_t* _swap32 (uint8_t *to, const uint8_t *from, size_t n) {
+   uint32_t v;
+   for ( ; n ; --n, to += 4, from += 4) {
+      memcpy ((void*)&v, (const void*)from, 4);
+      v = _ser_bswap32 (v);
+      memcpy ((void*)to, (const void*)&v, 4);
+   }
+   return to;
+}
+
+//! byte swap \p n 64bit elements from \p from to \p to. Works both ways, returns \p to's end
+static uint8_t* _swap64 (uint8_t *to, const uint8_t *from, size_t n) {
+   uint64_t v;
+   for ( ; n ; --n, to += 8, from += 8) {
+      memcpy ((void*)&v, (const void*)from, 8);
+      v = _ser_bswap64 (v);
+      memcpy ((void*)to, (const void*)&v, 8);
+   }
+   return to;
+}
+
+
+//! gather \p n elements of \p w bytes, \p stride bytes apart, to a column. Returns the column's end
+static uint8_t* _ser_gather (uint8_t *to, const uint8_t *from, size_t stride, size_t n, size_t w, int swap) {
+   uint16_t v16;
+   uint32_t v32;
+   uint64_t v64;
+
+   for ( ; n ; --n, from += stride, to += w) {
+      switch (swap ? w : 0) {
+         default:
+         case 0: memcpy ((void*)to, (const void*)from, w); break;
+         case 2: memcpy ((void*)&v16, (const void*)from, 2); v16 = _ser_bswap16 (v16); memcpy ((void*)to, (const void*)&v16, 2); break;
+         case 4: memcpy ((void*)&v32, (const void*)from, 4); v32 = _ser_bswap32 (v32); memcpy ((void*)to, (const void*)&v32, 4); break;
+         case 8: memcpy ((void*)&v64, (const void*)from, 8); v64 = _ser_bswap64 (v64); memcpy ((void*)to, (const void*)&v64, 8); break;
+      }
+   }
+   return to;
+}
+
+//! scatter a column of \p n elements of \p w bytes, to places \p stride bytes apart. Returns the column's end
+static const uint8_t* _ser_scatter (uint8_t *to, const uint8_t *from, size_t stride, size_t n, size_t w, int swap) {
+   uint16_t v16;
+   uint32_t v32;
+   uint64_t v64;
+
+   for ( ; n ; --n, to += stride, from += w) {
+      switch (swap ? w : 0) {
+         default:
+         case 0: memcpy ((void*)to, (const void*)from, w); break;
+         case 2: memcpy ((void*)&v16, (const void*)from, 2); v16 = _ser_bswap16 (v16); memcpy ((void*)to, (const void*)&v16, 2); break;
+         case 4: memcpy ((void*)&v32, (const void*)from, 4); v32 = _ser_bswap32 (v32); memcpy ((void*)to, (const void*)&v32, 4); break;
+         case 8: memcpy ((void*)&v64, (const void*)from, 8); v64 = _ser_bswap64 (v64); memcpy ((void*)to, (const void*)&v64, 8); break;
+      }
+   }
+   return from;
+}
+
 
 /*
  * Public API
@@ -202,7 +459,7 @@ static size_t _deser_liten64 (void *to, void *from) {
 /*!
  * Tool to get the serialized data size without serialization
  * @param schema  The scheme to use
- * @return        The size
+ * @return        The size, the worst case for varint types
  */
 size_t serialize_size (const ser_schema_t* schema) {
    size_t s =0;
@@ -222,6 +479,15 @@ size_t serialize_size (const ser_schema_t* schema) {
             case s_u64:
             case s_i64:
             case s_f64: s += 8;  break;
+            case s_uv16:
+            case s_sv16:
+            case s_dv16:
+            case s_uv32:
+            case s_sv32:
+            case s_dv32:
+            case s_uv64:
+            case s_sv64:
+            case s_dv64: s += _ser_vsize (_ser_width (schema[i].type)); break;
          }
       }
    }
@@ -232,7 +498,8 @@ size_t serialize_size (const ser_schema_t* schema) {
  * Serialize data from a struct to a data stream. This serialize all the instruction
  * defined in \p schema parameter.
  * @note
- *    This algorithm is one pass
+ *    The schema is compiled on stack first \sa ser_compile(). Schemas that
+ *    need more than SER_STACK_OPS instructions are walked in one pass.
  * @param to      Pointer to data stream for output
  * @param from    Pointer to struct for input
  * @param schema  The scheme array to use
@@ -246,6 +513,11 @@ size_t serialize (void* to, void* from, const ser_schema_t* schema, ser_endian_e
    size_t (*ser32) (void*, void*) = (endian == SER_BIG_ENDIAN) ? _ser_bigen32: _ser_liten32;
    size_t (*ser64) (void*, void*) = (endian == SER_BIG_ENDIAN) ? _ser_bigen64: _ser_liten64;
    size_t s =0;
+   ser_op_t ops[SER_STACK_OPS];
+   ser_plan_t plan;
+
+   if (ser_compile (&plan, ops, SER_STACK_OPS, schema, endian) >= 0)
+      return serialize_plan (to, from, &plan);
    for (int i =0 ; schema[i].type != s_none; ++i) {
       for (size_t t =0 ; t<schema[i].times ; ++t) {
          size_t adv =0;
@@ -263,6 +535,19 @@ size_t serialize (void* to, void* from, const ser_schema_t* schema, ser_endian_e
             case s_u64:
             case s_i64:
             case s_f64: adv = ser64 (to+s, from + schema[i].offset + 8*t); break;
+            case s_uv16:
+            case s_sv16:
+            case s_dv16:
+            case s_uv32:
+            case s_sv32:
+            case s_dv32:
+            case s_uv64:
+            case s_sv64:
+            case s_dv64:
+               adv = (size_t)(_varint_enc ((uint8_t*)to+s,
+                        (const uint8_t*)from + schema[i].offset + _ser_width (schema[i].type)*t,
+                        0, 1, _ser_var (schema[i].type)) - ((uint8_t*)to+s));
+               break;
          }
          s += adv;
       }
@@ -274,7 +559,8 @@ size_t serialize (void* to, void* from, const ser_schema_t* schema, ser_endian_e
  * De-serialize data back to struct. This deserialize all the instruction
  * defined in \p schema parameter.
  * @note
- *    This algorithm is one pass
+ *    The schema is compiled on stack first \sa ser_compile(). Schemas that
+ *    need more than SER_STACK_OPS instructions are walked in one pass.
  * @param to      Pointer to struct for output
  * @param from    Pointer to serialized data stream
  * @param schema  Scheme array to use
@@ -288,6 +574,11 @@ size_t deserialize (void* to, void* from, const ser_schema_t* schema, ser_endian
    size_t (*deser32) (void*, void*) = (endian == SER_BIG_ENDIAN) ? _deser_bigen32: _deser_liten32;
    size_t (*deser64) (void*, void*) = (endian == SER_BIG_ENDIAN) ? _deser_bigen64: _deser_liten64;
    size_t s =0;
+   ser_op_t ops[SER_STACK_OPS];
+   ser_plan_t plan;
+
+   if (ser_compile (&plan, ops, SER_STACK_OPS, schema, endian) >= 0)
+      return deserialize_plan (to, from, &plan);
    for (int i =0 ; schema[i].type != s_none; ++i) {
       for (size_t t =0 ; t<schema[i].times ; ++t) {
          size_t adv =0;
@@ -305,9 +596,373 @@ size_t deserialize (void* to, void* from, const ser_schema_t* schema, ser_endian
             case s_u64:
             case s_i64:
             case s_f64: adv = deser64 (to + schema[i].offset + 8*t, from+s); break;
+            case s_uv16:
+            case s_sv16:
+            case s_dv16:
+            case s_uv32:
+            case s_sv32:
+            case s_dv32:
+            case s_uv64:
+            case s_sv64:
+            case s_dv64:
+               adv = (size_t)(_varint_dec ((uint8_t*)to + schema[i].offset + _ser_width (schema[i].type)*t,
+                        (const uint8_t*)from+s, 0, 1, _ser_var (schema[i].type)) - ((const uint8_t*)from+s));
+               break;
          }
          s += adv;
       }
    }
    return s;
 }
+
+/*!
+ * Compile a schema to a flat instruction list for the given endian.
+ * Schema entries that are adjacent in the struct and need the same handling
+ * are merged. Single bytes and multi-byte elements of the host's endian
+ * become memory copies, varint types varint runs, and the rest byte swaps.
+ * @param plan    Pointer to the plan to compile
+ * @param ops     Pointer to the plan's instruction storage
+ * @param size    The size of instruction storage
+ * @param schema  The scheme array to use
+ * @param endian  The endian to use
+ * @return        The number of instructions, or -1 if they do not fit in \p ops
+ */
+int ser_compile (ser_plan_t* plan, ser_op_t* ops, size_t size, const ser_schema_t* schema, ser_endian_en endian) {
+   int swap = (endian != _host_endian ());
+   size_t n =0, bytes =0, w;
+   uint8_t var;
+   ser_op_t op, *last;
+
+   for (int i =0 ; schema[i].type != s_none; ++i) {
+      if (!(w = _ser_width (schema[i].type)) || !schema[i].times)
+         continue;
+      op.value = 0;
+      op.offset = schema[i].offset;
+      if (schema[i].type == s_pad) {
+         op.type = ser_op_pad;
+         op.value = (uint8_t)schema[i].offset;
+         op.offset = 0;
+         op.len = schema[i].times;
+         bytes += op.len;
+      }
+      else if ((var = _ser_var (schema[i].type))) {
+         op.type = ser_op_varint;
+         op.value = var;
+         op.len = schema[i].times;
+         bytes += _ser_vsize (w) * op.len;
+      }
+      else if (w == 1 || !swap) {
+         op.type = ser_op_copy;
+         op.len = w * schema[i].times;
+         bytes += op.len;
+      }
+      else {
+         op.type = (w == 2) ? ser_op_swap16 : (w == 4) ? ser_op_swap32 : ser_op_swap64;
+         op.len = schema[i].times;
+         bytes += w * op.len;
+      }
+
+      // Try to merge with the previous instruction
+      last = (n) ? &ops[n-1] : 0;
+      if (last && last->type == op.type) {
+         if (op.type == ser_op_pad && last->value == op.value) {
+            last->len += op.len;
+            continue;
+         }
+         if (op.type == ser_op_copy && last->offset + last->len == op.offset) {
+            last->len += op.len;
+            continue;
+         }
+         if (op.type != ser_op_pad && op.type != ser_op_copy && last->value == op.value
+             && last->offset + last->len*w == op.offset) {
+            last->len += op.len;
+            continue;
+         }
+      }
+      if (n >= size)
+         return -1;
+      ops[n++] = op;
+   }
+   plan->op = ops;
+   plan->n = n;
+   plan->size = bytes;
+   plan->endian = endian;
+   return (int)n;
+}
+
+/*!
+ * Serialize data from a struct to a data stream using a compiled schema.
+ * Delta varints are encoded against zero \sa serialize_delta().
+ * @param to      Pointer to data stream for output
+ * @param from    Pointer to struct for input
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of serialized bytes
+ */
+size_t serialize_plan (void* to, const void* from, const ser_plan_t* plan) {
+   return serialize_delta (to, from, 0, plan);
+}
+
+/*!
+ * De-serialize data back to struct using a compiled schema.
+ * Delta varints are decoded against zero \sa deserialize_delta().
+ * @param to      Pointer to struct for output
+ * @param from    Pointer to serialized data stream
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of read bytes
+ */
+size_t deserialize_plan (void* to, const void* from, const ser_plan_t* plan) {
+   return deserialize_delta (to, from, 0, plan);
+}
+
+/*!
+ * Serialize data from a struct to a data stream using a compiled schema,
+ * encoding the delta varint members as differences from a previous record.
+ * @param to      Pointer to data stream for output
+ * @param from    Pointer to struct for input
+ * @param prev    Pointer to the previous struct, or NULL to encode against zero
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of serialized bytes
+ */
+size_t serialize_delta (void* to, const void* from, const void* prev, const ser_plan_t* plan) {
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+   const uint8_t *p = (const uint8_t*)prev;
+   const ser_op_t *op = plan->op, *end = plan->op + plan->n;
+
+   for ( ; op < end ; ++op) {
+      switch (op->type) {
+         case ser_op_copy:
+            memcpy ((void*)t, (const void*)(f + op->offset), op->len);
+            t += op->len;
+            break;
+         case ser_op_pad:
+            memset ((void*)t, op->value, op->len);
+            t += op->len;
+            break;
+         case ser_op_swap16: t = _swap16 (t, f + op->offset, op->len); break;
+         case ser_op_swap32: t = _swap32 (t, f + op->offset, op->len); break;
+         case ser_op_swap64: t = _swap64 (t, f + op->offset, op->len); break;
+         case ser_op_varint:
+            t = _varint_enc (t, f + op->offset, (p) ? p + op->offset : 0, op->len, op->value);
+            break;
+         default: break;
+      }
+   }
+   return (size_t)(t - (uint8_t*)to);
+}
+
+/*!
+ * De-serialize data back to struct using a compiled schema, decoding the
+ * delta varint members as differences from a previous record.
+ * @param to      Pointer to struct for output
+ * @param from    Pointer to serialized data stream
+ * @param prev    Pointer to the previous decoded struct, or NULL to decode against zero.
+ *                It can not be the same as \p to.
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of read bytes
+ */
+size_t deserialize_delta (void* to, const void* from, const void* prev, const ser_plan_t* plan) {
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+   const uint8_t *p = (const uint8_t*)prev;
+   const ser_op_t *op = plan->op, *end = plan->op + plan->n;
+
+   for ( ; op < end ; ++op) {
+      switch (op->type) {
+         case ser_op_copy:
+            memcpy ((void*)(t + op->offset), (const void*)f, op->len);
+            f += op->len;
+            break;
+         case ser_op_pad:
+            f += op->len;
+            break;
+         case ser_op_swap16: _swap16 (t + op->offset, f, op->len); f += 2*op->len; break;
+         case ser_op_swap32: _swap32 (t + op->offset, f, op->len); f += 4*op->len; break;
+         case ser_op_swap64: _swap64 (t + op->offset, f, op->len); f += 8*op->len; break;
+         case ser_op_varint:
+            f = _varint_dec (t + op->offset, f, (p) ? p + op->offset : 0, op->len, op->value);
+            break;
+         default: break;
+      }
+   }
+   return (size_t)(f - (const uint8_t*)from);
+}
+
+/*!
+ * Serialize an array of structs to a contiguous data stream using a compiled
+ * schema. The records follow each other in the stream and delta varints
+ * are encoded against the previous struct, the first one against zero.
+ * @param to      Pointer to data stream for output
+ * @param from    Pointer to the first struct
+ * @param stride  The distance of the structs in bytes, usually sizeof the struct
+ * @param n       The number of structs
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of serialized bytes
+ */
+size_t serialize_batch (void* to, const void* from, size_t stride, size_t n, const ser_plan_t* plan) {
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+
+   const uint8_t *p = 0;
+
+   for ( ; n ; --n, p = f, f += stride)
+      t += serialize_delta ((void*)t, (const void*)f, (const void*)p, plan);
+   return (size_t)(t - (uint8_t*)to);
+}
+
+/*!
+ * De-serialize a contiguous data stream of records back to an array of structs
+ * using a compiled schema \sa serialize_batch().
+ * @param to      Pointer to the first struct
+ * @param from    Pointer to serialized data stream
+ * @param stride  The distance of the structs in bytes, usually sizeof the struct
+ * @param n       The number of structs
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of read bytes
+ */
+size_t deserialize_batch (void* to, const void* from, size_t stride, size_t n, const ser_plan_t* plan) {
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+
+   const uint8_t *p = 0;
+
+   for ( ; n ; --n, p = t, t += stride)
+      f += deserialize_delta ((void*)t, (const void*)f, (const void*)p, plan);
+   return (size_t)(f - (const uint8_t*)from);
+}
+
+/*!
+ * Initialize a serializer sink. This also starts a new delta chain.
+ * @param sk      Pointer to sink
+ * @param write   The back-end's write function
+ * @param ctx     The back-end's context, passed to write
+ * @param buf     Pointer to chunk buffer
+ * @param size    The chunk buffer's size
+ * @param prev    Pointer to a record sized buffer for the last record, or NULL
+ *                if the plans have no delta varints
+ * @param rec     The size of prev, usually sizeof the struct
+ */
+void ser_sink_init (ser_sink_t* sk, ser_write_ft write, void* ctx, void* buf, size_t size, void* prev, size_t rec) {
+   sk->write = write;
+   sk->ctx = ctx;
+   sk->buf = (uint8_t*)buf;
+   sk->size = size;
+   sk->len = sk->count = 0;
+   sk->prev = (uint8_t*)prev;
+   sk->rec = (prev) ? rec : 0;
+}
+
+/*!
+ * Hand the sink's buffered data to its back-end. Data the back-end did not
+ * take stay in the buffer, so a later flush retries them.
+ * @param sk      Pointer to sink
+ * @return        The back-end's return value, or 0 if there was nothing to flush
+ */
+int ser_sink_flush (ser_sink_t* sk) {
+   int ret =0;
+
+   if (sk->write && sk->len) {
+      ret = sk->write (sk->ctx, (const void*)sk->buf, sk->len);
+      if (ret >= (int)sk->len)
+         sk->len = 0;
+      else if (ret > 0) {
+         memmove ((void*)sk->buf, (const void*)(sk->buf + ret), sk->len - ret);
+         sk->len -= ret;
+      }
+   }
+   return ret;
+}
+
+/*!
+ * Serialize an array of structs to a sink using a compiled schema. Each
+ * record is encoded in place in the sink's buffer and the buffer is flushed
+ * when the next record does not fit. The sink is not flushed at the end.
+ * Delta varints are encoded against the previous record pushed to the sink,
+ * also across calls, and the first one since ser_sink_init() against zero.
+ * @param sk      Pointer to sink \sa ser_sink_init()
+ * @param from    Pointer to the first struct
+ * @param stride  The distance of the structs in bytes, usually sizeof the struct
+ * @param n       The number of structs
+ * @param plan    The compiled schema \sa ser_compile()
+ * @return        The number of serialized records. Less than \p n if a
+ *                record is bigger than the sink's buffer, or if a flush
+ *                fails and leaves no room for the next record. The rest
+ *                continue the chain in a later call. 0 if the plan has delta
+ *                varints beyond the sink's record buffer.
+ */
+size_t serialize_sink (ser_sink_t* sk, const void* from, size_t stride, size_t n, const ser_plan_t* plan) {
+   const uint8_t *f = (const uint8_t*)from;
+   const uint8_t *p = (sk->count) ? sk->prev : 0;
+   size_t i, s, d = _ser_delta_end (plan);
+
+   if (plan->size > sk->size || d > sk->rec)
+      return 0;
+   for (i =0 ; i<n ; ++i, p = f, f += stride) {
+      if (sk->size - sk->len < plan->size) {
+         ser_sink_flush (sk);
+         if (sk->size - sk->len < plan->size)
+            break;   // The back-end failed
+      }
+      s = serialize_delta ((void*)(sk->buf + sk->len), (const void*)f, (const void*)p, plan);
+      sk->len += s;
+      sk->count += s;
+   }
+   // Keep the last record for the next call
+   if (i && d)
+      memcpy ((void*)sk->prev, (const void*)((const uint8_t*)from + (i-1)*stride), d);
+   return i;
+}
+
+/*!
+ * Serialize an array of structs to a struct of arrays data stream. Each
+ * element of the schema becomes a column with its values from all the
+ * structs, in the order of the schema. Array members give a column per
+ * element and pads are omitted. Varint types are written in fixed size.
+ * @param to      Pointer to data stream for output
+ * @param from    Pointer to the first struct
+ * @param stride  The distance of the structs in bytes, usually sizeof the struct
+ * @param n       The number of structs
+ * @param schema  The scheme array to use
+ * @param endian  The endian to use
+ * @return        The number of serialized bytes
+ */
+size_t serialize_soa (void* to, const void* from, size_t stride, size_t n, const ser_schema_t* schema, ser_endian_en endian) {
+   int swap = (endian != _host_endian ());
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+   size_t w;
+
+   for (int i =0 ; schema[i].type != s_none; ++i) {
+      if (schema[i].type == s_pad || !(w = _ser_width (schema[i].type)))
+         continue;
+      for (size_t e =0 ; e<schema[i].times ; ++e)
+         t = _ser_gather (t, f + schema[i].offset + w*e, stride, n, w, swap);
+   }
+   return (size_t)(t - (uint8_t*)to);
+}
+
+/*!
+ * De-serialize a struct of arrays data stream back to an array of structs
+ * \sa serialize_soa().
+ * @param to      Pointer to the first struct
+ * @param from    Pointer to serialized data stream
+ * @param stride  The distance of the structs in bytes, usually sizeof the struct
+ * @param n       The number of structs
+ * @param schema  The scheme array to use
+ * @param endian  The endian to use
+ * @return        The number of read bytes
+ */
+size_t deserialize_soa (void* to, const void* from, size_t stride, size_t n, const ser_schema_t* schema, ser_endian_en endian) {
+   int swap = (endian != _host_endian ());
+   uint8_t *t = (uint8_t*)to;
+   const uint8_t *f = (const uint8_t*)from;
+   size_t w;
+
+   for (int i =0 ; schema[i].type != s_none; ++i) {
+      if (schema[i].type == s_pad || !(w = _ser_width (schema[i].type)))
+         continue;
+      for (size_t e =0 ; e<schema[i].times ; ++e)
+         f = _ser_scatter (t + schema[i].offset + w*e, f, stride, n, w, swap);
+   }
+   return (size_t)(f - (const uint8_t*)from);
+}
@@ -19,6 +19,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#if defined (__linux__)
+#include <unistd.h>
+#endif
 #include <cont/deque08.h>
 
 
@@ -84,6 +87,52 @@ static bool _check_valueTrigger (deque08_t *q, byte_t b) {
    }
 }
 
+/*!
+ * \brief
+ *    Evaluate the edge triggered events after a push/pop.
+ * \param   q        Pointer to deque
+ * \param   prev     The item count before the operation
+ * \param   delims   The number of delimiters pushed by the operation
+ */
+__O3__ static void _check_events (deque08_t *q, iterator_t prev, iterator_t delims) {
+   uint8_t ev = 0;
+
+   if (!q->ev.en)
+      return;
+   if ((q->ev.en & DEQUE08_EV_HIGH) && prev < q->ev.high && q->items >= q->ev.high)
+      ev |= DEQUE08_EV_HIGH;
+   if ((q->ev.en & DEQUE08_EV_LOW) && prev > q->ev.low && q->items <= q->ev.low)
+      ev |= DEQUE08_EV_LOW;
+   if (delims)
+      ev |= DEQUE08_EV_DELIM;
+   if (ev) {
+      q->ev.pending |= ev;
+      if (q->ev.notify)
+         q->ev.notify (q->ev.ctx, ev);
+   }
+}
+
+/*!
+ * \brief
+ *    Count the occurrences of \a c in \a n bytes of \a b, using memchr().
+ */
+__O3__ static iterator_t _count (const byte_t *b, size_t n, byte_t c) {
+   const byte_t *e = b + n;
+   iterator_t cnt = 0;
+
+   while (b < e && (b = (const byte_t*)memchr ((const void*)b, c, (size_t)(e - b))) != NULL) {
+      ++cnt;
+      ++b;
+   }
+   return cnt;
+}
+
+/*!
+ * \brief
+ *    Track delimiters for single byte push/pop.
+ */
+#define _is_delim(_q, _b)     ( ((_q)->ev.en & DEQUE08_EV_DELIM) && (_b) == (_q)->ev.delim )
+
 
 /*
  *  ============= Public Queue API =============
@@ -124,6 +173,68 @@ __O3__ void deque08_clear_trigger (deque08_t *q) {
    q->trigger = t;
 }
 
+/*!
+ * \brief
+ *    Set the notification function for the edge triggered events.
+ * \note
+ *    The notification is called from the push/pop context, (usually an ISR)
+ *    so it should only wake the consumer. For example post a semaphore or
+ *    on linux use \sa deque08_eventfd_notify().
+ * \param   q        Pointer to deque
+ * \param   notify   Pointer to notification function (null for none)
+ * \param   ctx      User's context, passed to notify
+ */
+void deque08_set_notify (deque08_t *q, deque_notify_ft notify, void* ctx) {
+   q->ev.notify = notify;
+   q->ev.ctx = ctx;
+}
+
+/*!
+ * \brief
+ *    Set the watermarks for the edge triggered events. DEQUE08_EV_HIGH fires
+ *    each time the size crosses up to \a high and DEQUE08_EV_LOW each time
+ *    it crosses down to \a low.
+ * \param   q        Pointer to deque
+ * \param   low      The low watermark, negative to disable
+ * \param   high     The high watermark, negative to disable
+ */
+void deque08_set_watermarks (deque08_t *q, int low, int high)
+{
+   q->ev.en &= ~(DEQUE08_EV_HIGH | DEQUE08_EV_LOW);
+   if (low >= 0) {
+      q->ev.low = low;
+      q->ev.en |= DEQUE08_EV_LOW;
+   }
+   if (high >= 0) {
+      q->ev.high = high;
+      q->ev.en |= DEQUE08_EV_HIGH;
+   }
+}
+
+/*!
+ * \brief
+ *    Set the delimiter for the edge triggered events. DEQUE08_EV_DELIM fires
+ *    each time the delimiter is pushed and the deque keeps count of the
+ *    delimiters in it \sa deque08_delimiters().
+ * \param   q        Pointer to deque
+ * \param   delim    The delimiter byte, negative to disable
+ */
+void deque08_set_delimiter (deque08_t *q, int delim)
+{
+   iterator_t i, it;
+
+   q->ev.en &= ~DEQUE08_EV_DELIM;
+   q->ev.ndelim = 0;
+   if (delim < 0)
+      return;
+   q->ev.delim = (byte_t)delim;
+   // Count the delimiters already in deque
+   for (i=0, it=q->f ; i<q->items ; ++i)
+      if (q->m[_postInc (q, &it)] == q->ev.delim)
+         ++q->ev.ndelim;
+   q->ev.en |= DEQUE08_EV_DELIM;
+}
+
 /*
  * User Functions
  */
@@ -182,6 +293,7 @@ __Os__ void deque08_init (deque08_t *q) {
    q->f = 0;
    q->r = -1;
    q->items =0;
+   q->ev.ndelim =0;
 }
 
 /*!
@@ -200,6 +312,8 @@ int deque08_push_front (deque08_t *q, byte_t b) {
    ++q->items;
    _check_valueTrigger(q, b);
    _check_sizeTrigger(q);
+   if (_is_delim (q, b))   ++q->ev.ndelim;
+   _check_events (q, q->items-1, _is_delim (q, b));
    return 1;
 }
 
@@ -218,6 +332,8 @@ int deque08_pop_front (deque08_t *q, byte_t *b) {
    *b = q->m [_postInc (q, &q->f)];
    --q->items;
    _check_sizeTrigger(q);
+   if (_is_delim (q, *b))  --q->ev.ndelim;
+   _check_events (q, q->items+1, 0);
    return 1;
 }
 
@@ -237,6 +353,8 @@ int deque08_push_back (deque08_t *q, byte_t b) {
    ++q->items;
    _check_valueTrigger(q, b);
    _check_sizeTrigger(q);
+   if (_is_delim (q, b))   ++q->ev.ndelim;
+   _check_events (q, q->items-1, _is_delim (q, b));
    return 1;
 }
 
@@ -255,6 +373,8 @@ int deque08_pop_back (deque08_t *q, byte_t *b) {
    *b = q->m [_postDec (q, &q->r)];
    --q->items;
    _check_sizeTrigger(q);
+   if (_is_delim (q, *b))  --q->ev.ndelim;
+   _check_events (q, q->items+1, 0);
    return 1;
 }
 
@@ -272,9 +392,8 @@ int deque08_vpush_front (deque08_t *q, size_t num, ...) {
    int ret;
 
    va_start(args, num);
-   do
+   for (ret =1 ; ret && num ; --num)
       ret = deque08_push_front(q, (byte_t)va_arg(args, int32_t));
-   while (ret);
    va_end(args);
 
    return ret;
@@ -294,9 +413,8 @@ int deque08_vpush_back (deque08_t *q, size_t num, ...) {
    int ret;
 
    va_start(args, num);
-   do
+   for (ret =1 ; ret && num ; --num)
       ret = deque08_push_back(q, (byte_t)va_arg(args, int32_t));
-   while (ret);
    va_end(args);
 
    return ret;
@@ -337,3 +455,149 @@ int deque08_front (deque08_t *q, byte_t *b) {
 bool deque08_check_trigger (deque08_t *q) {
    return _check_sizeTrigger(q);
 }
+
+/*!
+  * \brief
+  *   This function push a block of bytes in the back of deque, using at most
+  *   two memcpy(). Delimiters are found with memchr().
+  * \param  q  Pointer to deque to use
+  * \param  b  Pointer to bytes to push
+  * \param  n  The number of bytes
+  * \return    The number of bytes pushed (less than n if the deque fills)
+ */
+__O3__ size_t deque08_push_back_blk (deque08_t *q, const byte_t *b, size_t n)
+{
+   iterator_t prev = q->items, delims = 0, pos;
+   size_t n1;
+
+   if (n > (size_t)(q->capacity - q->items))
+      n = (size_t)(q->capacity - q->items);
+   if (!n)
+      return 0;
+
+   pos = q->r + 1;
+   if (pos >= q->capacity)    pos = 0;
+   n1 = (size_t)(q->capacity - pos);
+   if (n1 > n)                n1 = n;
+   memcpy ((void*)&q->m[pos], (const void*)b, n1);
+   memcpy ((void*)q->m, (const void*)&b[n1], n - n1);
+   q->r = (n1 < n) ? (iterator_t)(n - n1) - 1 : pos + (iterator_t)n1 - 1;
+   q->items += (iterator_t)n;
+
+   if (q->trigger.mode == EVERY_VALUE) {
+      for (iterator_t c = _count (b, n, q->trigger.value.content) ; c ; --c)
+         q->trigger.callback();
+   }
+   _check_sizeTrigger(q);
+   if (q->ev.en & DEQUE08_EV_DELIM)
+      q->ev.ndelim += delims = _count (b, n, q->ev.delim);
+   _check_events (q, prev, delims);
+   return n;
+}
+
+/*!
+  * \brief
+  *   This function pops a block of bytes from the front of the deque, using
+  *   at most two memcpy().
+  * \param  q  Pointer to deque to use
+  * \param  b  Pointer to buffer for the bytes
+  * \param  n  The maximum number of bytes
+  * \return    The number of bytes popped
+ */
+__O3__ size_t deque08_pop_front_blk (deque08_t *q, byte_t *b, size_t n)
+{
+   iterator_t prev = q->items;
+   size_t n1;
+
+   if (n > (size_t)q->items)
+      n = (size_t)q->items;
+   if (!n)
+      return 0;
+
+   n1 = (size_t)(q->capacity - q->f);
+   if (n1 > n)    n1 = n;
+   memcpy ((void*)b, (const void*)&q->m[q->f], n1);
+   memcpy ((void*)&b[n1], (const void*)q->m, n - n1);
+   q->f = (n1 < n) ? (iterator_t)(n - n1) : q->f + (iterator_t)n1;
+   if (q->f >= q->capacity)   q->f = 0;
+   q->items -= (iterator_t)n;
+
+   _check_sizeTrigger(q);
+   if (q->ev.en & DEQUE08_EV_DELIM)
+      q->ev.ndelim -= _count (b, n, q->ev.delim);
+   _check_events (q, prev, 0);
+   return n;
+}
+
+/*!
+  * \brief
+  *   This function pops a frame, that is all the bytes up to and including
+  *   the first delimiter \sa deque08_set_delimiter().
+  * \param  q  Pointer to deque to use
+  * \param  b  Pointer to buffer for the frame
+  * \param  n  The buffer's size
+  * \return
+  *   \arg  0  There is no complete frame, or it does not fit in buffer
+  *   \arg  >0 The frame's size
+ */
+size_t deque08_pop_frame (deque08_t *q, byte_t *b, size_t n)
+{
+   const byte_t *d;
+   size_t n1, len;
+
+   if (!(q->ev.en & DEQUE08_EV_DELIM) || !q->ev.ndelim)
+      return 0;
+
+   n1 = (size_t)(q->capacity - q->f);
+   if (n1 > (size_t)q->items)    n1 = (size_t)q->items;
+   if ((d = (const byte_t*)memchr ((const void*)&q->m[q->f], q->ev.delim, n1)) != NULL)
+      len = (size_t)(d - &q->m[q->f]) + 1;
+   else if ((d = (const byte_t*)memchr ((const void*)q->m, q->ev.delim, (size_t)q->items - n1)) != NULL)
+      len = n1 + (size_t)(d - q->m) + 1;
+   else
+      return 0;
+
+   return (len <= n) ? deque08_pop_front_blk (q, b, len) : 0;
+}
+
+/*!
+ * \brief
+ *    Return and clear the pending edge triggered events.
+ * \note    Not atomic. Call it from the deque's push/pop context, as
+ *          an event set from another context could be lost.
+ * \param   q     Pointer to deque
+ * \return  The events mask (DEQUE08_EV_xxx)
+ */
+uint8_t deque08_events (deque08_t *q) {
+   uint8_t ev = q->ev.pending;
+   q->ev.pending &= ~ev;
+   return ev;
+}
+
+/*!
+ * \brief
+ *    Return the number of delimiters in deque, that is the number of
+ *    complete frames.
+ */
+inline int deque08_delimiters (deque08_t *q) {
+   return q->ev.ndelim;
+}
+
+#if defined (__linux__)
+/*!
+ * \brief
+ *    Notification function for linux targets, that signals an eventfd.
+ *    Use it as:
+ *    \code
+ *       deque08_set_notify (&q, deque08_eventfd_notify, (void*)(intptr_t)eventfd (0, 0));
+ *    \endcode
+ *    so the consumer can sleep in poll()/read() on that descriptor.
+ */
+void deque08_eventfd_notify (void* ctx, uint32_t events)
+{
+   uint64_t v = 1;
+   tbx_unused (events);
+   if (write ((int)(intptr_t)ctx, &v, sizeof (v)) < 0)
+      return;
+}
+#endif
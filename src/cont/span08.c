@@ -21,15 +21,63 @@
  */
 #include <cont/span08.h>
 
+/*
+ *  ============= Private Span API =============
+ */
+
+/*!
+ * \brief
+ *    Make sure the span has room for \a need bytes, growing owned spans
+ *    geometrically.
+ * \return
+ *    \arg  0  No room and can not grow
+ *    \arg  1  Done
+ */
+static int _grow (span08_t* span, size_t need)
+{
+   size_t cap;
+   byte_t *d;
 
+   if (!span->cap || need <= span->cap)
+      return 1;   // Unknown capacity (unchecked) or enough room
+   if (!span->own || need > ((size_t)-1 >> 1))
+      return 0;   // Fixed capacity failure mode
 
+   for (cap = span->cap ; cap < need ; cap <<= 1)
+      ;
+   if ((d = (byte_t*)alc_calloc (span->alc, cap, 1)) == NULL)
+      return 0;
+   memcpy ((void*)d, (const void*)span->data, span->size);
+   alc_free (span->alc, (void*)span->data);
+   span->data = d;
+   span->cap = cap;
+   return 1;
+}
+
+
+/*
+ *  ============= Public Span API =============
+ */
 
+/*!
+ * \brief
+ *    Make an empty span of unknown capacity on top of \a data.
+ */
 span08_t span08_init(byte_t* data) {
-   return (span08_t){0,data};
+   return (span08_t){0, data, 0, 0, false};
+}
+
+/*!
+ * \brief
+ *    Make an empty fixed capacity span on top of \a data. Operations that
+ *    do not fit in \a cap bytes fail, leaving the span untouched.
+ */
+span08_t span08_init_cap (byte_t* data, size_t cap) {
+   return (span08_t){0, data, cap, 0, false};
 }
 
 span08_t span08_mk(byte_t* data, size_t num, ...) {
-   span08_t s = {0, data};
+   span08_t s = {0, data, 0, 0, false};
 
    va_list args;
    va_start(args, num);
@@ -41,12 +89,16 @@ span08_t span08_mk(byte_t* data, size_t num, ...) {
 }
 
 span08_t span08_add (span08_t* span, byte_t it) {
-   span->data[span->size++] = it;
+   if (_grow (span, span->size + 1))
+      span->data[span->size++] = it;
    return *span;
 }
 
 span08_t span08_set (span08_t* span, size_t num, ...) {
    va_list args;
+
+   if (!_grow (span, num))
+      return *span;
    va_start(args, num);
    for (span->size =0 ; span->size < num ; ++span->size) {
       span->data[span->size] = (byte_t)va_arg(args, int32_t);
@@ -55,15 +107,170 @@ span08_t span08_set (span08_t* span, size_t num, ...) {
    return *span;
 }
 
+/*!
+ * \brief
+ *    Copy the bytes of the span to \a data. The copy is clipped to the
+ *    bytes in span, which never exceed its capacity.
+ */
 span08_t span08_cpy (span08_t* span, byte_t* data, size_t num) {
+   if (num > span->size)
+      num = span->size;
    memcpy((void*)data, (const void*)span->data, num);
    return *span;
 }
 
 span08_t span08_cat (span08_t* span, span08_t src) {
-   for (size_t i=0 ; i<src.size ; ++i)
-      span08_add(span, src.data[i]);
+   span08_append (span, src.data, src.size);
    return *span;
 }
 
 byte_t* span08_get (span08_t* span) { return span->data; }
+
+/*!
+ * \brief
+ *    Make an empty span that owns its data and grows on demand.
+ * \param   span  Pointer to span
+ * \param   cap   The initial capacity. Reserving the steady state size here
+ *                avoids any re-allocation later.
+ * \param   alc   Pointer to allocator, or null for the default
+ * \return
+ *    \arg  0  Allocation failure
+ *    \arg  1  Done
+ */
+int span08_alloc (span08_t* span, size_t cap, const alc_t *alc)
+{
+   if (cap < SPAN08_MIN_GROW)
+      cap = SPAN08_MIN_GROW;
+   *span = (span08_t){0, 0, 0, alc, false};
+   if ((span->data = (byte_t*)alc_calloc (alc, cap, 1)) == NULL)
+      return 0;
+   span->cap = cap;
+   span->own = true;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Release the data of an owning span. Has no effect on the data of
+ *    non-owning spans, they are just cleared.
+ */
+void span08_free (span08_t* span)
+{
+   if (span->own)
+      alc_free (span->alc, (void*)span->data);
+   *span = (span08_t){0, 0, 0, 0, false};
+}
+
+/*!
+ * \brief
+ *    Make sure the span has capacity for at least \a cap bytes.
+ * \return
+ *    \arg  0  No room and can not grow
+ *    \arg  1  Done
+ */
+int span08_reserve (span08_t* span, size_t cap) {
+   return _grow (span, cap);
+}
+
+/*!
+ * \brief
+ *    Discard the span's content, keeping its capacity.
+ */
+inline void span08_clear (span08_t* span) {
+   span->size = 0;
+}
+
+/*!
+ * \brief
+ *    Return the free room of a span without growing. For spans of
+ *    unknown capacity returns SIZE_MAX.
+ */
+size_t span08_room (span08_t* span) {
+   return (span->cap) ? span->cap - span->size : (size_t)-1;
+}
+
+/*!
+ * \brief
+ *    Replace the span's content with \a num bytes from \a src.
+ * \return
+ *    \arg  0  No room and can not grow
+ *    \arg  1  Done
+ */
+int span08_assign (span08_t* span, const byte_t* src, size_t num)
+{
+   if (!_grow (span, num))
+      return 0;
+   memmove ((void*)span->data, (const void*)src, num);
+   span->size = num;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Append \a num bytes from \a src to the span.
+ * \return
+ *    \arg  0  No room and can not grow
+ *    \arg  1  Done
+ */
+__O3__ int span08_append (span08_t* span, const byte_t* src, size_t num)
+{
+   if (!_grow (span, span->size + num))
+      return 0;
+   memcpy ((void*)&span->data[span->size], (const void*)src, num);
+   span->size += num;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Insert \a num bytes from \a src in span's position \a pos.
+ * \note
+ *    \a src must not point inside the span's data.
+ * \return
+ *    \arg  0  Position out of span, or no room and can not grow
+ *    \arg  1  Done
+ */
+int span08_insert (span08_t* span, size_t pos, const byte_t* src, size_t num)
+{
+   if (pos > span->size || !_grow (span, span->size + num))
+      return 0;
+   memmove ((void*)&span->data[pos + num], (const void*)&span->data[pos], span->size - pos);
+   memcpy ((void*)&span->data[pos], (const void*)src, num);
+   span->size += num;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Remove \a num bytes from span's position \a pos. The range is
+ *    clipped to the span's size.
+ * \return
+ *    \arg  0  Position out of span
+ *    \arg  1  Done
+ */
+int span08_erase (span08_t* span, size_t pos, size_t num)
+{
+   if (pos > span->size)
+      return 0;
+   if (num > span->size - pos)
+      num = span->size - pos;
+   memmove ((void*)&span->data[pos], (const void*)&span->data[pos + num], span->size - pos - num);
+   span->size -= num;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Return a non-owning, fixed capacity view to \a num bytes of the span,
+ *    starting at \a pos. No data is copied. The range is clipped to the
+ *    span's size.
+ * \note
+ *    The view is invalidated if the span grows.
+ */
+span08_t span08_slice (span08_t* span, size_t pos, size_t num)
+{
+   if (pos > span->size)   pos = span->size;
+   if (num > span->size - pos)
+      num = span->size - pos;
+   return (span08_t){num, &span->data[pos], num, 0, false};
+}
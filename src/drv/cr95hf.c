@@ -214,7 +214,7 @@ uint8_t cr95hf_nbControlBytes (uint8_t Protocol) {
  *    The response status is DRV_READY on a successful transaction or DRV_ERROR on any other situation.
  */
 cr95hf_resp_t cr95hf_receive (cr95hf_t *cr95hf, uint8_t command) {
-   cr95hf_resp_t resp = { DRV_ERROR, 0x00, {0x00, cr95hf->rx_buffer} };
+   cr95hf_resp_t resp = { DRV_ERROR, 0x00, {.size = 0x00, .data = cr95hf->rx_buffer} };
    uint8_t len;
 
    // Receive response frame (blocking mode)
@@ -252,7 +252,7 @@ cr95hf_resp_t cr95hf_receive (cr95hf_t *cr95hf, uint8_t command) {
  * \return           The CR95HF response using value semantics \see cr95hf_resp_t
  */
 cr95hf_resp_t cr95hf_echo (cr95hf_t *cr95hf) {
-   transmit (cr95hf, ECHO, (span08_t){0, 0});
+   transmit (cr95hf, ECHO, (span08_t){.size = 0, .data = 0});
    return cr95hf_receive(cr95hf, ECHO);
 }
 
@@ -263,7 +263,7 @@ cr95hf_resp_t cr95hf_echo (cr95hf_t *cr95hf) {
  * \return           The CR95HF response using value semantics \see cr95hf_resp_t
  */
 cr95hf_resp_t cr95hf_idn (cr95hf_t *cr95hf) {
-   transmit (cr95hf, IDN, (span08_t){0, 0});
+   transmit (cr95hf, IDN, (span08_t){.size = 0, .data = 0});
    return cr95hf_receive(cr95hf, IDN);
 }
 
@@ -278,7 +278,7 @@ cr95hf_resp_t cr95hf_idn (cr95hf_t *cr95hf) {
 cr95hf_resp_t cr95hf_protocolSelect (cr95hf_t *cr95hf, span08_t buffer) {
    // assert the function parameters
    if (!isAnAvailableProtocol(buffer.data[0]))
-      return (cr95hf_resp_t){DRV_ERROR, 0, {0, 0}};
+      return (cr95hf_resp_t){DRV_ERROR, 0, {.size = 0, .data = 0}};
 
    transmit (cr95hf, PROTOCOL_SELECT, buffer);
    return cr95hf_receive(cr95hf, PROTOCOL_SELECT);
@@ -351,7 +351,7 @@ cr95hf_resp_t cr95hf_idle (cr95hf_t *cr95hf, span08_t buffer, cr95hf_callback_ft
 
    if (callback) {
       queue08_set_trigger(cr95hf->hal.queue, callback, MORE_EQ, 2);
-      return (cr95hf_resp_t){DRV_AWAIT, 0, {0, 0}};
+      return (cr95hf_resp_t){DRV_AWAIT, 0, {.size = 0, .data = 0}};
    }
    else {
       return cr95hf_receive(cr95hf, IDLE);
@@ -388,7 +388,7 @@ cr95hf_resp_t cr95hf_field_off (cr95hf_t *cr95hf) {
 drv_status_en cr95hf_sync (cr95hf_t *cr95hf) {
    cr95hf_resp_t resp;
    for (size_t i=0 ; i<564 ; ++i) {
-      transmit(cr95hf, ECHO, (span08_t){0, 0});
+      transmit(cr95hf, ECHO, (span08_t){.size = 0, .data = 0});
       delay(2);
       if (queue08_size(cr95hf->hal.queue) >= 1) {
          resp = cr95hf_receive(cr95hf, ECHO);
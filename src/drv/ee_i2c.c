@@ -25,9 +25,17 @@
 
 #include <drv/ee_i2c.h>
 
-static drv_status_en _sendcontrol (ee_t *ee, uint8_t rd, uint8_t ackp);
+static drv_status_en _sendcontrol (ee_t *ee, address_t add, uint8_t rd, uint8_t ackp);
 static drv_status_en _sendaddress (ee_t *ee, address_t add);
 static int _writepage (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
+static drv_status_en _read (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
+static uint32_t _size_bytes (ee_t *ee);
+
+static int _wb_find (ee_t *ee, address_t page);
+static drv_status_en _wb_flush (ee_t *ee, int i);
+static drv_status_en _wb_flush_all (ee_t *ee);
+static drv_status_en _wb_put (ee_t *ee, address_t page, uint32_t off, byte_t *buf, uint32_t n);
+static void _wb_overlay (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
 
 
 /*!
@@ -35,6 +43,8 @@ static int _writepage (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
  *    Send control byte and select to use or not ACK polling
  *
  * \param  ee    Pointer indicate the ee data stuct to use
+ * \param  add   The internal address. For EE_08 its bits 8-9 select
+ *               the 256 byte block, in the control byte.
  * \param  rd    Read flag, 1 to read, 0 to write.
  * \param  ackp  Use Ack polling
  *
@@ -42,18 +52,20 @@ static int _writepage (ee_t *ee, address_t add, byte_t *buf, bytecount_t n);
  *    \arg DRV_READY
  *    \arg DRV_ERROR
  */
-static drv_status_en _sendcontrol (ee_t *ee, uint8_t rd, uint8_t ackp)
+static drv_status_en _sendcontrol (ee_t *ee, address_t add, uint8_t rd, uint8_t ackp)
 {
-   uint8_t  ack;
+   uint8_t  ack, ctrl = ee->conf.hw_addr;
    uint32_t to = ee->conf.timeout;
 
    // Cast rd to 0/1
    rd = (rd) ? 1:0;
+   if (ee->conf.size == EE_08)
+      ctrl |= (add >> 7) & 0x06;
 
    // Control byte (read/write) with ACK polling or not
    do {
       ee->io.i2c_ioctl (ee->io.i2c, CTRL_START, (void*)0);
-      ack = ee->io.i2c_tx (ee->io.i2c, ee->conf.hw_addr | rd, I2C_SEQ_BYTE_ACK);
+      ack = ee->io.i2c_tx (ee->io.i2c, ctrl | rd, I2C_SEQ_BYTE_ACK);
       --to;
    }while (!ack && ackp && to);
 
@@ -73,7 +85,8 @@ static drv_status_en _sendcontrol (ee_t *ee, uint8_t rd, uint8_t ackp)
 static drv_status_en _sendaddress (ee_t *ee, address_t add)
 {
    if (ee->conf.size == EE_08) {
-      if (!ee->io.i2c_tx (ee->io.i2c, add, I2C_SEQ_BYTE_ACK))
+      // The block bits went with the control byte
+      if (!ee->io.i2c_tx (ee->io.i2c, (byte_t)(add & 0x00FF), I2C_SEQ_BYTE_ACK))
          return DRV_ERROR;
    } else {
       // MSB of the address first
@@ -102,13 +115,13 @@ static drv_status_en _sendaddress (ee_t *ee, address_t add)
 static int _writepage (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
 {
    // Page start and page offset and num to write
-   uint8_t     pg_offset = add % ee->conf.page_size;
-   uint8_t     i, nl = ee->conf.page_size - pg_offset; // num up saturation
+   uint32_t    pg_offset = add % ee->conf.page_size;
+   uint32_t    i, nl = ee->conf.page_size - pg_offset; // num up saturation
 
    if (nl > n)  nl = n;   // Cut out the unnecessary bytes
 
    // Control byte (write)
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
+   if (_sendcontrol (ee, add, EE_WRITE, 1) == DRV_ERROR)
       return -1;
 
    if (_sendaddress (ee, add) == DRV_ERROR)
@@ -131,6 +144,202 @@ static int _writepage (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
    return i;
 }
 
+/*!
+ * \brief
+ *    Reads a block of data from the EEPROM device, with no write
+ *    buffer overlay.
+ *
+ * \param  ee    Pointer indicate the ee data stuct to use
+ * \param  add   EEPROM's internal address to start reading from.
+ * \param  buf   Pointer to the buffer that receives the data
+ * \param  n     The number of bytes to read
+ * \return
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+static drv_status_en _read (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
+{
+   uint8_t  ack;
+
+   if (!n)
+      return DRV_READY;
+   // ACK polling
+   if (_sendcontrol (ee, add, EE_WRITE, 1) == DRV_ERROR)
+      return DRV_ERROR;
+
+   if (_sendaddress (ee, add) == DRV_ERROR)
+      return DRV_ERROR;
+
+   // Send Control byte (read).
+   if (_sendcontrol (ee, add, EE_READ, 0) == DRV_ERROR)
+      return DRV_ERROR;
+
+   // Seq read bytes with ACK except last one
+   do {
+      ack = (n>1) ? 1:0;
+      *buf++ = ee->io.i2c_rx (ee->io.i2c, ack, I2C_SEQ_BYTE_ACK);
+      --n;
+   }while (n);
+
+   ee->io.i2c_ioctl (ee->io.i2c, CTRL_STOP, (void*)0);
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    The EEPROM size in bytes, from \sa ee_size_en
+ */
+static uint32_t _size_bytes (ee_t *ee)
+{
+   switch (ee->conf.size) {
+      case EE_08:    return 1024;
+      case EE_16:    return 2048;
+      case EE_32:    return 4096;
+      case EE_128:   return 16384;
+      case EE_256:   return 32768;
+      default:       return 0;
+   }
+}
+
+/*!
+ * \brief
+ *    Find a page in the write buffer
+ * \return  The page buffer, or -1 if the page is not buffered
+ */
+static int _wb_find (ee_t *ee, address_t page)
+{
+   uint32_t i;
+
+   for (i=0 ; i<ee->wbuf.pages ; ++i)
+      if (ee->wbuf.wb[i].page == page)
+         return i;
+   return -1;
+}
+
+/*!
+ * \brief
+ *    Write the dirty bytes of a page buffer to the EEPROM, in a single
+ *    write cycle, and free the buffer. The write cycle is not waited,
+ *    the next transfer does the ACK polling.
+ *
+ * \param  ee    Pointer indicate the ee data stuct to use
+ * \param  i     The page buffer
+ * \return
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+static drv_status_en _wb_flush (ee_t *ee, int i)
+{
+   ee_wb_t  *wb = (ee_wb_t*)&ee->wbuf.wb[i];
+   byte_t   *mem = ee->wbuf.mem + i*ee->conf.page_size;
+
+   if (wb->page == EE_WB_EMPTY)
+      return DRV_READY;
+   if (wb->hi > wb->lo
+       && _writepage (ee, wb->page + wb->lo, mem + wb->lo, wb->hi - wb->lo) != (int)(wb->hi - wb->lo))
+      return DRV_ERROR;
+   wb->page = EE_WB_EMPTY;
+   wb->lo = wb->hi = 0;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Flush all the page buffers
+ */
+static drv_status_en _wb_flush_all (ee_t *ee)
+{
+   uint32_t i;
+
+   for (i=0 ; i<ee->wbuf.pages ; ++i)
+      if (_wb_flush (ee, i) != DRV_READY)
+         return DRV_ERROR;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Put data of a single page to the write buffer. Writes to the same
+ *    page coalesce into one dirty range, so they cost one write cycle.
+ *    Gaps between them are filled from the EEPROM, a read being much
+ *    cheaper than a write cycle. A page that gets complete is flushed.
+ *
+ * \param  ee    Pointer indicate the ee data stuct to use
+ * \param  page  The page's EEPROM address
+ * \param  off   The data offset in the page
+ * \param  buf   Pointer to the data
+ * \param  n     The number of bytes, up to the end of the page
+ * \return
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+static drv_status_en _wb_put (ee_t *ee, address_t page, uint32_t off, byte_t *buf, uint32_t n)
+{
+   ee_wb_t  *wb;
+   byte_t   *mem;
+   uint32_t j;
+   int      i;
+
+   if ((i = _wb_find (ee, page)) < 0) {
+      // Take a free page buffer, or else the least recently used
+      for (j=0, i=0 ; j<ee->wbuf.pages ; ++j) {
+         if (ee->wbuf.wb[j].page == EE_WB_EMPTY) {
+            i = j;
+            break;
+         }
+         if (ee->wbuf.wb[j].used < ee->wbuf.wb[i].used)
+            i = j;
+      }
+      if (_wb_flush (ee, i) != DRV_READY)
+         return DRV_ERROR;
+      ee->wbuf.wb[i].page = page;
+   }
+   wb = (ee_wb_t*)&ee->wbuf.wb[i];
+   mem = ee->wbuf.mem + i*ee->conf.page_size;
+
+   if (wb->lo == wb->hi) {
+      wb->lo = off;
+      wb->hi = off + n;
+   }
+   else {
+      if (off > wb->hi && _read (ee, page + wb->hi, mem + wb->hi, off - wb->hi) != DRV_READY)
+         return DRV_ERROR;
+      if (off + n < wb->lo && _read (ee, page + off + n, mem + off + n, wb->lo - off - n) != DRV_READY)
+         return DRV_ERROR;
+      if (off < wb->lo)       wb->lo = off;
+      if (off + n > wb->hi)   wb->hi = off + n;
+   }
+   memcpy ((void*)(mem + off), (const void*)buf, n);
+   wb->used = ++ee->wbuf.tick;
+
+   // Nothing left to coalesce, start the write cycle
+   if (wb->lo == 0 && wb->hi == ee->conf.page_size)
+      return _wb_flush (ee, i);
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Copy the buffered, not yet written, data over data read from the EEPROM
+ */
+static void _wb_overlay (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
+{
+   address_t s, e;
+   uint32_t  i;
+
+   for (i=0 ; i<ee->wbuf.pages ; ++i) {
+      if (ee->wbuf.wb[i].page == EE_WB_EMPTY)
+         continue;
+      s = ee->wbuf.wb[i].page + ee->wbuf.wb[i].lo;
+      e = ee->wbuf.wb[i].page + ee->wbuf.wb[i].hi;
+      if (s < add)      s = add;
+      if (e > add + n)  e = add + n;
+      if (s < e)
+         memcpy ((void*)(buf + (s - add)),
+                 (const void*)(ee->wbuf.mem + i*ee->conf.page_size + (s - ee->wbuf.wb[i].page)), e - s);
+   }
+}
+
 
 
 
@@ -205,6 +414,19 @@ __INLINE void ee_set_timeout (ee_t *ee, uint32_t to) {
    ee->conf.timeout = to;
 }
 
+/*!
+ * \brief
+ *    Set the optional write buffer memory. Each page_size bytes of it
+ *    buffer one EEPROM page, up to EE_WB_PAGES. Small writes to a buffered
+ *    page coalesce and reach the EEPROM in one write cycle, when the page
+ *    gets complete, its buffer is needed, or on ee_sync().
+ *    Set it before ee_init().
+ */
+void ee_set_write_buffer (ee_t *ee, byte_t *mem, uint32_t size) {
+   ee->wbuf.mem = mem;
+   ee->wbuf.size = (mem) ? size : 0;
+}
+
 
 /*!
  * \brief
@@ -214,6 +436,9 @@ __INLINE void ee_set_timeout (ee_t *ee, uint32_t to) {
  */
 void ee_deinit (ee_t *ee)
 {
+   // Do not lose buffered data
+   if (ee->status == DRV_READY)
+      ee_sync (ee);
    memset ((void*)ee, 0, sizeof (ee_t));
    /*!<
     * This leaves the status = DRV_NOINIT
@@ -232,6 +457,7 @@ void ee_deinit (ee_t *ee)
 drv_status_en ee_init (ee_t *ee)
 {
    #define _bad_link(_link)   (!ee->io._link) ? 1:0
+   int i;
 
    if (_bad_link (i2c))       return ee->status = DRV_ERROR;
    if (_bad_link (i2c_rx))    return ee->status = DRV_ERROR;
@@ -246,6 +472,17 @@ drv_status_en ee_init (ee_t *ee)
    if (!ee->conf.page_size)   ee->conf.page_size = EE_PAGE_SZ_DEF;
    if (!ee->conf.sector_size) ee->conf.sector_size = EE_SECTOR_SIZE_DEF;
 
+   // Write buffer
+   ee->wbuf.pages = ee->wbuf.size / ee->conf.page_size;
+   if (ee->wbuf.pages > EE_WB_PAGES)
+      ee->wbuf.pages = EE_WB_PAGES;
+   for (i=0 ; i<EE_WB_PAGES ; ++i) {
+      ee->wbuf.wb[i].page = EE_WB_EMPTY;
+      ee->wbuf.wb[i].lo = ee->wbuf.wb[i].hi = 0;
+      ee->wbuf.wb[i].used = 0;
+   }
+   ee->wbuf.tick = 0;
+
    return ee->status = DRV_READY;
    #undef _bad_link
 }
@@ -262,11 +499,11 @@ drv_status_en ee_init (ee_t *ee)
 drv_status_en ee_read_cursor (ee_t *ee, byte_t *byte)
 {
    // ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
+   if (_sendcontrol (ee, 0, EE_WRITE, 1) == DRV_ERROR)
       return DRV_ERROR;
 
    // Send Control byte (read).
-   if (_sendcontrol (ee, EE_READ, 0) == DRV_ERROR)
+   if (_sendcontrol (ee, 0, EE_READ, 0) == DRV_ERROR)
       return DRV_ERROR;
 
    // Read with NACK
@@ -291,20 +528,21 @@ drv_status_en ee_read_cursor (ee_t *ee, byte_t *byte)
 drv_status_en ee_read_byte (ee_t *ee, address_t add, byte_t *byte)
 {
    // Send Control byte (write) with ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
+   if (_sendcontrol (ee, add, EE_WRITE, 1) == DRV_ERROR)
       return DRV_ERROR;
 
    if (_sendaddress (ee, add) == DRV_ERROR)
       return DRV_ERROR;
 
    // Send Control byte (read).
-   if (_sendcontrol (ee, EE_READ, 0) == DRV_ERROR)
+   if (_sendcontrol (ee, add, EE_READ, 0) == DRV_ERROR)
       return DRV_ERROR;
 
    // Read with NACK
    *byte = ee->io.i2c_rx (ee->io.i2c, 0, I2C_SEQ_BYTE_ACK);
 
    ee->io.i2c_ioctl (ee->io.i2c, CTRL_STOP, (void*)0);
+   _wb_overlay (ee, add, byte, 1);
    return DRV_READY;
 }
 
@@ -322,8 +560,11 @@ drv_status_en ee_read_byte (ee_t *ee, address_t add, byte_t *byte)
  */
 drv_status_en ee_write_byte (ee_t *ee, address_t add, byte_t byte)
 {
+   if (ee->wbuf.pages)
+      return ee_write (ee, add, &byte, 1);
+
    // ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
+   if (_sendcontrol (ee, add, EE_WRITE, 1) == DRV_ERROR)
       return DRV_ERROR;
 
    if (_sendaddress (ee, add) == DRV_ERROR)
@@ -352,27 +593,9 @@ drv_status_en ee_write_byte (ee_t *ee, address_t add, byte_t byte)
  */
 drv_status_en ee_read (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
 {
-   uint8_t  ack;
-
-   // ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
-      return DRV_ERROR;
-
-   if (_sendaddress (ee, add) == DRV_ERROR)
-      return DRV_ERROR;
-
-   // Send Control byte (read).
-   if (_sendcontrol (ee, EE_READ, 0) == DRV_ERROR)
+   if (_read (ee, add, buf, n) != DRV_READY)
       return DRV_ERROR;
-
-   // Seq read bytes with ACK except last one
-   do {
-      ack = (n>1) ? 1:0;
-      *buf++ = ee->io.i2c_rx (ee->io.i2c, ack, I2C_SEQ_BYTE_ACK);
-      --n;
-   }while (n);
-
-   ee->io.i2c_ioctl (ee->io.i2c, CTRL_STOP, (void*)0);
+   _wb_overlay (ee, add, buf, n);
    return DRV_READY;
 }
 
@@ -391,45 +614,114 @@ drv_status_en ee_read (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
  */
 drv_status_en ee_write (ee_t *ee, address_t add, byte_t *buf, bytecount_t n)
 {
-   uint32_t wb=0;    // The written bytes
-   int      ret;
-
-   // ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
-      return ee->status = DRV_ERROR;
-
-   if (_sendaddress (ee, add) == DRV_ERROR)
-      return ee->status = DRV_ERROR;
-
-   do {
-      ret = _writepage (ee, add+wb, &buf[wb], n-wb);
-      if (ret == -1)    return DRV_ERROR;
-      else              wb += ret;
-      /*!
-       * \note
-       * Each _writepage writes only until the page limit, so we
-       * call _writepage until we have no more data to send.
-       */
-   } while (wb < n);
-
+   uint32_t off, nl;
+   int      ret, i;
+
+   while (n) {
+      off = add % ee->conf.page_size;
+      nl = ee->conf.page_size - off;
+      if (nl > n)    nl = n;
+
+      if (ee->wbuf.pages && nl < ee->conf.page_size) {
+         // Partial page, coalesce in the write buffer
+         if (_wb_put (ee, add - off, off, buf, nl) != DRV_READY)
+            return DRV_ERROR;
+      }
+      else {
+         // Whole page, a buffered copy of it is overwritten
+         if ((i = _wb_find (ee, add - off)) >= 0) {
+            ee->wbuf.wb[i].page = EE_WB_EMPTY;
+            ee->wbuf.wb[i].lo = ee->wbuf.wb[i].hi = 0;
+         }
+         ret = _writepage (ee, add, buf, nl);
+         if (ret <= 0)     return DRV_ERROR;
+         else              nl = ret;
+         /*!
+          * \note
+          * Each _writepage writes only until the page limit and does
+          * the ACK polling for the previous write cycle, so the caller
+          * is never blocked for the last one.
+          */
+      }
+      add += nl;
+      buf += nl;
+      n -= nl;
+   }
    return DRV_READY;
 }
 
+/*!
+ * \brief
+ *    Reads sectors of conf.sector_size bytes from the EEPROM.
+ *
+ * \param  ee     Pointer indicate the ee data stuct to use
+ * \param  sector The first sector
+ * \param  buf    Pointer to the buffer that receives the data
+ * \param  count  The number of sectors
+ *
+ * \return The driver status after read.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en  ee_read_sector (ee_t *ee, int sector, byte_t *buf, int count)
+{
+   if (sector < 0 || count < 0
+       || (uint32_t)(sector + count) * ee->conf.sector_size > _size_bytes (ee))
+      return DRV_ERROR;
+   return ee_read (ee, sector * ee->conf.sector_size, buf, count * ee->conf.sector_size);
+}
 
-drv_status_en  ee_read_sector (ee_t *ee, int sector, byte_t *buf, int count) {
-   return DRV_ERROR;
+/*!
+ * \brief
+ *    Writes sectors of conf.sector_size bytes to the EEPROM.
+ *
+ * \param  ee     Pointer indicate the ee data stuct to use
+ * \param  sector The first sector
+ * \param  buf    Pointer to the buffer that holds the data
+ * \param  count  The number of sectors
+ *
+ * \return The driver status after write.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en ee_write_sector (ee_t *ee, int sector, byte_t *buf, int count)
+{
+   if (sector < 0 || count < 0
+       || (uint32_t)(sector + count) * ee->conf.sector_size > _size_bytes (ee))
+      return DRV_ERROR;
+   return ee_write (ee, sector * ee->conf.sector_size, buf, count * ee->conf.sector_size);
 }
 
-drv_status_en ee_write_sector (ee_t *ee, int sector, byte_t *buf, int count) {
-   return DRV_ERROR;
+/*!
+ * \brief
+ *    Writes all the buffered data to the EEPROM and waits for the
+ *    last write cycle to finish.
+ *
+ * \param  ee     Pointer indicate the ee data stuct to use
+ * \return The driver status after write.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en ee_sync (ee_t *ee)
+{
+   if (_wb_flush_all (ee) != DRV_READY)
+      return DRV_ERROR;
+   // ACK polling
+   if (_sendcontrol (ee, 0, EE_WRITE, 1) == DRV_ERROR)
+      return DRV_ERROR;
+   ee->io.i2c_ioctl (ee->io.i2c, CTRL_STOP, (void*)0);
+   return DRV_READY;
 }
 
 __INLINE drv_status_en ee_clear (ee_t *ee, uint32_t size) {
    uint32_t wb=0;    // The written bytes
    int      ret;
 
+   if (_wb_flush_all (ee) != DRV_READY)
+      return DRV_ERROR;
+
    // ACK polling
-   if (_sendcontrol (ee, EE_WRITE, 1) == DRV_ERROR)
+   if (_sendcontrol (ee, 0, EE_WRITE, 1) == DRV_ERROR)
       return ee->status = DRV_ERROR;
 
    if (_sendaddress (ee, 0) == DRV_ERROR)
@@ -460,6 +752,9 @@ __INLINE drv_status_en ee_clear (ee_t *ee, uint32_t size) {
  *    \arg CTRL_INIT
  *    \arg CTRL_GET_SIZE
  *    \arg CTRL_GET_SECTOR_SIZE
+ *    \arg CTRL_GET_SECTOR_COUNT
+ *    \arg CTRL_GET_BLOCK_SIZE
+ *    \arg CTRL_SYNC
  *    \arg CTRL_ERASE_PAGE    **
  *    \arg CTRL_ERASE_ALL     **
  *    \arg CTRL_FORMAT        **
@@ -492,6 +787,16 @@ drv_status_en ee_ioctl (ee_t *ee, ioctl_cmd_t cmd, ioctl_buf_t buf)
          if (buf)
             *(drv_status_en*)buf = ee->conf.sector_size;
          return DRV_READY;
+      case CTRL_GET_SECTOR_COUNT:   /*!< Number of sectors (uint32_t) */
+         if (buf)
+            *(uint32_t*)buf = _size_bytes (ee) / ee->conf.sector_size;
+         return DRV_READY;
+      case CTRL_GET_BLOCK_SIZE:     /*!< Erase block size in sectors (uint32_t) */
+         if (buf)
+            *(uint32_t*)buf = 1;
+         return DRV_READY;
+      case CTRL_SYNC:               /*!< Flush the write buffer */
+         return ee_sync (ee);
       default:                   /*!< Unsupported command, error */
          return DRV_ERROR;
 
@@ -0,0 +1,737 @@
+/*!
+ * \file s25fs_ftl.c
+ * \brief
+ *    A flash translation layer for the s25fs spi flash driver. It exports
+ *    the flash as a re-writable 512 byte sector block device, suitable for
+ *    FatFs, with log structured sector mapping, garbage collection and
+ *    wear levelling.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <drv/s25fs_ftl.h>
+
+/*!
+ * Erase block layout
+ *
+ *  sector 0:   | magic | erase | ~erase | seq | ~seq | rsv | tag 0 | tag 1 | ... |
+ *  sector 1:   data of slot 0
+ *  sector 2:   data of slot 1
+ *  ...
+ *
+ * The magic and the erase count are programmed right after the erase. The
+ * sequence when the block gets allocated for writing. Slots are filled in
+ * order and each tag, holding the sector number, is programmed only after
+ * its data. So after a power loss a tagged slot always has complete data,
+ * and the copy in the block with the greatest sequence is the current one.
+ */
+#define _FTL_HDR_SIZE      (24)           /*!< Block header bytes, before the tags */
+#define _FTL_CHUNK         (128)          /*!< Stack buffer for tags and copies */
+#define _FTL_TAG_EMPTY     (0xFFFFFFFF)   /*!< Tag of a free slot */
+#define _FTL_TAG_DEAD      (0x00000000)   /*!< Tag of a slot with no usable data */
+#define _FTL_SEQ_DIRTY     (0xFFFFFFFE)   /*!< Sequence of a block pending erase */
+#define _FTL_TAG_SECTOR    (0x00FFFFFF)   /*!< Sector number bits of a tag */
+#define _FTL_MAX_SECTORS   (0x00FF0000)   /*!< Sectors, so a torn dead tag is never in range */
+
+#define _sect_sz(_ftl)     ((_ftl)->flash->conf.sector_sz)
+#define _blk_sz(_ftl)      ((_ftl)->flash->conf.erase_page_sz)
+
+static uint32_t _tag_enc (uint32_t sector);
+static int _tag_dec (uint32_t tag, uint32_t *sector);
+static s25fs_idx_t _blk_addr (s25fs_ftl_t *ftl, uint32_t b);
+static s25fs_idx_t _slot_addr (s25fs_ftl_t *ftl, uint32_t b, uint32_t s);
+static s25fs_idx_t _tag_addr (s25fs_ftl_t *ftl, uint32_t b, uint32_t s);
+
+static int _newer (s25fs_ftl_t *ftl, uint32_t p, uint32_t q);
+static drv_status_en _erase (s25fs_ftl_t *ftl, uint32_t b, uint32_t count);
+static drv_status_en _alloc (s25fs_ftl_t *ftl);
+static drv_status_en _commit (s25fs_ftl_t *ftl, uint32_t sector, int n);
+static drv_status_en _copy (s25fs_ftl_t *ftl, s25fs_idx_t from, s25fs_idx_t to);
+static drv_status_en _collect (s25fs_ftl_t *ftl);
+static drv_status_en _scan (s25fs_ftl_t *ftl, uint32_t b);
+static drv_status_en _mount (s25fs_ftl_t *ftl);
+
+/*!
+ * \brief
+ *    Tag encoding. 24 bits of sector number and an 8 bit check, so a
+ *    partially programmed tag is detected.
+ */
+static uint32_t _tag_enc (uint32_t sector)
+{
+   uint32_t chk = ~(sector ^ (sector >> 8) ^ (sector >> 16)) & 0xFF;
+   return (chk << 24) | (sector & _FTL_TAG_SECTOR);
+}
+
+/*!
+ * \brief
+ *    Tag decoding.
+ * \param   tag      The tag read from flash
+ * \param   sector   Pointer to store the sector number
+ * \return           True if the tag is valid
+ */
+static int _tag_dec (uint32_t tag, uint32_t *sector)
+{
+   *sector = tag & _FTL_TAG_SECTOR;
+   return (tag != _FTL_TAG_EMPTY && tag == _tag_enc (*sector)) ? 1:0;
+}
+
+/*!
+ * \brief
+ *    Flash addresses of a block, of a slot's data and of a slot's tag
+ */
+static s25fs_idx_t _blk_addr (s25fs_ftl_t *ftl, uint32_t b) {
+   return (ftl->first + b) * _blk_sz (ftl);
+}
+static s25fs_idx_t _slot_addr (s25fs_ftl_t *ftl, uint32_t b, uint32_t s) {
+   return _blk_addr (ftl, b) + (s+1) * _sect_sz (ftl);
+}
+static s25fs_idx_t _tag_addr (s25fs_ftl_t *ftl, uint32_t b, uint32_t s) {
+   return _blk_addr (ftl, b) + _FTL_HDR_SIZE + 4*s;
+}
+
+/*!
+ * \brief
+ *    Compare the age of two copies of a sector
+ * \param   ftl   Pointer to FTL to use
+ * \param   p     Slot of the first copy
+ * \param   q     Slot of the second copy, or S25FS_FTL_UNMAPPED
+ * \return        True if \a p is newer than \a q
+ */
+static int _newer (s25fs_ftl_t *ftl, uint32_t p, uint32_t q)
+{
+   uint32_t ps, qs;
+
+   if (q == S25FS_FTL_UNMAPPED)
+      return 1;
+   ps = ftl->blk[p / ftl->slots].seq;
+   qs = ftl->blk[q / ftl->slots].seq;
+   return (ps > qs || (ps == qs && p > q)) ? 1:0;
+}
+
+/*!
+ * \brief
+ *    Erase a block and program its header, so the erase count
+ *    survives a power loss.
+ * \param   ftl   Pointer to FTL to use
+ * \param   b     The block
+ * \param count   The block's new erase count
+ * \return        The status of the operation
+ */
+static drv_status_en _erase (s25fs_ftl_t *ftl, uint32_t b, uint32_t count)
+{
+   uint8_t  h[12];
+
+   if (s25fs_erase (ftl->flash, _blk_addr (ftl, b)) != DRV_READY)
+      return DRV_ERROR;
+   PUT_UINT32_LE (S25FS_FTL_MAGIC, h, 0);
+   PUT_UINT32_LE (count, h, 4);
+   PUT_UINT32_LE (~count, h, 8);
+   if (s25fs_write (ftl->flash, _blk_addr (ftl, b), h, sizeof (h)) != DRV_READY)
+      return DRV_ERROR;
+   ftl->blk[b].seq = S25FS_FTL_FREE;
+   ftl->blk[b].erase = count;
+   ftl->blk[b].valid = 0;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Take the least worn free block as the new active block. Blocks
+ *    pending erase are erased here.
+ * \param   ftl   Pointer to FTL to use
+ * \return        The status of the operation
+ */
+static drv_status_en _alloc (s25fs_ftl_t *ftl)
+{
+   uint32_t b, min = ftl->blocks;
+   uint8_t  h[8];
+
+   for (b=0 ; b<ftl->blocks ; ++b) {
+      if (ftl->blk[b].seq != S25FS_FTL_FREE && ftl->blk[b].seq != _FTL_SEQ_DIRTY)
+         continue;
+      if (min == ftl->blocks || ftl->blk[b].erase < ftl->blk[min].erase)
+         min = b;
+   }
+   if (min == ftl->blocks)
+      return DRV_ERROR;
+   if (ftl->blk[min].seq == _FTL_SEQ_DIRTY &&
+       _erase (ftl, min, ftl->blk[min].erase + 1) != DRV_READY)
+      return DRV_ERROR;
+
+   PUT_UINT32_LE (ftl->seq + 1, h, 0);
+   PUT_UINT32_LE (~(ftl->seq + 1), h, 4);
+   if (s25fs_write (ftl->flash, _blk_addr (ftl, min) + 12, h, sizeof (h)) != DRV_READY)
+      return DRV_ERROR;
+   ftl->blk[min].seq = ++ftl->seq;
+   ftl->active = min;
+   ftl->wp = 0;
+   --ftl->nfree;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Program the tags of \a n consecutive sectors, already programmed at
+ *    the active block's write pointer, and map them there.
+ * \param   ftl      Pointer to FTL to use
+ * \param   sector   The first sector
+ * \param   n        The number of sectors, up to _FTL_CHUNK/4
+ * \return           The status of the operation
+ */
+static drv_status_en _commit (s25fs_ftl_t *ftl, uint32_t sector, int n)
+{
+   uint8_t  t[_FTL_CHUNK];
+   uint32_t p, old;
+   int i;
+
+   for (i=0 ; i<n ; ++i)
+      PUT_UINT32_LE (_tag_enc (sector + i), t, 4*i);
+   if (s25fs_write (ftl->flash, _tag_addr (ftl, ftl->active, ftl->wp), t, 4*n) != DRV_READY)
+      return DRV_ERROR;
+
+   for (i=0 ; i<n ; ++i) {
+      p = ftl->active * ftl->slots + ftl->wp++;
+      if ((old = ftl->map[sector + i]) != S25FS_FTL_UNMAPPED)
+         --ftl->blk[old / ftl->slots].valid;
+      ftl->map[sector + i] = p;
+      ++ftl->blk[ftl->active].valid;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Copy a sector's data between two flash addresses
+ */
+static drv_status_en _copy (s25fs_ftl_t *ftl, s25fs_idx_t from, s25fs_idx_t to)
+{
+   uint8_t  d[_FTL_CHUNK];
+   uint32_t i;
+
+   for (i=0 ; i<_sect_sz (ftl) ; i += sizeof (d)) {
+      if (s25fs_read (ftl->flash, from + i, d, sizeof (d)) != DRV_READY)
+         return DRV_ERROR;
+      if (s25fs_write (ftl->flash, to + i, d, sizeof (d)) != DRV_READY)
+         return DRV_ERROR;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Garbage collection. Moves the mapped sectors of a victim block to the
+ *    active block and marks the victim for erase.
+ *    The victim is the block with the fewest mapped sectors, or the least
+ *    worn one when the erase counts spread more than S25FS_FTL_WEAR_DELTA,
+ *    so blocks holding static data get their share of the wear.
+ *    A victim that does not fit in the active block, as after a power loss
+ *    in the middle of a collection, continues in a newly allocated block.
+ * \param   ftl   Pointer to FTL to use
+ * \return        The status of the operation
+ */
+static drv_status_en _collect (s25fs_ftl_t *ftl)
+{
+   uint32_t b, v=ftl->blocks, cold=ftl->blocks;
+   uint32_t s, sector, tag, max=0;
+   uint32_t room = ftl->slots - ftl->wp;
+   uint8_t  t[4];
+
+   for (b=0 ; b<ftl->blocks ; ++b) {
+      if (ftl->blk[b].erase > max)
+         max = ftl->blk[b].erase;
+      if (b == ftl->active || ftl->blk[b].seq >= _FTL_SEQ_DIRTY)
+         continue;
+      if (v == ftl->blocks || ftl->blk[b].valid < ftl->blk[v].valid)
+         v = b;
+      if (ftl->blk[b].valid <= room
+          && (cold == ftl->blocks || ftl->blk[b].erase < ftl->blk[cold].erase))
+         cold = b;
+   }
+   if (v == ftl->blocks || (ftl->blk[v].valid > room && !ftl->nfree))
+      return DRV_ERROR;
+   if (cold != ftl->blocks && ftl->blk[cold].erase + S25FS_FTL_WEAR_DELTA < max)
+      v = cold;
+
+   for (s=0 ; s<ftl->slots && ftl->blk[v].valid ; ++s) {
+      if (s25fs_read (ftl->flash, _tag_addr (ftl, v, s), t, 4) != DRV_READY)
+         return DRV_ERROR;
+      GET_UINT32_LE (tag, t, 0);
+      if (!_tag_dec (tag, &sector) || sector >= ftl->sectors
+          || ftl->map[sector] != v * ftl->slots + s)
+         continue;
+      if (ftl->wp >= ftl->slots && _alloc (ftl) != DRV_READY)
+         return DRV_ERROR;
+      if (_copy (ftl, _slot_addr (ftl, v, s), _slot_addr (ftl, ftl->active, ftl->wp)) != DRV_READY)
+         return DRV_ERROR;
+      if (_commit (ftl, sector, 1) != DRV_READY)
+         return DRV_ERROR;
+   }
+   ftl->blk[v].seq = _FTL_SEQ_DIRTY;
+   ++ftl->nfree;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Read a used block's tags and map its sectors, keeping the newest copies.
+ *    Leaves the number of programmed slots in the block's valid field, for
+ *    _mount() to find the write pointer.
+ * \param   ftl   Pointer to FTL to use
+ * \param   b     The block
+ * \return        The status of the operation
+ */
+static drv_status_en _scan (s25fs_ftl_t *ftl, uint32_t b)
+{
+   uint8_t  t[_FTL_CHUNK];
+   uint32_t s, n, i, tag, sector, p;
+
+   for (s=0 ; s<ftl->slots ; s += n) {
+      n = ftl->slots - s;
+      if (n > _FTL_CHUNK/4)   n = _FTL_CHUNK/4;
+      if (s25fs_read (ftl->flash, _tag_addr (ftl, b, s), t, 4*n) != DRV_READY)
+         return DRV_ERROR;
+      for (i=0 ; i<n ; ++i) {
+         GET_UINT32_LE (tag, t, 4*i);
+         if (tag == _FTL_TAG_EMPTY) {
+            ftl->blk[b].valid = s + i;
+            return DRV_READY;
+         }
+         p = b * ftl->slots + s + i;
+         if (_tag_dec (tag, &sector) && sector < ftl->sectors
+             && _newer (ftl, p, ftl->map[sector]))
+            ftl->map[sector] = p;
+      }
+   }
+   ftl->blk[b].valid = ftl->slots;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Rebuild the RAM tables from the flash.
+ *    Blocks with no valid header, blank or hit by a power loss during the
+ *    erase, are marked for erase with the greatest known erase count.
+ * \param   ftl   Pointer to FTL to use
+ * \return        The status of the operation
+ */
+static drv_status_en _mount (s25fs_ftl_t *ftl)
+{
+   uint8_t  h[_FTL_HDR_SIZE], d[_FTL_CHUNK];
+   uint32_t b, p, i, magic, er, ner, seq, nseq, max=0;
+   int      used = 0;
+
+   ftl->seq = 0;
+   ftl->nfree = 0;
+   for (b=0 ; b<ftl->blocks ; ++b) {
+      if (s25fs_read (ftl->flash, _blk_addr (ftl, b), h, sizeof (h)) != DRV_READY)
+         return DRV_ERROR;
+      GET_UINT32_LE (magic, h, 0);
+      GET_UINT32_LE (er, h, 4);
+      GET_UINT32_LE (ner, h, 8);
+      GET_UINT32_LE (seq, h, 12);
+      GET_UINT32_LE (nseq, h, 16);
+
+      ftl->blk[b].valid = 0;
+      if (magic != S25FS_FTL_MAGIC || er != ~ner) {
+         ftl->blk[b].seq = _FTL_SEQ_DIRTY;
+         ftl->blk[b].erase = S25FS_FTL_UNMAPPED;
+         ++ftl->nfree;
+         continue;
+      }
+      ftl->blk[b].erase = er;
+      if (er > max)  max = er;
+      if (seq == S25FS_FTL_FREE && nseq == S25FS_FTL_FREE) {
+         ftl->blk[b].seq = S25FS_FTL_FREE;
+         ++ftl->nfree;
+      }
+      else if (seq != ~nseq || seq >= _FTL_SEQ_DIRTY) {
+         ftl->blk[b].seq = _FTL_SEQ_DIRTY;   // Power loss during allocation
+         ++ftl->nfree;
+      }
+      else {
+         ftl->blk[b].seq = seq;
+         if (seq >= ftl->seq) {
+            ftl->seq = seq;
+            ftl->active = b;
+         }
+         ++used;
+      }
+   }
+   // Unknown erase counts take the worst case
+   for (b=0 ; b<ftl->blocks ; ++b)
+      if (ftl->blk[b].erase == S25FS_FTL_UNMAPPED)
+         ftl->blk[b].erase = max;
+
+   if (!used) {
+      ftl->wp = ftl->slots;   // Allocate on the first write
+      return DRV_READY;
+   }
+   for (b=0 ; b<ftl->blocks ; ++b) {
+      if (ftl->blk[b].seq < _FTL_SEQ_DIRTY && _scan (ftl, b) != DRV_READY)
+         return DRV_ERROR;
+   }
+   ftl->wp = ftl->blk[ftl->active].valid;
+
+   // Count the mapped sectors per block
+   for (b=0 ; b<ftl->blocks ; ++b)
+      ftl->blk[b].valid = 0;
+   for (i=0 ; i<ftl->sectors ; ++i)
+      if ((p = ftl->map[i]) != S25FS_FTL_UNMAPPED)
+         ++ftl->blk[p / ftl->slots].valid;
+
+   // The slots after the last tag may hold data of an interrupted write
+   while (ftl->wp < ftl->slots) {
+      for (i=0 ; i<_sect_sz (ftl) ; i += sizeof (d)) {
+         if (s25fs_read (ftl->flash, _slot_addr (ftl, ftl->active, ftl->wp) + i, d, sizeof (d)) != DRV_READY)
+            return DRV_ERROR;
+         for (p=0 ; p<sizeof (d) && d[p] == 0xFF ; ++p)
+            ;
+         if (p < sizeof (d))
+            break;
+      }
+      if (i >= _sect_sz (ftl))
+         break;
+      // Check byte first. A dead tag torn after its low bytes would
+      // otherwise read as the tag of sector 0.
+      PUT_UINT32_LE (_FTL_TAG_DEAD, d, 0);
+      if (s25fs_write (ftl->flash, _tag_addr (ftl, ftl->active, ftl->wp) + 3, d, 1) != DRV_READY
+          || s25fs_write (ftl->flash, _tag_addr (ftl, ftl->active, ftl->wp), d, 4) != DRV_READY)
+         return DRV_ERROR;
+      ++ftl->wp;
+   }
+   // Power loss during a garbage collection, restore the reserve block
+   while (ftl->nfree <= 1)
+      if (_collect (ftl) != DRV_READY)
+         return DRV_ERROR;
+   return DRV_READY;
+}
+
+
+
+
+/*
+ *  ============= PUBLIC S25FS FTL API =============
+ */
+
+/*
+ * Link and Glue functions
+ */
+
+/*!
+ * \brief
+ *    Link the s25fs flash driver to the FTL
+ */
+void s25fs_ftl_link_flash (s25fs_ftl_t *ftl, s25fs_t *flash) {
+   ftl->flash = flash;
+}
+
+
+
+
+/*
+ * Set functions
+ */
+
+/*!
+ * \brief
+ *    Set the flash area the FTL owns
+ * \param   ftl      Pointer to FTL to use
+ * \param   first    The first erase block
+ * \param   blocks   The number of erase blocks, more than S25FS_FTL_SPARE_BLOCKS
+ */
+void s25fs_ftl_set_area (s25fs_ftl_t *ftl, uint32_t first, uint32_t blocks) {
+   ftl->first = first;
+   ftl->blocks = blocks;
+}
+
+
+
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Calculates the RAM s25fs_ftl_init() needs for the linked flash
+ *    and the area set.
+ * \param   ftl   Pointer to FTL to use
+ * \return        The size in bytes, 0 on bad configuration
+ */
+size_t s25fs_ftl_mem_size (s25fs_ftl_t *ftl)
+{
+   uint32_t slots, tags;
+
+   if (!ftl->flash || !_sect_sz (ftl) || _blk_sz (ftl) < 2*_sect_sz (ftl)
+       || _sect_sz (ftl) % _FTL_CHUNK || ftl->blocks <= S25FS_FTL_SPARE_BLOCKS)
+      return 0;
+   slots = _blk_sz (ftl) / _sect_sz (ftl) - 1;
+   tags = (_sect_sz (ftl) - _FTL_HDR_SIZE) / 4;
+   ftl->slots = (slots < tags) ? slots : tags;
+   ftl->sectors = (ftl->blocks - S25FS_FTL_SPARE_BLOCKS) * ftl->slots;
+   if (ftl->sectors > _FTL_MAX_SECTORS)
+      return 0;
+   return S25FS_FTL_MEM_SIZE (ftl->blocks, ftl->sectors);
+}
+
+/*!
+ * \brief
+ *    De-Initialize the FTL. The flash is left untouched.
+ *
+ * \param  ftl    Pointer to FTL to use
+ */
+void s25fs_ftl_deinit (s25fs_ftl_t *ftl)
+{
+   memset ((void*)ftl, 0, sizeof (s25fs_ftl_t));
+   /*!<
+    * This leaves the status = DRV_NOINIT
+    */
+}
+
+/*!
+ * \brief
+ *    Initialize the FTL. Reads the flash area and rebuilds the
+ *    sector map. A blank area needs no format.
+ *
+ * \param   ftl   Pointer to FTL to use
+ * \param   mem   Memory for the FTL's tables, aligned to 4 bytes
+ * \param  size   The size of \a mem, at least s25fs_ftl_mem_size()
+ *
+ * \return The status of the init operation.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_init (s25fs_ftl_t *ftl, void *mem, size_t size)
+{
+   size_t need = s25fs_ftl_mem_size (ftl);
+
+   if (!need || !mem || size < need)
+      return ftl->status = DRV_ERROR;
+   if (ftl->flash->status != DRV_READY)
+      return ftl->status = DRV_NOINIT;
+
+   ftl->status = DRV_BUSY;
+   ftl->blk = (s25fs_ftl_blk_t*)mem;
+   ftl->map = (uint32_t*)&ftl->blk[ftl->blocks];
+   memset ((void*)ftl->map, 0xFF, ftl->sectors * sizeof (uint32_t));
+
+   if (_mount (ftl) != DRV_READY)
+      return ftl->status = DRV_ERROR;
+   return ftl->status = DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Erase the FTL's area. All sectors read back as 0xFF. The erase
+ *    counts are kept.
+ *
+ * \param   ftl   Pointer to FTL to use
+ * \return The status of the operation.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_format (s25fs_ftl_t *ftl)
+{
+   uint32_t b;
+
+   if (ftl->status != DRV_READY)
+      return DRV_ERROR;
+   for (b=0 ; b<ftl->blocks ; ++b) {
+      if (ftl->blk[b].seq == S25FS_FTL_FREE)
+         continue;
+      if (_erase (ftl, b, ftl->blk[b].erase + 1) != DRV_READY)
+         return DRV_ERROR;
+   }
+   memset ((void*)ftl->map, 0xFF, ftl->sectors * sizeof (uint32_t));
+   ftl->nfree = ftl->blocks;
+   ftl->wp = ftl->slots;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Read sectors. Never written or trimmed sectors read as 0xFF.
+ *
+ * \param    ftl   Pointer to FTL to use
+ * \param sector   The first sector
+ * \param    buf   Buffer pointer to store the data
+ * \param  count   Number of sectors to read
+ *
+ * \return The status of the operation.
+ *    \arg DRV_READY
+ *    \arg DRV_BUSY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_read (s25fs_ftl_t *ftl, int sector, s25fs_data_t *buf, int count)
+{
+   drv_status_en st;
+   uint32_t p;
+   int n;
+
+   if (ftl->status != DRV_READY || sector < 0 || count < 0
+       || (uint32_t)sector + count > ftl->sectors)
+      return DRV_ERROR;
+
+   for ( ; count ; sector += n, count -= n, buf += n*_sect_sz (ftl)) {
+      if ((p = ftl->map[sector]) == S25FS_FTL_UNMAPPED) {
+         memset ((void*)buf, 0xFF, _sect_sz (ftl));
+         n = 1;
+         continue;
+      }
+      // Sequentially written sectors are in consecutive slots, read them at once
+      for (n=1 ; n<count && ftl->map[sector+n] == p+n && (p+n) % ftl->slots ; ++n)
+         ;
+      st = s25fs_read (ftl->flash, _slot_addr (ftl, p / ftl->slots, p % ftl->slots),
+                       buf, n*_sect_sz (ftl));
+      if (st != DRV_READY)
+         return st;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Write sectors. Each sector goes to the next free slot of the active
+ *    block, so no erase is needed on the write path, except when a new
+ *    block is taken.
+ *
+ * \param    ftl   Pointer to FTL to use
+ * \param sector   The first sector
+ * \param    buf   Buffer pointer with the data to write
+ * \param  count   Number of sectors to write
+ *
+ * \return The status of the operation.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_write (s25fs_ftl_t *ftl, int sector, s25fs_data_t *buf, int count)
+{
+   uint32_t n;
+
+   if (ftl->status != DRV_READY || sector < 0 || count < 0
+       || (uint32_t)sector + count > ftl->sectors)
+      return DRV_ERROR;
+
+   for ( ; count ; sector += n, count -= n, buf += n*_sect_sz (ftl)) {
+      if (ftl->wp >= ftl->slots) {
+         if (_alloc (ftl) != DRV_READY)
+            return DRV_ERROR;
+         // Keep an erased block in reserve, for _collect() to recover
+         // from a power loss in the middle of a collection
+         if (ftl->nfree <= 1 && _collect (ftl) != DRV_READY)
+            return DRV_ERROR;
+      }
+      n = ftl->slots - ftl->wp;
+      if (n > (uint32_t)count)   n = count;
+      if (n > _FTL_CHUNK/4)      n = _FTL_CHUNK/4;
+      // Data first, then the tags that make it valid
+      if (s25fs_write (ftl->flash, _slot_addr (ftl, ftl->active, ftl->wp), buf, n*_sect_sz (ftl)) != DRV_READY)
+         return DRV_ERROR;
+      if (_commit (ftl, sector, n) != DRV_READY)
+         return DRV_ERROR;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Discard sectors, so garbage collection does not copy them.
+ * \note
+ *    Trimming is not recorded on the flash. After a power loss trimmed
+ *    sectors may read back an older content. This suits file systems,
+ *    which trim free clusters only.
+ *
+ * \param    ftl   Pointer to FTL to use
+ * \param sector   The first sector
+ * \param  count   Number of sectors
+ *
+ * \return The status of the operation.
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_trim (s25fs_ftl_t *ftl, int sector, int count)
+{
+   uint32_t p;
+
+   if (ftl->status != DRV_READY || sector < 0 || count < 0
+       || (uint32_t)sector + count > ftl->sectors)
+      return DRV_ERROR;
+   for ( ; count ; ++sector, --count) {
+      if ((p = ftl->map[sector]) != S25FS_FTL_UNMAPPED) {
+         --ftl->blk[p / ftl->slots].valid;
+         ftl->map[sector] = S25FS_FTL_UNMAPPED;
+      }
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    S25FS FTL ioctl function
+ *
+ * \param   ftl   Pointer to FTL to use
+ * \param  ctrl   specifies the command to FTL and get back the reply.
+ *    \arg CTRL_GET_STATUS
+ *    \arg CTRL_DEINIT
+ *    \arg CTRL_SYNC             Nothing is buffered, returns ready
+ *    \arg CTRL_GET_SECTOR_COUNT
+ *    \arg CTRL_GET_SECTOR_SIZE
+ *    \arg CTRL_GET_BLOCK_SIZE   Returns 1, there is no erase alignment to keep
+ *    \arg CTRL_ERASE_SECTOR     Trim, buf points to the start and end sectors (uint32_t[2])
+ *    \arg CTRL_FORMAT
+ * \param   buf   Pointer to buffer for ioctl
+ *
+ * \return The status of the operation
+ *    \arg DRV_READY
+ *    \arg DRV_ERROR
+ */
+drv_status_en s25fs_ftl_ioctl (s25fs_ftl_t *ftl, ioctl_cmd_t ctrl, ioctl_buf_t buf)
+{
+   switch (ctrl)
+   {
+      case CTRL_GET_STATUS:
+         if (buf)
+            *(drv_status_en*)buf = ftl->status;
+         return DRV_READY;
+      case CTRL_DEINIT:
+         s25fs_ftl_deinit (ftl);
+         return DRV_READY;
+      case CTRL_SYNC:
+         return (ftl->status == DRV_READY) ? DRV_READY : DRV_ERROR;
+      case CTRL_GET_SECTOR_COUNT:
+         if (!buf)   return DRV_ERROR;
+         *(uint32_t*)buf = ftl->sectors;
+         return DRV_READY;
+      case CTRL_GET_SECTOR_SIZE:
+         if (!buf)   return DRV_ERROR;
+         *(uint16_t*)buf = (uint16_t)_sect_sz (ftl);
+         return DRV_READY;
+      case CTRL_GET_BLOCK_SIZE:
+         if (!buf)   return DRV_ERROR;
+         *(uint32_t*)buf = 1;
+         return DRV_READY;
+      case CTRL_ERASE_SECTOR:
+         if (!buf)   return DRV_ERROR;
+         return s25fs_ftl_trim (ftl, ((uint32_t*)buf)[0],
+                                ((uint32_t*)buf)[1] - ((uint32_t*)buf)[0] + 1);
+      case CTRL_FORMAT:
+         return s25fs_ftl_format (ftl);
+      default:
+         return DRV_ERROR;
+   }
+}
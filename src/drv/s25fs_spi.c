@@ -243,6 +243,9 @@ static int _writepage (s25fs_t *drv, s25fs_idx_t idx, byte_t *buf, int n)
 
    if ( !_wait_ready (drv) )
       return -1;
+   // The flash clears the write enable latch after each program
+   if ( _cmd_WREN (drv) != DRV_READY )
+      return -1;
 
    if ( _write (drv, S25FS_PP_4B_CMD, idx, 4, buf, nl) != DRV_READY )
       return -1;
@@ -472,8 +475,6 @@ drv_status_en s25fs_write (s25fs_t *drv, s25fs_idx_t idx, s25fs_data_t *buf, int
    int      ret;
 
    if (drv->io.wp)   drv->io.wp (S25FS_DIS);
-   if ( _cmd_WREN (drv) != DRV_READY )
-      return DRV_ERROR;
 
    do {
       ret = _writepage (drv, idx+wb, &buf[wb], count-wb);
@@ -42,6 +42,8 @@ static void     _select (int drv, uint8_t on);
 static sd_dat_t _spi_rw (int drv, sd_dat_t out);
 static void     _spi_tx (int drv, sd_dat_t d);
 static sd_dat_t _spi_rx (int drv);
+static uint8_t  _spi_rx_block (int drv, sd_dat_t *buf, uint32_t n);
+static uint8_t  _spi_tx_block (int drv, const sd_dat_t *buf, uint32_t n);
 static sd_dat_t _wait_ready (int drv);
 static void     _release (int drv);
 static drv_status_en _spi_deinit (int drv);
@@ -50,11 +52,24 @@ static drv_status_en _power (int drv, uint8_t on);
 static uint8_t  _rx_datablock (int drv, sd_dat_t *buf, uint32_t n);
 static uint8_t  _tx_datablock (int drv, const sd_dat_t *buf, sd_dat_t token);
 static sd_dat_t _send_command (int drv, sd_dat_t cmd, uint32_t arg);
+static size_t   _read_blocks (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count);
+static size_t   _write_blocks (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count);
+static void     _stream_close (int drv);
+static void     _req_done (int drv, drv_status_en st);
+static drv_status_en _submit (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count, uint8_t write, sd_done_ft done, void *ctx);
 
 /*
  * tools
  */
 #define _bad_drive(_dr)    ((_dr)<0 || (_dr)>=SD_NUMBER_OF_DRIVES) ? 1:0
+#define _sd_addr(_dr, _s)  ((sd.drive[_dr].type & CT_BLOCK) ? (_s) : (_s)*512)
+
+/*
+ * Asynchronous queue transaction states
+ */
+#define _SDQ_IDLE       (0)   /*!< No open transaction */
+#define _SDQ_READ       (1)   /*!< Open READ_MULTIPLE_BLOCK */
+#define _SDQ_WRITE      (2)   /*!< Open WRITE_MULTIPLE_BLOCK */
 
 /*!
  * \brief
@@ -214,6 +229,48 @@ static inline sd_dat_t _spi_rx (int drv) {
    return (sd_dat_t) _spi_rw (drv, 0xFF);
 }
 
+/*!
+ * \brief
+ *    Receive a block of bytes from SD/MMC via SPI. Uses the linked
+ *    block function if any, or the byte function.
+ *
+ * \param   drv   The number of physical drive.
+ * \param   buf   Pointer to buffer to store the data
+ * \param   n     Byte count
+ * \return        The operation status
+ *    \arg  0     Fail
+ *    \arg  1     Success.
+ */
+static uint8_t _spi_rx_block (int drv, sd_dat_t *buf, uint32_t n)
+{
+   if (sd.sd_io[drv].spi_rx_block)
+      return (sd.sd_io[drv].spi_rx_block (sd.sd_io[drv].spi, buf, n) == DRV_READY) ? 1:0;
+   for ( ; n ; --n)
+      *buf++ = _spi_rw (drv, 0xFF);
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Transmit a block of bytes to SD/MMC via SPI. Uses the linked
+ *    block function if any, or the byte function.
+ *
+ * \param   drv   The number of physical drive.
+ * \param   buf   Pointer to the data to send
+ * \param   n     Byte count
+ * \return        The operation status
+ *    \arg  0     Fail
+ *    \arg  1     Success.
+ */
+static uint8_t _spi_tx_block (int drv, const sd_dat_t *buf, uint32_t n)
+{
+   if (sd.sd_io[drv].spi_tx_block)
+      return (sd.sd_io[drv].spi_tx_block (sd.sd_io[drv].spi, buf, n) == DRV_READY) ? 1:0;
+   for ( ; n ; --n)
+      _spi_rw (drv, *buf++);
+   return 1;
+}
+
 
 /*!
  * \brief
@@ -330,13 +387,13 @@ static drv_status_en _power (int drv, uint8_t on)
  * \param   buf   Pointer to data buffer to store received data
  * \param   n     Byte count (must be multiple of 4)
  * \return        The operation status
- *    \arg  0     Fail
+ *    \arg  0     Fail, or CRC error in CRC mode
  *    \arg  1     Success.
  */
 static uint8_t _rx_datablock (int drv, sd_dat_t *buf, uint32_t n)
 {
-   #define _spi_rx_m(_data)   *(_data)=_spi_rw (drv, 0xFF)
    sd_dat_t token;
+   uint16_t crc;
 
    /*!
     * Wait for data packet in timeout of \sa SD_RX_TIMEOUT
@@ -353,13 +410,14 @@ static uint8_t _rx_datablock (int drv, sd_dat_t *buf, uint32_t n)
     * Receive the data block into buffer and make sure
     * we receive multiples of 4
     */
-   for (n+=(n%4) ? 4-(n%4):0 ; n>0 ; --n)
-      _spi_rx_m (buf++);
-
-   _spi_rw (drv, 0xFF);  // Discard CRC
-   _spi_rw (drv, 0xFF);
+   n += (n%4) ? 4-(n%4):0;
+   if (!_spi_rx_block (drv, buf, n))
+      return 0;
 
-   #undef _spi_rx_m
+   crc = (uint16_t)_spi_rx (drv) << 8;    // CRC16, MSB first
+   crc |= _spi_rx (drv);
+   if (sd.drive[drv].crc && crc != CRC16_CCITT_buffer (0, buf, n))
+      return 0;
    return 1;
 }
 
@@ -371,15 +429,14 @@ static uint8_t _rx_datablock (int drv, sd_dat_t *buf, uint32_t n)
  * \param   buf   Pointer to 512 byte data block to be transmitted
  * \param   token Data/Stop token
  * \return        The operation status
- *    \arg  0     Fail
+ *    \arg  0     Fail, or CRC error reported by the card
  *    \arg  1     Success.
  */
 static uint8_t _tx_datablock (int drv, const sd_dat_t *buf, sd_dat_t token)
 {
-   #define _spi_txb_m(_data)   _spi_rw (drv, *(_data))
    #define _spi_tx_m(_data)    _spi_rw (drv, (_data))
    sd_dat_t r;
-   int wc=512;
+   uint16_t crc = 0xFFFF;
 
    if (_wait_ready (drv) != 0xFF)
       return 0;
@@ -390,12 +447,13 @@ static uint8_t _tx_datablock (int drv, const sd_dat_t *buf, sd_dat_t token)
        * If is data token  transmit the 512 byte
        * data block to MMC/SD
        */
-      do
-         _spi_txb_m (buf++);
-      while (--wc);
+      if (sd.drive[drv].crc)
+         crc = CRC16_CCITT_buffer (0, buf, 512);
+      if (!_spi_tx_block (drv, buf, 512))
+         return 0;
 
-      _spi_tx_m (0xFF);          // CRC (Dummy)
-      _spi_tx_m (0xFF);
+      _spi_tx_m ((sd_dat_t)(crc >> 8));   // CRC, dummy if not in CRC mode
+      _spi_tx_m ((sd_dat_t)crc);
       r = _spi_rx (drv);          // Receive data response
       if ((r & 0x1F) != 0x05)    // If not accepted, return with error
          return 0;
@@ -403,7 +461,6 @@ static uint8_t _tx_datablock (int drv, const sd_dat_t *buf, sd_dat_t token)
 
    return 1;
 
-   #undef _spi_txb_m
    #undef _spi_tx_m
 }
 
@@ -421,7 +478,7 @@ static uint8_t _tx_datablock (int drv, const sd_dat_t *buf, sd_dat_t token)
 static sd_dat_t _send_command (int drv, sd_dat_t cmd, uint32_t arg)
 {
    #define _spi_tx_m(_data)    _spi_rw (drv, (_data))
-   sd_dat_t n, r;
+   sd_dat_t n, r, pkt[5];
 
    if (cmd & 0x80) {
       /*!
@@ -440,15 +497,15 @@ static sd_dat_t _send_command (int drv, sd_dat_t cmd, uint32_t arg)
       return 0xFF;      // Don't return the error
 
    // Send command packet
-   _spi_tx_m (cmd);                 // Start + Command index
-   _spi_tx_m ((sd_dat_t)(arg>>24)); // Argument [31..24]
-   _spi_tx_m ((sd_dat_t)(arg>>16)); // Argument [23..16]
-   _spi_tx_m ((sd_dat_t)(arg>>8));  // Argument [15..8]
-   _spi_tx_m ((sd_dat_t)arg);       // Argument [7..0]
-   n = 0x01;                        // Dummy CRC + Stop
-   if (cmd == SD_CMD0) n = 0x95;    // Valid CRC for SD_CMD0(0)
-   if (cmd == SD_CMD8) n = 0x87;    // Valid CRC for SD_CMD8(0x1AA)
-   _spi_tx_m (n);
+   pkt[0] = cmd;                    // Start + Command index
+   pkt[1] = (sd_dat_t)(arg>>24);    // Argument [31..24]
+   pkt[2] = (sd_dat_t)(arg>>16);    // Argument [23..16]
+   pkt[3] = (sd_dat_t)(arg>>8);     // Argument [15..8]
+   pkt[4] = (sd_dat_t)arg;          // Argument [7..0]
+   for (n=0 ; n<5 ; ++n)
+      _spi_tx_m (pkt[n]);
+   // Valid CRC + Stop. Required by CMD0, CMD8 and by all in CRC mode
+   _spi_tx_m ((sd_dat_t)(CRC7_MMC_buffer (0, pkt, 5) << 1) | 0x01);
 
    // Receive command response
    if (cmd == SD_CMD12)
@@ -464,6 +521,153 @@ static sd_dat_t _send_command (int drv, sd_dat_t cmd, uint32_t arg)
    #undef _spi_tx_m
 }
 
+/*!
+ * \brief
+ *    Read a run of sectors in one transaction.
+ *
+ * \param   drv    The number of physical drive.
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data buffer to store read data
+ * \param   count  Sector (512 bytes) count
+ * \return  The number of sectors read successfully
+ */
+static size_t _read_blocks (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count)
+{
+   size_t n = 0;
+
+   if (count == 1) { //Single block read
+      if (_send_command (drv, SD_CMD17, _sd_addr (drv, sector)) == 0    // READ_SINGLE_BLOCK
+         && _rx_datablock (drv, buf, 512))
+         n = 1;
+   } else {          // Multiple block read
+      if (_send_command (drv, SD_CMD18, _sd_addr (drv, sector)) == 0) { // READ_MULTIPLE_BLOCK
+         for ( ; n<count && _rx_datablock (drv, buf, 512) ; ++n)
+            buf += 512;
+         _send_command (drv, SD_CMD12, 0);                              // STOP_TRANSMISSION
+      }
+   }
+   return n;
+}
+
+/*!
+ * \brief
+ *    Write a run of sectors in one transaction.
+ *
+ * \param   drv    The number of physical drive.
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data to be written
+ * \param   count  Sector (512 bytes) count
+ * \return  The number of sectors accepted by the card
+ */
+static size_t _write_blocks (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count)
+{
+   size_t n = 0;
+
+   if (count == 1) {    // Single block write
+      if (_send_command (drv, SD_CMD24, _sd_addr (drv, sector)) == 0   // WRITE_BLOCK
+         && _tx_datablock (drv, buf, 0xFE))
+         n = 1;
+   } else {             // Multiple block write
+      if (sd.drive[drv].type & CT_SDC)
+         _send_command (drv, SD_ACMD23, count);
+      if (_send_command (drv, SD_CMD25, _sd_addr (drv, sector)) == 0) { // WRITE_MULTIPLE_BLOCK
+         for ( ; n<count && _tx_datablock (drv, buf, 0xFC) ; ++n)
+            buf += 512;
+         if (!_tx_datablock (drv, 0, 0xFD) && n)                      // STOP_TRAN token
+            --n;     // The last block is not confirmed
+      }
+   }
+   return n;
+}
+
+/*!
+ * \brief
+ *    Close the open multi block transaction of the asynchronous queue, if any.
+ *    The card may be busy afterwards, so the queue polls it before the next
+ *    transfer.
+ *
+ * \param   drv   The number of physical drive.
+ * \return        None.
+ */
+static void _stream_close (int drv)
+{
+   sd_queue_t *q = &sd.queue[drv];
+
+   if (q->state == _SDQ_READ)
+      _send_command (drv, SD_CMD12, 0);   // STOP_TRANSMISSION
+   else if (q->state == _SDQ_WRITE)
+      _tx_datablock (drv, 0, 0xFD);       // STOP_TRAN token
+   else
+      return;
+   q->state = _SDQ_IDLE;
+   q->busy = 1;
+   q->tb = SD_WAIT_TIMEOUT;
+}
+
+/*!
+ * \brief
+ *    Remove the head request from the asynchronous queue and call its
+ *    completion callback. The request slot is free before the callback,
+ *    so the callback can submit the next request.
+ *
+ * \param   drv   The number of physical drive.
+ * \param   st    The request's status.
+ * \return        None.
+ */
+static void _req_done (int drv, drv_status_en st)
+{
+   sd_queue_t *q = &sd.queue[drv];
+   sd_done_ft done = q->req[q->tail].done;
+   void *ctx = q->req[q->tail].ctx;
+
+   q->tail = (q->tail + 1) % SD_QUEUE_SIZE;
+   --q->cnt;
+   q->blk = 0;
+   if (done)
+      done (drv, ctx, st);
+}
+
+/*!
+ * \brief
+ *    Queue an asynchronous request.
+ *
+ * \param   drv    The number of physical drive.
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the request's data buffer
+ * \param   count  Sector (512 bytes) count
+ * \param   write  Write request flag
+ * \param   done   Completion callback, or NULL
+ * \param   ctx    Completion callback's context
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On invalid request.
+ *    \arg  DRV_BUSY    The queue is full.
+ *    \arg  DRV_READY   The request is queued.
+ */
+static drv_status_en _submit (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count, uint8_t write, sd_done_ft done, void *ctx)
+{
+   sd_queue_t *q;
+   volatile sd_req_t *r;
+
+   if (_bad_drive(drv))             return DRV_ERROR;
+   if (!buf || !count)              return DRV_ERROR;
+   if (sd.drive[drv].status != DRV_READY)
+      return DRV_ERROR;
+   q = &sd.queue[drv];
+   if (q->cnt >= SD_QUEUE_SIZE)
+      return DRV_BUSY;
+
+   r = &q->req[q->head];
+   r->buf = buf;
+   r->sector = sector;
+   r->count = count;
+   r->write = write;
+   r->done = done;
+   r->ctx = ctx;
+   q->head = (q->head + 1) % SD_QUEUE_SIZE;
+   ++q->cnt;
+   return DRV_READY;
+}
+
 
 
 /*============================   Public Functions   ============================ */
@@ -502,12 +706,59 @@ inline void sd_link_spi_rw (int drv, spi_rw_t fun) {
       return;
    sd.sd_io[drv].spi_rw = fun;
 }
+inline void sd_link_spi_rx_block (int drv, spi_rx_block_t fun) {
+   if (_bad_drive(drv))
+      return;
+   sd.sd_io[drv].spi_rx_block = fun;
+}
+inline void sd_link_spi_tx_block (int drv, spi_tx_block_t fun) {
+   if (_bad_drive(drv))
+      return;
+   sd.sd_io[drv].spi_tx_block = fun;
+}
 inline void sd_link_spi (int drv, void* spi) {
    if (_bad_drive(drv))
       return;
    sd.sd_io[drv].spi = spi;
 }
 
+/*
+ * Set functions
+ */
+
+/*!
+ * \brief
+ *    Enable or disable the CRC mode (CMD59). In CRC mode the driver
+ *    generates CRC16 for written data blocks, verifies the CRC16 of
+ *    received ones and retries failed transfers up to \a SD_CRC_RETRIES times.
+ * \note
+ *    If the drive is not initialised, the mode is applied by sd_init().
+ *
+ * \param   drv   The number of physical drive.
+ * \param   on    CRC mode flag.
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en sd_set_crc (int drv, uint8_t on)
+{
+   sd_dat_t r;
+
+   if (_bad_drive(drv))
+      return DRV_ERROR;
+   if (sd.drive[drv].status != DRV_READY) {
+      sd.drive[drv].crc = (on) ? 1:0;
+      return DRV_READY;
+   }
+   _stream_close (drv);
+   r = _send_command (drv, SD_CMD59, (on) ? 1:0);   // CRC_ON_OFF
+   _release (drv);
+   if (r != 0)
+      return DRV_ERROR;
+   sd.drive[drv].crc = (on) ? 1:0;
+   return DRV_READY;
+}
+
 /*
  * User Functions
  */
@@ -529,6 +780,8 @@ void sd_service (void)
       // Time base decrement timers
       if (sd.drive[i].t1)     --sd.drive[i].t1;
       if (sd.drive[i].t2)     --sd.drive[i].t2;
+      if (sd.queue[i].tb)     --sd.queue[i].tb;
+      if (sd.queue[i].ti)     --sd.queue[i].ti;
 
       // Get current status
       if (pr[i] == 1 && !_is_present (i)) {
@@ -553,9 +806,12 @@ void sd_deinit (int drv)
 {
    if (_bad_drive(drv))
       return;
+   if (sd.drive[drv].status == DRV_READY)
+      _stream_close (drv);
    _power (drv, 0);
    memset ((void*)&sd.sd_io[drv], 0, sizeof (sd_io_t));
    memset ((void*)&sd.drive[drv], 0, sizeof (sd_data_t));
+   memset ((void*)&sd.queue[drv], 0, sizeof (sd_queue_t));
    /*!<
     * This leaves the status = DRV_NOINIT
     */
@@ -584,6 +840,8 @@ drv_status_en sd_init (int drv)
    if (_bad_link(spi_ioctl))  return DRV_ERROR;
    if (_bad_link(spi_rw))     return DRV_ERROR;
 
+   sd.queue[drv].state = _SDQ_IDLE;          // Any open transaction is lost
+   sd.queue[drv].busy = 0;
    _power_pin (drv, 0);                      // Initially power off the card
    if (!_is_present (drv)) {                 // No card in the socket
       sd.drive[drv].status = DRV_NODEV;
@@ -636,6 +894,8 @@ drv_status_en sd_init (int drv)
             type = 0;
       }
    }
+   if (type && sd.drive[drv].crc && _send_command (drv, SD_CMD59, 1) != 0)
+      sd.drive[drv].crc = 0;                 // No CRC support
    sd.drive[drv].type = type;
    _release (drv);    // Initialisation ended
 
@@ -696,28 +956,23 @@ inline drv_status_en sd_setstatus (int drv, drv_status_en st) {
  */
 drv_status_en sd_read (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count)
 {
+   size_t n;
+   int retry;
+
    if (_bad_drive(drv))             return DRV_ERROR;
    if (!count)                      return DRV_ERROR;
    if (sd.drive[drv].status != DRV_READY)
       return DRV_ERROR;
 
+   _stream_close (drv);
    sd.drive[drv].status = DRV_BUSY;
-   if (!(sd.drive[drv].type & CT_BLOCK)) // Convert to byte address if needed
-      sector *= 512;
-
-   if (count == 1) { //Single block read
-      if (_send_command (drv, SD_CMD17, sector) == 0)     // READ_SINGLE_BLOCK
-         if (_rx_datablock (drv, buf, 512))
-            count = 0;
-   } else {          // Multiple block read
-      if (_send_command (drv, SD_CMD18, sector) == 0) {   // READ_MULTIPLE_BLOCK
-         do {
-            if (!_rx_datablock (drv, buf, 512))
-               break;
-            buf += 512;
-         } while (--count);
-         _send_command (drv, SD_CMD12, 0);                // STOP_TRANSMISSION
-      }
+   // In CRC mode retry from the failed sector
+   for (retry = (sd.drive[drv].crc) ? SD_CRC_RETRIES : 0 ; ; --retry) {
+      n = _read_blocks (drv, sector, buf, count);
+      sector += n;
+      buf += 512*n;
+      if (!(count -= n) || !retry)
+         break;
    }
    _release (drv);
    return (drv_status_en) (sd.drive[drv].status = count ? DRV_ERROR : DRV_READY);
@@ -737,32 +992,24 @@ drv_status_en sd_read (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count)
  */
 drv_status_en sd_write (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count)
 {
+   size_t n;
+   int retry;
+
    if (_bad_drive(drv))             return DRV_ERROR;
    if (_is_write_protected (drv))   return DRV_ERROR;
    if (!count)                      return DRV_ERROR;
    if (sd.drive[drv].status != DRV_READY)
       return DRV_ERROR;
 
+   _stream_close (drv);
    sd.drive[drv].status = DRV_BUSY;
-   if (!(sd.drive[drv].type & CT_BLOCK)) // Convert to byte address if needed
-      sector *= 512;
-
-   if (count == 1) {    // Single block write
-      if ((_send_command (drv, SD_CMD24, sector) == 0) // WRITE_BLOCK
-         && _tx_datablock (drv, buf, 0xFE))
-         count = 0;
-   } else {             // Multiple block write
-      if (sd.drive[drv].type & CT_SDC)
-         _send_command (drv, SD_ACMD23, count);
-      if (_send_command (drv, SD_CMD25, sector) == 0) { // WRITE_MULTIPLE_BLOCK
-         do {
-            if (!_tx_datablock (drv, buf, 0xFC))
-               break;
-            buf += 512;
-         } while (--count);
-         if (!_tx_datablock (drv, 0, 0xFD)) // STOP_TRAN token
-            count = 1;
-      }
+   // In CRC mode retry from the first not accepted sector
+   for (retry = (sd.drive[drv].crc) ? SD_CRC_RETRIES : 0 ; ; --retry) {
+      n = _write_blocks (drv, sector, buf, count);
+      sector += n;
+      buf += 512*n;
+      if (!(count -= n) || !retry)
+         break;
    }
    _release (drv);
    return (drv_status_en) (sd.drive[drv].status = count ? DRV_ERROR : DRV_READY);
@@ -794,7 +1041,7 @@ drv_status_en sd_write (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t co
 drv_status_en sd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
 {
    drv_status_en res = DRV_ERROR;
-   uint8_t n, csd[16], *ptr = buf;
+   uint8_t n, csd[16], sdstat[64], *ptr = buf;
    uint32_t csize;
 
    if (_bad_drive(drv))
@@ -803,6 +1050,8 @@ drv_status_en sd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
       return DRV_ERROR;
    //if (ctrl != CTRL_POWER && sd.drive[drv].status == DRV_NOINIT)
    //   return DRV_ERROR;
+   if (sd.drive[drv].status == DRV_READY)
+      _stream_close (drv);
 
    switch (ctrl)
    {
@@ -871,10 +1120,8 @@ drv_status_en sd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
             if (_send_command (drv, SD_ACMD13, 0) == 0) {
                /* Read SD status */
                _spi_rx (drv);
-               if (_rx_datablock (drv, csd, 16)) {  /* Read partial block */
-                  for (n = 64 - 16; n; n--)        /* Purge trailing data */
-                     _spi_rx (drv);
-                  *(uint32_t*)buf = 16UL << (csd[10] >> 4);
+               if (_rx_datablock (drv, sdstat, 64)) {  /* Read the whole block for its CRC */
+                  *(uint32_t*)buf = 16UL << (sdstat[10] >> 4);
                   res = DRV_READY;
                }
             }
@@ -929,4 +1176,156 @@ drv_status_en sd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
    return DRV_ERROR;
 }
 
+/*!
+ * \brief
+ *    Queue an asynchronous sector read. The request is served by sd_poll().
+ *
+ * \param   drv    The number of physical drive.
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data buffer to store read data. It must
+ *                 remain valid until completion.
+ * \param   count  Sector (512 bytes) count
+ * \param   done   Completion callback, or NULL
+ * \param   ctx    Completion callback's context
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On invalid request.
+ *    \arg  DRV_BUSY    The queue is full, try again later.
+ *    \arg  DRV_READY   The request is queued.
+ */
+drv_status_en sd_read_async (int drv, sd_idx_t sector, sd_dat_t *buf, size_t count, sd_done_ft done, void *ctx)
+{
+   return _submit (drv, sector, buf, count, 0, done, ctx);
+}
+
+/*!
+ * \brief
+ *    Queue an asynchronous sector write. The request is served by sd_poll().
+ *
+ * \param   drv    The number of physical drive.
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data to be written. It must remain valid
+ *                 until completion.
+ * \param   count  Sector (512 bytes) count
+ * \param   done   Completion callback, or NULL
+ * \param   ctx    Completion callback's context
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On invalid request or write protected card.
+ *    \arg  DRV_BUSY    The queue is full, try again later.
+ *    \arg  DRV_READY   The request is queued.
+ */
+drv_status_en sd_write_async (int drv, sd_idx_t sector, const sd_dat_t *buf, size_t count, sd_done_ft done, void *ctx)
+{
+   if (_bad_drive(drv))             return DRV_ERROR;
+   if (_is_write_protected (drv))   return DRV_ERROR;
+   // The queue never writes to a write request's buffer
+   return _submit (drv, sector, (sd_dat_t*)buf, count, 1, done, ctx);
+}
+
+/*!
+ * \brief
+ *    Serve the asynchronous request queue. Each call transfers at most one
+ *    block and returns while the card is busy programming, so the caller can
+ *    do other work in between.
+ *    Requests to the sector that follows the previous one, in the same
+ *    direction, continue the open READ/WRITE_MULTIPLE_BLOCK transaction.
+ *    The transaction is closed on a non sequential request, after
+ *    \a SD_STREAM_TIMEOUT idle time or by any of the blocking functions.
+ * \note
+ *    Call it from the same context as sd_read_async()/sd_write_async().
+ *
+ * \param   drv   The number of physical drive.
+ * \return  The status of the queue
+ *    \arg  DRV_ERROR   A request failed or the drive is not ready.
+ *    \arg  DRV_BUSY    There is pending work.
+ *    \arg  DRV_READY   The queue is empty.
+ */
+drv_status_en sd_poll (int drv)
+{
+   sd_queue_t *q;
+   volatile sd_req_t *r;
+   sd_idx_t sec;
+   uint8_t st, ok;
+
+   if (_bad_drive(drv))
+      return DRV_ERROR;
+   q = &sd.queue[drv];
+   if (sd.drive[drv].status != DRV_READY) {
+      // Drive is gone or not initialised, fail everything
+      q->state = _SDQ_IDLE;
+      q->busy = 0;
+      while (q->cnt)
+         _req_done (drv, DRV_ERROR);
+      return DRV_ERROR;
+   }
+
+   if (q->busy) {
+      _select (drv, 1);
+      if (_spi_rx (drv) != 0xFF) {
+         if (q->tb)
+            return DRV_BUSY;     // Still programming, come back later
+         q->busy = 0;
+         _stream_close (drv);
+         _release (drv);
+         if (q->cnt)
+            _req_done (drv, DRV_ERROR);
+         return DRV_ERROR;
+      }
+      q->busy = 0;
+      if (q->state == _SDQ_IDLE)
+         _release (drv);
+   }
+
+   if (!q->cnt) {
+      if (q->state != _SDQ_IDLE && !q->ti) {
+         _stream_close (drv);
+         _release (drv);
+      }
+      return (q->busy) ? DRV_BUSY : DRV_READY;
+   }
+
+   r = &q->req[q->tail];
+   st = (r->write) ? _SDQ_WRITE : _SDQ_READ;
+   sec = r->sector + q->blk;
+   if (q->state != st || q->next != sec) {
+      if (q->state != _SDQ_IDLE) {
+         // Not a continuation, close and let the card finish first
+         _stream_close (drv);
+         _release (drv);
+         return DRV_BUSY;
+      }
+      if (_send_command (drv, (st == _SDQ_WRITE) ? SD_CMD25 : SD_CMD18, _sd_addr (drv, sec)) != 0) {
+         _release (drv);
+         _req_done (drv, DRV_ERROR);
+         return DRV_ERROR;
+      }
+      q->state = st;
+   }
+
+   if (st == _SDQ_READ)
+      ok = _rx_datablock (drv, r->buf + 512*q->blk, 512);
+   else {
+      ok = _tx_datablock (drv, r->buf + 512*q->blk, 0xFC);
+      q->busy = 1;
+      q->tb = SD_WAIT_TIMEOUT;
+   }
+   if (!ok) {
+      q->busy = 0;
+      _stream_close (drv);
+      _release (drv);
+      if (sd.drive[drv].crc && q->retry < SD_CRC_RETRIES) {
+         ++q->retry;       // Re-open the transaction on the failed block
+         return DRV_BUSY;
+      }
+      q->retry = 0;
+      _req_done (drv, DRV_ERROR);
+      return DRV_ERROR;
+   }
+   q->retry = 0;
+   q->next = sec + 1;
+   q->ti = SD_STREAM_TIMEOUT;
+   if (++q->blk >= r->count)
+      _req_done (drv, DRV_READY);
+   return (q->cnt || q->busy) ? DRV_BUSY : DRV_READY;
+}
+
 #undef _bad_drive
@@ -27,7 +27,9 @@
 #include <drv/sim_ee.h>
 
 static see_page_en   _valid_page (see_t *see);
+static see_idx_t           _scan (see_t *see, see_idx_t page, uint8_t index);
 static see_idx_t      _find_last (see_t *see, see_idx_t page);
+static void               _index (see_t *see);
 static see_status_en _erase_page (see_t *see, see_idx_t page);
 static see_status_en  _page_swap (see_t *see);
 static see_status_en     _format (see_t *see);
@@ -35,6 +37,7 @@ static see_status_en   _try_read (see_t *see, see_idx_t page, see_idx_t idx, byt
 static see_status_en  _try_write (see_t *see, see_idx_t page, see_idx_t idx, byte_t *word);
 
 static see_status_en  _read_word (see_t *see, see_idx_t idx, byte_t *buf);
+static see_status_en _read_words (see_t *see, see_idx_t idx, byte_t *buf, bytecount_t n);
 static see_status_en _write_word (see_t *see, see_idx_t idx, byte_t *buf);
 
 /*!
@@ -58,83 +61,86 @@ static see_page_en _valid_page (see_t *see)
 
 /*!
  * \brief
- *    Try to find last written address item in flash
+ *    Scan a page forward, a buffer at a time, up to the first empty record.
+ *    Optionally fills the RAM index on the way, so the latest record of
+ *    each word wins.
  *
  * \param  see    The active see struct.
- * \param  page   Which page to seek
- * \return        The flash address of the last written data
+ * \param  page   Which page to scan
+ * \param  index  Fill the RAM index
+ * \return        The flash address of the last written virtual address,
+ *                or the one before the first record if the page is empty.
  */
-static see_idx_t _find_last (see_t *see, see_idx_t page)
+static see_idx_t _scan (see_t *see, see_idx_t page, uint8_t index)
 {
    byte_t      bf[SEE_FIND_LAST_BUFFER_SIZE];
-   see_idx_t   fp;
-   uint32_t    i, pairs, bts;
-   uint32_t    bfp, bfp_next;
-   see_idx_t   *last;
-   uint8_t     seek = 0;
-   static see_idx_t
-               page_cur = (see_idx_t)-1,
-               page_pr  = (see_idx_t)-1;
-
-   // Job filter
-   if (page_cur == (see_idx_t)-1) {
-      // First time
-      page_cur = page;
-      seek = 1;
-      last = (see_idx_t*)&see->last_cur;
-   }
-   else if (page == page_cur) {
-      // Repeat during current read/write
-      seek = 0;
-      last = (see_idx_t*)&see->last_cur;
-   }
-   else {
-      // Not current
-      if (page == page_pr) {
-         // Repeat for "from page" during page swap
-         seek = 0;
-         last = (see_idx_t*)&see->last_pr;
-      }
-      else {
-         // New current page during page swap (seek new page)
-         page_pr = page_cur;
-         page_cur = page;
-         seek = 1;
-         see->last_pr = see->last_cur;
-         last = (see_idx_t*)&see->last_cur;
-      }
-   }
-   if (!seek)
-      return *last;
-   else {
-      // Calculate counters
-      pairs = SEE_FIND_LAST_BUFFER_SIZE / (see->iface.word_size + sizeof (see_idx_t));
-      bts = pairs * (see->iface.word_size + sizeof (see_idx_t));
-      fp = sizeof (see_page_status_en)+page;
-
-      // Loop entire flash page
-      for ( ; fp < page+see->conf.page_size - bts ; fp += (bfp - see->iface.word_size)) {
-         // Load buffer
-         if ( see->io.fl_read (see->io.flash, fp, (void*)bf, bts) != DRV_READY)
-            return *last = 0;
-         // Seek into buffer
-         bfp=0;
-         bfp_next = see->iface.word_size;
-         // One action outside
-         if ( *(see_idx_t*)(bf+bfp_next) == (see_idx_t)-1 )
-            return *last = (see_idx_t)(fp-sizeof (see_idx_t));
-         bfp = bfp_next;
-         bfp_next += see->iface.word_size + sizeof (see_idx_t);
-         // Loop the rest
-         for (i=1 ; i<pairs ; ++i) {
-            if ( *(see_idx_t*)(bf+bfp_next) == (see_idx_t)-1 )
-               return *last = (see_idx_t)(fp+bfp);
-            bfp = bfp_next;
-            bfp_next += see->iface.word_size + sizeof (see_idx_t);
-         }
+   uint32_t    rs = see->iface.word_size + sizeof (see_idx_t);   // Record size
+   uint32_t    pairs = SEE_FIND_LAST_BUFFER_SIZE / rs;
+   see_idx_t   fp = page + sizeof (see_page_status_en);           // The first record
+   see_idx_t   end = page + see->conf.page_size;
+   see_idx_t   last = fp - sizeof (see_idx_t);
+   see_idx_t   i;
+   uint32_t    k, n;
+
+   for ( ; fp + rs <= end ; fp += n*rs) {
+      n = (end - fp) / rs;
+      if (n > pairs)    n = pairs;
+      if ( see->io.fl_read (see->io.flash, fp, (void*)bf, n*rs) != DRV_READY)
+         return last;
+      for (k=0 ; k<n ; ++k) {
+         memcpy ((void*)&i, (const void*)(bf + k*rs + see->iface.word_size), sizeof (see_idx_t));
+         if (i == (see_idx_t)-1)
+            return last;
+         last = fp + k*rs + see->iface.word_size;
+         if (index && i % see->iface.word_size == 0 && i / see->iface.word_size < see->index_size)
+            see->index[i / see->iface.word_size] = fp + k*rs;
       }
-      return *last = 0;
    }
+   return last;
+}
+
+/*!
+ * \brief
+ *    Try to find last written address item in flash. The current page
+ *    and the previous one, the "from" page during page swap, are cached.
+ *
+ * \param  see    The active see struct.
+ * \param  page   Which page to seek
+ * \return        The flash address of the last written data
+ */
+static see_idx_t _find_last (see_t *see, see_idx_t page)
+{
+   if (page == see->page_cur)
+      return see->last_cur;
+   if (page == see->page_pr)
+      return see->last_pr;
+
+   // New current page, seek it
+   see->page_pr = see->page_cur;
+   see->last_pr = see->last_cur;
+   see->page_cur = page;
+   return see->last_cur = _scan (see, page, 0);
+}
+
+/*!
+ * \brief
+ *    Rebuild the last write cache and the RAM index, if any, from
+ *    the valid page.
+ *
+ * \param  see    The active see struct.
+ */
+static void _index (see_t *see)
+{
+   see_idx_t page;
+
+   if ( _valid_page (see) == EE_PAGE0 )   page = see->conf.page0_add;
+   else                                   page = see->conf.page1_add;
+
+   if (see->index)
+      memset ((void*)see->index, 0xFF, see->index_size * sizeof (see_idx_t));
+   see->page_pr = (see_idx_t)-1;
+   see->page_cur = page;
+   see->last_cur = _scan (see, page, see->index != 0);
 }
 
 /*!
@@ -173,8 +179,9 @@ static see_status_en _page_swap (see_t *see)
 {
    see_idx_t     from, to;
    see_page_status_en status;
-   byte_t        data;
+   byte_t        data[SEE_MAX_WORD_SIZE];
    see_idx_t     idx;
+   uint32_t      w;
    see_status_en ee_st = EE_SUCCESS;
  
    // From - To dispatcher
@@ -193,23 +200,46 @@ static see_status_en _page_swap (see_t *see)
    if ( see->io.fl_write (see->io.flash, to, (void*)&status, sizeof(status)) != DRV_READY )
       return EE_FLASHERROR;
 
+   // "from" becomes the previous page and the erased "to" the current one
+   see->last_pr = _find_last (see, from);
+   see->page_pr = from;
+   see->page_cur = to;
+   see->last_cur = to + sizeof (see_page_status_en) - sizeof (see_idx_t);
+
    // Copy each word written on "from" page to their new home
-   for (idx=0 ; idx<see->iface.size ; idx+=see->iface.word_size) {
-      ee_st = _try_read (see, from, idx, &data);
-      if (ee_st == EE_SUCCESS) {
-         ee_st = _try_write (see, to, idx, &data);
-         if (ee_st != EE_SUCCESS)
+   if (see->index) {
+      // The index has the latest records, no need to search them
+      for (w=0 ; w<see->index_size ; ++w) {
+         if (see->index[w] == (see_idx_t)-1)
+            continue;
+         if ( see->io.fl_read (see->io.flash, see->index[w], (void*)data, see->iface.word_size) != DRV_READY) {
+            ee_st = EE_FLASHERROR;
             break;
-      } else if (ee_st == EE_NODATA)
-         continue;
-      else
-         break;
+         }
+         if ((ee_st = _try_write (see, to, w*see->iface.word_size, data)) != EE_SUCCESS)
+            break;
+      }
+   }
+   else {
+      for (idx=0 ; idx<see->iface.size ; idx+=see->iface.word_size) {
+         ee_st = _try_read (see, from, idx, data);
+         if (ee_st == EE_SUCCESS) {
+            ee_st = _try_write (see, to, idx, data);
+            if (ee_st != EE_SUCCESS)
+               break;
+         } else if (ee_st == EE_NODATA)
+            continue;
+         else
+            break;
+      }
    }
    // Catch exit status
    switch (ee_st) {
       case EE_EEFULL:
       case EE_PAGEFULL:
-      case EE_FLASHERROR:  return ee_st;
+      case EE_FLASHERROR:
+         _index (see);     // "from" is still the valid page
+         return ee_st;
       case EE_NODATA:
       case EE_SUCCESS:     break;
    }
@@ -355,6 +385,8 @@ static see_status_en _try_write (see_t *see, see_idx_t page, see_idx_t idx, byte
    ee_st = EE_SUCCESS;  //Try that or prove otherwise
    if ( see->io.fl_write (see->io.flash, fp, (void*)word, see->iface.word_size) != DRV_READY )
       ee_st = EE_FLASHERROR;
+   if (see->index && ee_st == EE_SUCCESS && idx / see->iface.word_size < see->index_size)
+      see->index[idx / see->iface.word_size] = fp;
    fp += see->iface.word_size;
    if ( see->io.fl_write (see->io.flash, fp, (void*)&idx, sizeof(see_idx_t)) != DRV_READY )
       ee_st = EE_FLASHERROR;
@@ -378,6 +410,15 @@ static see_status_en _read_word (see_t *see, see_idx_t idx, byte_t *word)
 {
    see_idx_t page;
 
+   if (see->index) {
+      // Straight from the index
+      if (idx / see->iface.word_size >= see->index_size
+          || (page = see->index[idx / see->iface.word_size]) == (see_idx_t)-1)
+         return EE_NODATA;
+      if ( see->io.fl_read (see->io.flash, page, (void *)word, see->iface.word_size) != DRV_READY)
+         return EE_FLASHERROR;
+      return EE_SUCCESS;
+   }
    // From - To dispatcher
    if ( _valid_page (see) == EE_PAGE0 )   page = see->conf.page0_add;
    else                                   page = see->conf.page1_add;
@@ -385,6 +426,55 @@ static see_status_en _read_word (see_t *see, see_idx_t idx, byte_t *word)
    return _try_read (see, page, idx, word);
 }
 
+/*!
+ * \brief
+ *    Read \a n consecutive aligned words. With the RAM index, words with
+ *    consecutive records in flash, as a page swap leaves them, are read
+ *    with a single flash read per buffer. Words with no data leave their
+ *    place in \a buf untouched.
+ *
+ * \param  see    The active see struct.
+ * \param  idx    The virtual address(index) of the first word
+ * \param  buf    Pointer to data
+ * \param  n      The number of words
+ * \return        The status of operation
+ *    \arg EE_SUCCESS
+ *    \arg EE_FLASHERROR
+ */
+static see_status_en _read_words (see_t *see, see_idx_t idx, byte_t *buf, bytecount_t n)
+{
+   byte_t      bf[SEE_FIND_LAST_BUFFER_SIZE];
+   uint32_t    rs = see->iface.word_size + sizeof (see_idx_t);   // Record size
+   uint32_t    pairs = SEE_FIND_LAST_BUFFER_SIZE / rs;
+   uint32_t    w;
+   see_idx_t   fp;
+   bytecount_t k, run;
+
+   for ( ; n ; n -= run, idx += run*see->iface.word_size, buf += run*see->iface.word_size) {
+      w = idx / see->iface.word_size;
+      run = 1;
+      if (!see->index || w >= see->index_size || (fp = see->index[w]) == (see_idx_t)-1) {
+         if (_read_word (see, idx, buf) == EE_FLASHERROR)
+            return EE_FLASHERROR;
+         continue;
+      }
+      // Find the run of consecutive records
+      while (run < n && run < pairs && w + run < see->index_size
+             && see->index[w + run] == fp + run*rs)
+         ++run;
+      if (run == 1) {
+         if ( see->io.fl_read (see->io.flash, fp, (void *)buf, see->iface.word_size) != DRV_READY)
+            return EE_FLASHERROR;
+         continue;
+      }
+      if ( see->io.fl_read (see->io.flash, fp, (void *)bf, run*rs - sizeof (see_idx_t)) != DRV_READY)
+         return EE_FLASHERROR;
+      for (k=0 ; k<run ; ++k)
+         memcpy ((void *)(buf + k*see->iface.word_size), (const void *)(bf + k*rs), see->iface.word_size);
+   }
+   return EE_SUCCESS;
+}
+
 /*!
  * \brief
  *    Try to write a single word data to EEPROM pointed by buf.
@@ -559,6 +649,21 @@ void see_set_sector_size (see_t *see, uint32_t size) {
    see->iface.sector_size = size;
 }
 
+/*!
+ * \brief
+ *    Set the optional RAM index. It holds the flash address of the latest
+ *    record of each word, so reads need no page search. It is rebuilt by
+ *    see_init(), so set it before.
+ * \param   see   The active see struct.
+ * \param index   Pointer to the index memory, or NULL to disable it
+ * \param  size   The number of entries, at least SEE_INDEX_SIZE(page_size, word_size)
+ * \return none
+ */
+void see_set_index (see_t *see, see_idx_t *index, uint32_t size) {
+   see->index = index;
+   see->index_size = (index) ? size : 0;
+}
+
 /*
  * User Functions
  */
@@ -611,7 +716,10 @@ drv_status_en see_init (see_t *see)
    if (!see->io.fl_write)  return see->status = DRV_ERROR;
 
    see->iface.size = (see->conf.page_size / (see->iface.word_size + sizeof(see_idx_t))) * see->iface.word_size;
+   if (see->index && see->index_size < SEE_INDEX_SIZE (see->conf.page_size, see->iface.word_size))
+      return see->status = DRV_ERROR;
    see->last_cur = see->last_pr = (see_idx_t)-1;
+   see->page_cur = see->page_pr = (see_idx_t)-1;
 
    /*!
     * \note
@@ -621,53 +729,48 @@ drv_status_en see_init (see_t *see)
    see->io.fl_read (see->io.flash, see->conf.page0_add, &pg0_st, sizeof (see_page_status_en));
    see->io.fl_read (see->io.flash, see->conf.page1_add, &pg1_st, sizeof (see_page_status_en));
 
+   drv_st = DRV_READY;     //Try that or prove otherwise
    if (pg0_st == pg1_st) {
       //Invalid state, Format
       _format (see);
-      see->status = DRV_READY;
-      return see->status;
    }
    /*
     *  Normal state. Do nothing
     */
-   else if (pg0_st == EE_PAGE_ACTIVE && pg1_st == EE_PAGE_EMPTY) {
-      see->status = DRV_READY;
-      return see->status;
-   }
-   else if (pg0_st == EE_PAGE_EMPTY && pg1_st == EE_PAGE_ACTIVE) {
-      see->status = DRV_READY;
-      return see->status;
-   }
+   else if (pg0_st == EE_PAGE_ACTIVE && pg1_st == EE_PAGE_EMPTY)
+      ;
+   else if (pg0_st == EE_PAGE_EMPTY && pg1_st == EE_PAGE_ACTIVE)
+      ;
    /*
     * Power failure during PageSwap just before marking ACTIVE the new page.
     * We just mark as active the new page.
     */
    else if (pg0_st == EE_PAGE_RECEIVEDATA && pg1_st == EE_PAGE_EMPTY) {
-      drv_st = DRV_READY;     //Try that or prove otherwise
       page_st = EE_PAGE_ACTIVE;
       if ( see->io.fl_write (see->io.flash, see->conf.page0_add, (void*)&page_st, sizeof(page_st)) != DRV_READY)
          drv_st = DRV_ERROR;
-      return (see->status = drv_st);
    }
    else if (pg0_st == EE_PAGE_EMPTY && pg1_st == EE_PAGE_RECEIVEDATA) {
-      drv_st = DRV_READY;     //Try that or prove otherwise
       page_st = EE_PAGE_ACTIVE;
       if ( see->io.fl_write (see->io.flash, see->conf.page1_add, &page_st, sizeof(page_st)) != DRV_READY)
          drv_st = DRV_ERROR;
-      return (see->status = drv_st);
    }
    /*
     * Power failure during PageSwap before finishing the copy.
     * The data are intact in old page (Still active).
     * We Re-call the page swap procedure.
     */
-   else if (pg0_st == EE_PAGE_ACTIVE && pg1_st == EE_PAGE_RECEIVEDATA)
-      ee_st = _page_swap (see);
-   else if (pg0_st == EE_PAGE_RECEIVEDATA && pg1_st == EE_PAGE_ACTIVE)
+   else if ((pg0_st == EE_PAGE_ACTIVE && pg1_st == EE_PAGE_RECEIVEDATA)
+         || (pg0_st == EE_PAGE_RECEIVEDATA && pg1_st == EE_PAGE_ACTIVE)) {
+      _index (see);
       ee_st = _page_swap (see);
+   }
+   if (drv_st != DRV_READY || ee_st != EE_SUCCESS)
+      return see->status = DRV_ERROR;
 
-   if (ee_st == EE_SUCCESS)   return see->status = DRV_READY;
-   else                       return see->status = DRV_ERROR;
+   // One page scan here, so reads and writes need no search after
+   _index (see);
+   return see->status = DRV_READY;
 }                                      
 
 
@@ -688,7 +791,7 @@ drv_status_en see_read (see_t *see, see_idx_t idx, byte_t *buf, bytecount_t size
 {
    see_idx_t   fl_idx;     // Index counters
    uint8_t     ofs_idx;
-   bytecount_t i, words;   // Word counters
+   bytecount_t words;      // Word counters
    uint8_t rem;
    uint8_t n;              // helper variable
    byte_t bf[SEE_MAX_WORD_SIZE];  // Buffer for not-aligned data
@@ -724,13 +827,13 @@ drv_status_en see_read (see_t *see, see_idx_t idx, byte_t *buf, bytecount_t size
    rem = size % see->iface.word_size;        // How many remaining bytes
 
    // Read aligned data
-   for (i=0 ; i<words ; ++i) {
-      if ( _read_word (see, fl_idx, buf) == EE_FLASHERROR ) {
+   if (words) {
+      if ( _read_words (see, fl_idx, buf, words) == EE_FLASHERROR ) {
          see->status = DRV_READY;
          return DRV_ERROR;
       }
-      buf += see->iface.word_size;
-      fl_idx += see->iface.word_size;
+      buf += words * see->iface.word_size;
+      fl_idx += words * see->iface.word_size;
    }
    // Read remaining unaligned data
    if (rem) {
@@ -867,7 +970,8 @@ drv_status_en see_ioctl (see_t *see, ioctl_cmd_t cmd, ioctl_buf_t buf)
          return see->status = DRV_READY;
       case CTRL_FORMAT:          /*!< Format flash */
          if (_format(see) == EE_FLASHERROR ) return see->status = DRV_ERROR;
-         else                                return see->status = DRV_READY;
+         _index (see);     // Drop the index and cursors of the old page
+         return see->status = DRV_READY;
       default:                   /*!< Unsupported command, error */
          return DRV_ERROR;
 
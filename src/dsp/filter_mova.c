@@ -56,12 +56,25 @@
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_d (fir_ma_d_t* f, double fc)
+uint32_t fir_ma_init_d (fir_ma_d_t* f, double fc) {
+   return fir_ma_init_alc_d (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_d (fir_ma_d_t* f, double fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(double))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(double))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -79,12 +92,25 @@ uint32_t fir_ma_init_d (fir_ma_d_t* f, double fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_f (fir_ma_f_t* f, float fc)
+uint32_t fir_ma_init_f (fir_ma_f_t* f, float fc) {
+   return fir_ma_init_alc_f (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_f (fir_ma_f_t* f, float fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(float))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(float))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -102,12 +128,25 @@ uint32_t fir_ma_init_f (fir_ma_f_t* f, float fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_i32 (fir_ma_i32_t* f, float fc)
+uint32_t fir_ma_init_i32 (fir_ma_i32_t* f, float fc) {
+   return fir_ma_init_alc_i32 (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_i32 (fir_ma_i32_t* f, float fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(int32_t))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(int32_t))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -125,12 +164,25 @@ uint32_t fir_ma_init_i32 (fir_ma_i32_t* f, float fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_ui32 (fir_ma_ui32_t* f, float fc)
+uint32_t fir_ma_init_ui32 (fir_ma_ui32_t* f, float fc) {
+   return fir_ma_init_alc_ui32 (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_ui32 (fir_ma_ui32_t* f, float fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(uint32_t))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(uint32_t))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -148,12 +200,25 @@ uint32_t fir_ma_init_ui32 (fir_ma_ui32_t* f, float fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_cd (fir_ma_cd_t* f, double fc)
+uint32_t fir_ma_init_cd (fir_ma_cd_t* f, double fc) {
+   return fir_ma_init_alc_cd (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_cd (fir_ma_cd_t* f, double fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(complex_d_t))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(complex_d_t))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -170,12 +235,25 @@ uint32_t fir_ma_init_cd (fir_ma_cd_t* f, double fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_cf (fir_ma_cf_t* f, float fc)
+uint32_t fir_ma_init_cf (fir_ma_cf_t* f, float fc) {
+   return fir_ma_init_alc_cf (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_cf (fir_ma_cf_t* f, float fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(complex_f_t))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(complex_f_t))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
@@ -193,12 +271,25 @@ uint32_t fir_ma_init_cf (fir_ma_cf_t* f, float fc)
  * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
  * \return        The number of points
  */
-uint32_t fir_ma_init_ci (fir_ma_ci_t* f, float fc)
+uint32_t fir_ma_init_ci (fir_ma_ci_t* f, float fc) {
+   return fir_ma_init_alc_ci (f, fc, 0);
+}
+
+/*!
+ * \brief
+ *    Moving Average filter initialization, using a specific allocator.
+ *
+ * \param  f      Which filter to use
+ * \param  fc     The normalized cutoff frequency [0fs - 0.5fs]
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The number of points
+ */
+uint32_t fir_ma_init_alc_ci (fir_ma_ci_t* f, float fc, const alc_t *alc)
 {
    f->N = _FILTER_MOVA_SAMPLES (fc);
 
    // Try to allocate memory and check sample points for cutoff frequency
-   if ( (f->N != 0) && ( (f->bf = (void*)calloc (f->N, sizeof(complex_i_t))) != NULL )) {
+   if ( (f->N != 0) && ( (f->bf = (void*)alc_calloc (alc, f->N, sizeof(complex_i_t))) != NULL )) {
       // Clear accumulator and cursor
       f->last = f->c = 0;
       return f->N;
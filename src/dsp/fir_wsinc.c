@@ -265,6 +265,19 @@ void fir_wsic_set_cascade (fir_wsinc_t *f, uint32_t c) {
    f->casc = c;
 }
 
+/*!
+ * \brief
+ *    Set the allocator to use for the filter's kernel and temporary
+ *    arrays. Must be called before \sa fir_wsinc_init().
+ *
+ * \param   f     Which filter to use
+ * \param   alc   Pointer to allocator, or null for the default
+ * \return        None
+*/
+void fir_wsinc_set_alc (fir_wsinc_t *f, const alc_t *alc) {
+   f->alc = alc;
+}
+
 /*
  * User Functions
  */
@@ -277,8 +290,8 @@ void fir_wsic_set_cascade (fir_wsinc_t *f, uint32_t c) {
  * \return none
 */
 void fir_wsinc_deinit (fir_wsinc_t* f) {
-   if ( f->k )
-      free ((void*)f->k);
+   alc_free (f->alc, (void*)f->k);
+   alc_free (f->alc, (void*)f->t);
    memset ((void*)f, 0, sizeof (fir_wsinc_t));
 }
 
@@ -303,8 +316,8 @@ uint32_t fir_wsinc_init (fir_wsinc_t* f)
    f->N = _first_pow2_ge (2*f->T);
 
    // Try to allocate kernel in memory
-   if ( (f->k = (void*)calloc (2*f->N, sizeof (double))) != NULL &&
-        (f->t = (void*)calloc (2*f->N, sizeof (double))) != NULL ) {
+   if ( (f->k = (void*)alc_calloc (f->alc, 2*f->N, sizeof (double))) != NULL &&
+        (f->t = (void*)alc_calloc (f->alc, 2*f->N, sizeof (double))) != NULL ) {
       // Despatch based on filter type
       switch (f->ftype) {
          default:
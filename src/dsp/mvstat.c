@@ -0,0 +1,605 @@
+/*!
+ * \file mvstat.c
+ * \brief
+ *    Moving window statistics (mean, variance, min, max) in O(1) per sample.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <dsp/mvstat.h>
+
+/*
+ * ========= Static ============
+ */
+
+/*!
+ * Monotonic deque helpers. Each deque is a ring of N window positions
+ * with head index _h and length _l.
+ */
+#define _mvstat_back(_q, _h, _l, _N)         \
+   ( (_q)[ ((_h) + (_l) - 1) % (_N) ] )
+
+#define _mvstat_push_back(_q, _h, _l, _N, _v)   \
+   do {                                         \
+      (_q)[ ((_h) + (_l)) % (_N) ] = (_v);      \
+      ++(_l);                                   \
+   } while (0)
+
+#define _mvstat_pop_front(_h, _l, _N)        \
+   do {                                      \
+      if (++(_h) >= (_N))  (_h) = 0;         \
+      --(_l);                                \
+   } while (0)
+
+/*!
+ * Kahan-Neumaier compensated summation: _s += _v, with the rounding
+ * error accumulated in _c.
+ * \warning
+ *    Do not compile with -ffast-math, it optimizes the compensation away.
+ */
+#define _mvstat_ksum(_s, _c, _v, _type)      \
+   do {                                      \
+      _type _t = (_s) + (_v);                \
+      if (fabs (_s) >= fabs (_v))            \
+         (_c) += ((_s) - _t) + (_v);         \
+      else                                   \
+         (_c) += ((_v) - _t) + (_s);         \
+      (_s) = _t;                             \
+   } while (0)
+
+
+/*
+ * =================== Public API =====================
+ */
+
+/*
+ * Link and Glue functions
+ */
+
+/*
+ * Set functions
+ */
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Double precision moving statistics de-initialization.
+ *    Frees the window buffers.
+ *
+ * \param  w      Which window to de-initialize
+ */
+void mvstat_deinit_d (mvstat_d_t* w)
+{
+   alc_free (w->alc, (void*)w->bf);
+   alc_free (w->alc, (void*)w->qmin);
+   alc_free (w->alc, (void*)w->qmax);
+   memset ((void*)w, 0, sizeof (mvstat_d_t));
+}
+
+/*!
+ * \brief
+ *    Double precision moving statistics initialization.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_d (mvstat_d_t* w, uint32_t N) {
+   return mvstat_init_alc_d (w, N, 0);
+}
+
+/*!
+ * \brief
+ *    Double precision moving statistics initialization, using a specific allocator.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_alc_d (mvstat_d_t* w, uint32_t N, const alc_t *alc)
+{
+   memset ((void*)w, 0, sizeof (mvstat_d_t));
+   if (N == 0)
+      return 0;
+   w->alc = alc;
+
+   // Try to allocate the sample buffer and the min/max deques
+   if ( (w->bf   = (void*)alc_calloc (alc, N, sizeof(double))) != NULL &&
+        (w->qmin = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL &&
+        (w->qmax = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL ) {
+      w->N = N;
+      return N;
+   }
+   mvstat_deinit_d (w);
+   return 0;
+}
+
+/*!
+ * \brief
+ *    Double precision moving statistics sample insertion.
+ *    Updates the running sum, the Welford variance accumulators and
+ *    the monotonic min/max deques, all in O(1) (amortized for min/max).
+ *
+ * \param  w      Which window to use
+ * \param  in     The input value.
+ *
+ * \return        The window's mean value
+ */
+double mvstat_d (mvstat_d_t* w, double in)
+{
+   double dep;
+   double d, m;
+   uint32_t full = (w->n >= w->N);
+
+   dep = w->bf[w->c];            /* Save departed point */
+   if (full) {
+      // The departed point, if still in the deques, is their oldest entry
+      if (w->lmin && w->qmin[w->hmin] == w->c)  _mvstat_pop_front (w->hmin, w->lmin, w->N);
+      if (w->lmax && w->qmax[w->hmax] == w->c)  _mvstat_pop_front (w->hmax, w->lmax, w->N);
+   }
+   w->bf[w->c] = in;             /* Get new value */
+
+   // Monotonic deques
+   while (w->lmin && w->bf[_mvstat_back (w->qmin, w->hmin, w->lmin, w->N)] >= in)
+      --w->lmin;
+   _mvstat_push_back (w->qmin, w->hmin, w->lmin, w->N, w->c);
+   while (w->lmax && w->bf[_mvstat_back (w->qmax, w->hmax, w->lmax, w->N)] <= in)
+      --w->lmax;
+   _mvstat_push_back (w->qmax, w->hmax, w->lmax, w->N, w->c);
+
+   // Compensated running sum
+   if (full)   _mvstat_ksum (w->sum, w->comp, -dep, double);
+   _mvstat_ksum (w->sum, w->comp, in, double);
+
+   // Welford variance
+   if (full) {
+      d = (double)in - (double)dep;
+      m = w->mean;
+      w->mean += d / w->N;
+      w->m2 += d * ((double)in - w->mean + (double)dep - m);
+      if (w->m2 < 0)
+         w->m2 = 0;
+   }
+   else {
+      ++w->n;
+      d = (double)in - w->mean;
+      w->mean += d / w->n;
+      w->m2 += d * ((double)in - w->mean);
+   }
+
+   if ( ++(w->c) >= w->N)        /* Buffer overflow checking */
+      w->c = 0;
+   return mvstat_mean_d (w);
+}
+
+/*!
+ * \brief
+ *    Re-calculate the double precision window's running sum and variance
+ *    accumulators exactly from the samples in the window.
+ * \note
+ *    This is O(N). It can be called periodically (every few windows for
+ *    example) to cancel any accumulated rounding error.
+ *
+ * \param  w      Which window to use
+ */
+void mvstat_resync_d (mvstat_d_t* w)
+{
+   double sum=0, comp=0;
+   double mean, d, m2=0;
+   uint32_t i;
+
+   if (!w->n)
+      return;
+   for (i=0 ; i<w->n ; ++i)
+      _mvstat_ksum (sum, comp, w->bf[i], double);
+   mean = (sum + comp) / w->n;
+   for (i=0 ; i<w->n ; ++i) {
+      d = w->bf[i] - mean;
+      m2 += d*d;
+   }
+   w->sum = sum;
+   w->comp = comp;
+   w->mean = mean;
+   w->m2 = m2;
+}
+
+/*!
+ * \brief
+ *    Return the double precision window's mean value.
+ */
+double mvstat_mean_d (mvstat_d_t* w) {
+   return (w->n) ? (double)(w->sum + w->comp) / w->n : 0;
+}
+
+/*!
+ * \brief
+ *    Return the double precision window's (unbiased) sample variance.
+ */
+double mvstat_var_d (mvstat_d_t* w) {
+   return (w->n > 1) ? w->m2 / (w->n - 1) : 0;
+}
+
+/*!
+ * \brief
+ *    Return the double precision window's minimum value.
+ */
+double mvstat_min_d (mvstat_d_t* w) {
+   return (w->lmin) ? w->bf[w->qmin[w->hmin]] : 0;
+}
+
+/*!
+ * \brief
+ *    Return the double precision window's maximum value.
+ */
+double mvstat_max_d (mvstat_d_t* w) {
+   return (w->lmax) ? w->bf[w->qmax[w->hmax]] : 0;
+}
+
+/*!
+ * \brief
+ *    Single precision moving statistics de-initialization.
+ *    Frees the window buffers.
+ *
+ * \param  w      Which window to de-initialize
+ */
+void mvstat_deinit_f (mvstat_f_t* w)
+{
+   alc_free (w->alc, (void*)w->bf);
+   alc_free (w->alc, (void*)w->qmin);
+   alc_free (w->alc, (void*)w->qmax);
+   memset ((void*)w, 0, sizeof (mvstat_f_t));
+}
+
+/*!
+ * \brief
+ *    Single precision moving statistics initialization.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_f (mvstat_f_t* w, uint32_t N) {
+   return mvstat_init_alc_f (w, N, 0);
+}
+
+/*!
+ * \brief
+ *    Single precision moving statistics initialization, using a specific allocator.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_alc_f (mvstat_f_t* w, uint32_t N, const alc_t *alc)
+{
+   memset ((void*)w, 0, sizeof (mvstat_f_t));
+   if (N == 0)
+      return 0;
+   w->alc = alc;
+
+   // Try to allocate the sample buffer and the min/max deques
+   if ( (w->bf   = (void*)alc_calloc (alc, N, sizeof(float))) != NULL &&
+        (w->qmin = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL &&
+        (w->qmax = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL ) {
+      w->N = N;
+      return N;
+   }
+   mvstat_deinit_f (w);
+   return 0;
+}
+
+/*!
+ * \brief
+ *    Single precision moving statistics sample insertion.
+ *    Updates the running sum, the Welford variance accumulators and
+ *    the monotonic min/max deques, all in O(1) (amortized for min/max).
+ *
+ * \param  w      Which window to use
+ * \param  in     The input value.
+ *
+ * \return        The window's mean value
+ */
+float mvstat_f (mvstat_f_t* w, float in)
+{
+   float dep;
+   float d, m;
+   uint32_t full = (w->n >= w->N);
+
+   dep = w->bf[w->c];            /* Save departed point */
+   if (full) {
+      // The departed point, if still in the deques, is their oldest entry
+      if (w->lmin && w->qmin[w->hmin] == w->c)  _mvstat_pop_front (w->hmin, w->lmin, w->N);
+      if (w->lmax && w->qmax[w->hmax] == w->c)  _mvstat_pop_front (w->hmax, w->lmax, w->N);
+   }
+   w->bf[w->c] = in;             /* Get new value */
+
+   // Monotonic deques
+   while (w->lmin && w->bf[_mvstat_back (w->qmin, w->hmin, w->lmin, w->N)] >= in)
+      --w->lmin;
+   _mvstat_push_back (w->qmin, w->hmin, w->lmin, w->N, w->c);
+   while (w->lmax && w->bf[_mvstat_back (w->qmax, w->hmax, w->lmax, w->N)] <= in)
+      --w->lmax;
+   _mvstat_push_back (w->qmax, w->hmax, w->lmax, w->N, w->c);
+
+   // Compensated running sum
+   if (full)   _mvstat_ksum (w->sum, w->comp, -dep, float);
+   _mvstat_ksum (w->sum, w->comp, in, float);
+
+   // Welford variance
+   if (full) {
+      d = (float)in - (float)dep;
+      m = w->mean;
+      w->mean += d / w->N;
+      w->m2 += d * ((float)in - w->mean + (float)dep - m);
+      if (w->m2 < 0)
+         w->m2 = 0;
+   }
+   else {
+      ++w->n;
+      d = (float)in - w->mean;
+      w->mean += d / w->n;
+      w->m2 += d * ((float)in - w->mean);
+   }
+
+   if ( ++(w->c) >= w->N)        /* Buffer overflow checking */
+      w->c = 0;
+   return mvstat_mean_f (w);
+}
+
+/*!
+ * \brief
+ *    Re-calculate the single precision window's running sum and variance
+ *    accumulators exactly from the samples in the window.
+ * \note
+ *    This is O(N). It can be called periodically (every few windows for
+ *    example) to cancel any accumulated rounding error.
+ *
+ * \param  w      Which window to use
+ */
+void mvstat_resync_f (mvstat_f_t* w)
+{
+   float sum=0, comp=0;
+   float mean, d, m2=0;
+   uint32_t i;
+
+   if (!w->n)
+      return;
+   for (i=0 ; i<w->n ; ++i)
+      _mvstat_ksum (sum, comp, w->bf[i], float);
+   mean = (sum + comp) / w->n;
+   for (i=0 ; i<w->n ; ++i) {
+      d = w->bf[i] - mean;
+      m2 += d*d;
+   }
+   w->sum = sum;
+   w->comp = comp;
+   w->mean = mean;
+   w->m2 = m2;
+}
+
+/*!
+ * \brief
+ *    Return the single precision window's mean value.
+ */
+float mvstat_mean_f (mvstat_f_t* w) {
+   return (w->n) ? (float)(w->sum + w->comp) / w->n : 0;
+}
+
+/*!
+ * \brief
+ *    Return the single precision window's (unbiased) sample variance.
+ */
+float mvstat_var_f (mvstat_f_t* w) {
+   return (w->n > 1) ? w->m2 / (w->n - 1) : 0;
+}
+
+/*!
+ * \brief
+ *    Return the single precision window's minimum value.
+ */
+float mvstat_min_f (mvstat_f_t* w) {
+   return (w->lmin) ? w->bf[w->qmin[w->hmin]] : 0;
+}
+
+/*!
+ * \brief
+ *    Return the single precision window's maximum value.
+ */
+float mvstat_max_f (mvstat_f_t* w) {
+   return (w->lmax) ? w->bf[w->qmax[w->hmax]] : 0;
+}
+
+/*!
+ * \brief
+ *    Signed int32 moving statistics de-initialization.
+ *    Frees the window buffers.
+ *
+ * \param  w      Which window to de-initialize
+ */
+void mvstat_deinit_i32 (mvstat_i32_t* w)
+{
+   alc_free (w->alc, (void*)w->bf);
+   alc_free (w->alc, (void*)w->qmin);
+   alc_free (w->alc, (void*)w->qmax);
+   memset ((void*)w, 0, sizeof (mvstat_i32_t));
+}
+
+/*!
+ * \brief
+ *    Signed int32 moving statistics initialization.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_i32 (mvstat_i32_t* w, uint32_t N) {
+   return mvstat_init_alc_i32 (w, N, 0);
+}
+
+/*!
+ * \brief
+ *    Signed int32 moving statistics initialization, using a specific allocator.
+ *
+ * \param  w      Which window to use
+ * \param  N      The window length in samples
+ * \param  alc    Pointer to allocator to use, or null for the default
+ * \return        The window length, or zero on failure
+ */
+uint32_t mvstat_init_alc_i32 (mvstat_i32_t* w, uint32_t N, const alc_t *alc)
+{
+   memset ((void*)w, 0, sizeof (mvstat_i32_t));
+   if (N == 0)
+      return 0;
+   w->alc = alc;
+
+   // Try to allocate the sample buffer and the min/max deques
+   if ( (w->bf   = (void*)alc_calloc (alc, N, sizeof(int32_t))) != NULL &&
+        (w->qmin = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL &&
+        (w->qmax = (void*)alc_calloc (alc, N, sizeof(uint32_t))) != NULL ) {
+      w->N = N;
+      return N;
+   }
+   mvstat_deinit_i32 (w);
+   return 0;
+}
+
+/*!
+ * \brief
+ *    Signed int32 moving statistics sample insertion.
+ *    Updates the running sum, the Welford variance accumulators and
+ *    the monotonic min/max deques, all in O(1) (amortized for min/max).
+ *
+ * \param  w      Which window to use
+ * \param  in     The input value.
+ *
+ * \return        The window's mean value
+ */
+double mvstat_i32 (mvstat_i32_t* w, int32_t in)
+{
+   int32_t dep;
+   double d, m;
+   uint32_t full = (w->n >= w->N);
+
+   dep = w->bf[w->c];            /* Save departed point */
+   if (full) {
+      // The departed point, if still in the deques, is their oldest entry
+      if (w->lmin && w->qmin[w->hmin] == w->c)  _mvstat_pop_front (w->hmin, w->lmin, w->N);
+      if (w->lmax && w->qmax[w->hmax] == w->c)  _mvstat_pop_front (w->hmax, w->lmax, w->N);
+   }
+   w->bf[w->c] = in;             /* Get new value */
+
+   // Monotonic deques
+   while (w->lmin && w->bf[_mvstat_back (w->qmin, w->hmin, w->lmin, w->N)] >= in)
+      --w->lmin;
+   _mvstat_push_back (w->qmin, w->hmin, w->lmin, w->N, w->c);
+   while (w->lmax && w->bf[_mvstat_back (w->qmax, w->hmax, w->lmax, w->N)] <= in)
+      --w->lmax;
+   _mvstat_push_back (w->qmax, w->hmax, w->lmax, w->N, w->c);
+
+   // Exact running sum
+   w->sum += (full) ? (int64_t)in - dep : (int64_t)in;
+
+   // Welford variance
+   if (full) {
+      d = (double)in - (double)dep;
+      m = w->mean;
+      w->mean += d / w->N;
+      w->m2 += d * ((double)in - w->mean + (double)dep - m);
+      if (w->m2 < 0)
+         w->m2 = 0;
+   }
+   else {
+      ++w->n;
+      d = (double)in - w->mean;
+      w->mean += d / w->n;
+      w->m2 += d * ((double)in - w->mean);
+   }
+
+   if ( ++(w->c) >= w->N)        /* Buffer overflow checking */
+      w->c = 0;
+   return mvstat_mean_i32 (w);
+}
+
+/*!
+ * \brief
+ *    Re-calculate the signed int32 window's running sum and variance
+ *    accumulators exactly from the samples in the window.
+ * \note
+ *    This is O(N). It can be called periodically (every few windows for
+ *    example) to cancel any accumulated rounding error.
+ *
+ * \param  w      Which window to use
+ */
+void mvstat_resync_i32 (mvstat_i32_t* w)
+{
+   int64_t sum=0, comp=0;
+   double mean, d, m2=0;
+   uint32_t i;
+
+   if (!w->n)
+      return;
+   for (i=0 ; i<w->n ; ++i)
+      sum += w->bf[i];
+   mean = (double)sum / w->n;
+   for (i=0 ; i<w->n ; ++i) {
+      d = w->bf[i] - mean;
+      m2 += d*d;
+   }
+   w->sum = sum;
+   w->comp = comp;
+   w->mean = mean;
+   w->m2 = m2;
+}
+
+/*!
+ * \brief
+ *    Return the signed int32 window's mean value.
+ */
+double mvstat_mean_i32 (mvstat_i32_t* w) {
+   return (w->n) ? (double)(w->sum + w->comp) / w->n : 0;
+}
+
+/*!
+ * \brief
+ *    Return the signed int32 window's (unbiased) sample variance.
+ */
+double mvstat_var_i32 (mvstat_i32_t* w) {
+   return (w->n > 1) ? w->m2 / (w->n - 1) : 0;
+}
+
+/*!
+ * \brief
+ *    Return the signed int32 window's minimum value.
+ */
+int32_t mvstat_min_i32 (mvstat_i32_t* w) {
+   return (w->lmin) ? w->bf[w->qmin[w->hmin]] : 0;
+}
+
+/*!
+ * \brief
+ *    Return the signed int32 window's maximum value.
+ */
+int32_t mvstat_max_i32 (mvstat_i32_t* w) {
+   return (w->lmax) ? w->bf[w->qmax[w->hmax]] : 0;
+}
@@ -63,6 +63,20 @@ __Os__ static _io_types_en _istype (char c)
    return NO_TYPE;
 }
 
+/*!
+ * \brief
+ *    Find if the current character is a length modifier. That is 'h', or
+ *    an 'l' followed by a type conversion character (so a lonely "%l" is
+ *    still a type).
+ *
+ * \param   The format string at the character to check.
+ * \return  True if it is a length modifier.
+ */
+__Os__ static int _islen (const char *frm)
+{
+   return (*frm == 'h' || (*frm == 'l' && _istype (frm[1]) != NO_TYPE));
+}
+
 /*!
  * \brief
  *    Find if the current character is a flag character.
@@ -142,7 +156,9 @@ int _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type)
                _skip_char (frm);    // Skip it
 
                // State switcher
-               if ((ct = _istype (*frm)) != NO_TYPE)
+               if (_islen (frm))
+                  state = _IO_ST_LEN;
+               else if ((ct = _istype (*frm)) != NO_TYPE)
                   state = _IO_ST_TYPE;
                else if ((cf = _isflag (*frm)) != NO_FLAG)
                   state = _IO_ST_FLAG;
@@ -168,6 +184,8 @@ int _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type)
                // State switcher
                if (IS_1TO9(*frm) || IS_ASTERISK(*frm))
                   state = _IO_ST_WIDTH;
+               else if (_islen (frm))
+                  state = _IO_ST_LEN;
                else if ((ct = _istype (*frm)) != NO_TYPE)
                   state = _IO_ST_TYPE;
                else if ((cf = _isflag (*frm)) != NO_FLAG)
@@ -189,6 +207,8 @@ int _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type)
                // State switcher
                if (IS_0TO9(*frm))
                   ;  //Stay here
+               else if (_islen (frm))
+                  state = _IO_ST_LEN;
                else if ((ct = _istype (*frm)) != NO_TYPE)
                   state = _IO_ST_TYPE;
                else if (IS_DOT (*frm))
@@ -218,6 +238,25 @@ int _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type)
                // State switcher
                if (IS_0TO9(*frm))
                   ;  // Stay here
+               else if (_islen (frm))
+                  state = _IO_ST_LEN;
+               else if ((ct = _istype (*frm)) != NO_TYPE)
+                  state = _IO_ST_TYPE;
+               else
+                  state = _IO_ST_ERROR;
+               break;
+
+            case _IO_ST_LEN:
+               // "hh", "h", "ll" and "l"
+               if (*frm == 'h')
+                  obj->frm_specifier.len = (obj->frm_specifier.len == _IO_LEN_H) ? _IO_LEN_HH : _IO_LEN_H;
+               else
+                  obj->frm_specifier.len = (obj->frm_specifier.len == _IO_LEN_L) ? _IO_LEN_LL : _IO_LEN_L;
+               _skip_char (frm);       // Skip it
+
+               // State switcher
+               if (_islen (frm))
+                  ;  // Stay here
                else if ((ct = _istype (*frm)) != NO_TYPE)
                   state = _IO_ST_TYPE;
                else
@@ -249,3 +288,96 @@ int _io_read (char* frm, _io_frm_obj_t* obj, _io_frm_obj_type_en *obj_type)
    return count;
    #undef _skip_char
 }
+
+/*!
+ * \brief
+ *    Return the argument class of a format specifier. That is the type
+ *    the printf engines fetch from the argument list. "hh" and "h" are
+ *    promoted to int, "l" is 64bit only where long is.
+ *
+ * \param   fs    The format specifier
+ * \return        The argument class
+ */
+_io_arg_class_en _io_arg_class (const _io_frm_spec_t *fs)
+{
+   int wide = (fs->len == _IO_LEN_LL ||
+               (fs->len == _IO_LEN_L && sizeof (long) > sizeof (int)));
+
+   switch (fs->type) {
+      case INT_d:
+      case INT_i:
+      case INT_l:    return (wide) ? _IO_ARG_INT64 : _IO_ARG_INT;
+      case INT_u:
+      case INT_x:
+      case INT_X:
+      case INT_o:    return (wide) ? _IO_ARG_UINT64 : _IO_ARG_UINT;
+      case INT_s:    return _IO_ARG_STR;
+      case FL_e:
+      case FL_E:
+      case FL_f:
+      case FL_g:
+      case FL_G:
+      case FL_L:     return _IO_ARG_DOUBLE;
+      default:       return _IO_ARG_UINT;
+   }
+}
+
+/*!
+ * \brief
+ *    Compile a format string to an op list of literal runs and format
+ *    specifiers, so it can be executed repeatedly without parsing.
+ *    A "%%" is compiled to a one character literal run.
+ *
+ * \param   cf    Pointer to compiled format to initialize
+ * \param   frm   The format string to compile
+ * \param   op    Pointer to op list
+ * \param   size  The op list's capacity. \sa _IO_FRM_OPS()
+ * \return        The number of ops, or -1 if the op list is too small
+ */
+int _io_compile (_io_frm_t *cf, const char *frm, _io_op_t *op, int size)
+{
+   _io_frm_obj_t obj;               /* object place holder */
+   _io_frm_obj_type_en  obj_type;   /* object type place holder */
+   const char *lit;                 /* literal run start */
+   int n = 0, r;
+
+   cf->frm = frm;
+   cf->op = op;
+   cf->size = size;
+   cf->n = 0;
+   while (*frm != 0) {
+      // Literal runs
+      for (lit = frm ; *frm && IS_ALL_BUT_PC (*frm) ; ++frm)
+         ;
+      if (frm != lit) {
+         if (n >= size)
+            return -1;
+         op[n].type = _IO_FRM_STREAM;
+         op[n].lit = lit;
+         op[n++].len = (int)(frm - lit);
+      }
+      if (*frm == 0)
+         break;
+
+      if ((r = _io_read ((char*)frm, &obj, &obj_type)) == 0)
+         break;
+      if (obj_type == _IO_FRM_TERMINATOR)
+         break;
+      if (n >= size)
+         return -1;
+      op[n].type = obj_type;
+      if (obj_type == _IO_FRM_STREAM) {
+         // "%%", point to the second one
+         op[n].lit = frm + r - 1;
+         op[n].len = 1;
+      }
+      else {
+         op[n].lit = 0;
+         op[n].len = 0;
+         op[n].spec = obj.frm_specifier;
+      }
+      ++n;
+      frm += r;
+   }
+   return cf->n = n;
+}
@@ -0,0 +1,1020 @@
+/*!
+ * \file _numconv.c
+ * \brief
+ *    Fast number to string conversion core for the std part
+ *
+ * this file is part of toolbox (std part)
+ *
+ * Copyright (C) 2026 Houtouridis Christos <houtouridis.ch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <std/_numconv.h>
+
+/*!
+ * Two digits per entry, "00" to "99"
+ */
+static const char _digit_pairs[201] =
+   "00010203040506070809"
+   "10111213141516171819"
+   "20212223242526272829"
+   "30313233343536373839"
+   "40414243444546474849"
+   "50515253545556575859"
+   "60616263646566676869"
+   "70717273747576777879"
+   "80818283848586878889"
+   "90919293949596979899";
+
+/*!
+ * Cached powers of ten 10^k, k = -348, -340, ..., 340 as 64bit normalized
+ * significand and binary exponent, for the Grisu2 algorithm.
+ */
+static const uint64_t _cp_f[_NC_CACHED_POWERS] = {
+   0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+   0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+   0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+   0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+   0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+   0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+   0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+   0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+   0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+   0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+   0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+   0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+   0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+   0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+   0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+   0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+   0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+   0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+   0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+   0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+   0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+   0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+   0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+   0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+   0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+   0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+   0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+   0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+   0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+static const int16_t _cp_e[_NC_CACHED_POWERS] = {
+   -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+    -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+    -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+    -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+    -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+     109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+     375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+     641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+     907,   933,   960,   986,  1013,  1039,  1066
+};
+
+static const uint32_t _pow10_32[] = {
+   1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/*
+ * ============================ Integer conversion ============================
+ */
+
+/*!
+ * \brief
+ *    Convert an unsigned 32bit integer to decimal digits, two digits per
+ *    division. The digits are written backwards, ending just before \a end.
+ *
+ * \param   v     The value to convert
+ * \param   end   Pointer to one past the last digit place
+ * \return  Pointer to the first digit
+ */
+__O3__ char* _u32toa_r (uint32_t v, char *end)
+{
+   uint32_t q;
+
+   while (v >= 100) {
+      q = v / 100;
+      end -= 2;
+      memcpy ((void*)end, (const void*)&_digit_pairs[(v - q*100)*2], 2);
+      v = q;
+   }
+   if (v >= 10) {
+      end -= 2;
+      memcpy ((void*)end, (const void*)&_digit_pairs[v*2], 2);
+   }
+   else
+      *--end = (char)('0' + v);
+   return end;
+}
+
+/*!
+ * \brief
+ *    Convert an unsigned 64bit integer to decimal digits, two digits per
+ *    division. The value is split in 8 digit 32bit chunks, so most of the
+ *    divisions are 32bit ones.
+ *
+ * \param   v     The value to convert
+ * \param   end   Pointer to one past the last digit place
+ * \return  Pointer to the first digit
+ */
+__O3__ char* _u64toa_r (uint64_t v, char *end)
+{
+   char *p;
+   uint32_t lo;
+
+   while (v > 0xFFFFFFFFULL) {
+      lo = (uint32_t)(v % 100000000);
+      v /= 100000000;
+      // Exactly 8 digits with leading zeros
+      for (p = _u32toa_r (lo, end), end -= 8 ; p > end ; )
+         *--p = '0';
+   }
+   return _u32toa_r ((uint32_t)v, end);
+}
+
+/*!
+ * \brief
+ *    Convert an unsigned integer to hex digits, using a nibble table.
+ *
+ * \param   v     The value to convert
+ * \param   end   Pointer to one past the last digit place
+ * \param   upper Use capital letters
+ * \return  Pointer to the first digit
+ */
+__O3__ char* _u64tox_r (uint64_t v, char *end, int upper)
+{
+   const char *hex = (upper) ? "0123456789ABCDEF" : "0123456789abcdef";
+
+   do {
+      *--end = hex[v & 0xF];
+      v >>= 4;
+   } while (v);
+   return end;
+}
+
+/*
+ * ============================ Double conversion ============================
+ */
+
+/*!
+ * Do It Yourself floating point type for Grisu: f * 2^e
+ */
+typedef struct {
+   uint64_t f;
+   int      e;
+}_diyfp_t;
+
+#define _DP_SIGNIFICAND_SIZE  (52)
+#define _DP_EXPONENT_BIAS     (0x3FF + _DP_SIGNIFICAND_SIZE)
+#define _DP_MIN_EXPONENT      (-_DP_EXPONENT_BIAS)
+#define _DP_HIDDEN_BIT        (0x0010000000000000ULL)
+#define _DP_SIGNIFICAND_MASK  (0x000FFFFFFFFFFFFFULL)
+#define _DP_EXPONENT_MASK     (0x7FF0000000000000ULL)
+
+static _diyfp_t _diyfp (double d)
+{
+   union { double d; uint64_t u; } u = { d };
+   _diyfp_t r;
+   int be = (int)((u.u & _DP_EXPONENT_MASK) >> _DP_SIGNIFICAND_SIZE);
+
+   if (be) {
+      r.f = (u.u & _DP_SIGNIFICAND_MASK) + _DP_HIDDEN_BIT;
+      r.e = be - _DP_EXPONENT_BIAS;
+   }
+   else {
+      // Subnormals
+      r.f = u.u & _DP_SIGNIFICAND_MASK;
+      r.e = _DP_MIN_EXPONENT + 1;
+   }
+   return r;
+}
+
+/*!
+ * \brief
+ *    64x64 bit multiplication keeping the rounded upper 64 bits.
+ *    Uses only 32x32 bit multiplications.
+ */
+static _diyfp_t _diyfp_mul (_diyfp_t x, _diyfp_t y)
+{
+   const uint64_t M32 = 0xFFFFFFFFULL;
+   uint64_t a = x.f >> 32, b = x.f & M32;
+   uint64_t c = y.f >> 32, d = y.f & M32;
+   uint64_t ac = a*c, bc = b*c, ad = a*d, bd = b*d;
+   uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+   _diyfp_t r;
+
+   tmp += 1U << 31;     // Round
+   r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+   r.e = x.e + y.e + 64;
+   return r;
+}
+
+static _diyfp_t _diyfp_normalize (_diyfp_t x, int shift)
+{
+   while (!(x.f & (_DP_HIDDEN_BIT << shift))) {
+      x.f <<= 1;
+      --x.e;
+   }
+   x.f <<= 11 - shift;
+   x.e -= 11 - shift;
+   return x;
+}
+
+/*!
+ * \brief
+ *    Calculate the normalized boundaries m- and m+ of a double.
+ */
+static void _diyfp_boundaries (_diyfp_t v, _diyfp_t *mi, _diyfp_t *pl)
+{
+   _diyfp_t p = { (v.f << 1) + 1, v.e - 1 };
+
+   *pl = _diyfp_normalize (p, 1);
+   if (v.f == _DP_HIDDEN_BIT) {
+      mi->f = (v.f << 2) - 1;
+      mi->e = v.e - 2;
+   }
+   else {
+      mi->f = (v.f << 1) - 1;
+      mi->e = v.e - 1;
+   }
+   mi->f <<= mi->e - pl->e;
+   mi->e = pl->e;
+}
+
+/*!
+ * \brief
+ *    Return the cached power 10^-K that brings the binary exponent \a e
+ *    in Grisu's [-60, -32] range.
+ */
+static _diyfp_t _cached_power (int e, int *K)
+{
+   double dk = (-61 - e) * 0.30102999566398114 + 347;
+   int k = (int)dk;
+   unsigned idx;
+   _diyfp_t r;
+
+   if (dk - k > 0.0)
+      ++k;
+   idx = (unsigned)((k >> 3) + 1);
+   *K = -(-348 + (int)(idx << 3));
+   r.f = _cp_f[idx];
+   r.e = _cp_e[idx];
+   return r;
+}
+
+static void _grisu_round (char *bf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+   while (rest < wp_w && delta - rest >= ten_kappa &&
+          (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+      --bf[len - 1];
+      rest += ten_kappa;
+   }
+}
+
+static int _count_digits32 (uint32_t n)
+{
+   int d;
+   for (d=1 ; d<10 && n >= _pow10_32[d] ; ++d)
+      ;
+   return d;
+}
+
+static int _digit_gen (_diyfp_t W, _diyfp_t Mp, uint64_t delta, char *bf, int *K)
+{
+   _diyfp_t one = { 1ULL << -Mp.e, Mp.e };
+   uint64_t wp_w = Mp.f - W.f;
+   uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+   uint64_t p2 = Mp.f & (one.f - 1);
+   uint64_t tmp;
+   int kappa = _count_digits32 (p1);
+   int len = 0;
+   uint32_t d;
+
+   while (kappa > 0) {
+      d = p1 / _pow10_32[kappa-1];
+      p1 %= _pow10_32[kappa-1];
+      if (d || len)
+         bf[len++] = (char)('0' + d);
+      --kappa;
+      tmp = ((uint64_t)p1 << -one.e) + p2;
+      if (tmp <= delta) {
+         *K += kappa;
+         _grisu_round (bf, len, delta, tmp, (uint64_t)_pow10_32[kappa] << -one.e, wp_w);
+         return len;
+      }
+   }
+   for ( ; ; ) {
+      p2 *= 10;
+      delta *= 10;
+      d = (uint32_t)(p2 >> -one.e);
+      if (d || len)
+         bf[len++] = (char)('0' + d);
+      p2 &= one.f - 1;
+      --kappa;
+      if (p2 < delta) {
+         *K += kappa;
+         _grisu_round (bf, len, delta, p2, one.f, (-kappa < 10) ? wp_w * _pow10_32[-kappa] : 0);
+         return len;
+      }
+   }
+}
+
+/*!
+ * \brief
+ *    Convert a positive finite double to a decimal digit string that reads
+ *    back to the same double (Grisu2 algorithm).
+ *    The value is 0.d1d2d3...dn x 10^dp
+ * \note
+ *    The digits always round trip, but Grisu2 has no exactness check, so
+ *    for a small fraction of values they are not the shortest ones.
+ *    No terminator is written.
+ *
+ * \param   v     The value to convert. Must be finite and non negative
+ * \param   bf    Pointer to digit buffer, at least _NC_MAX_DIGITS long
+ * \param   dp    Pointer to return the decimal point position
+ * \return  The number of digits
+ */
+__O3__ int _dtoa_shortest (double v, char *bf, int *dp)
+{
+   _diyfp_t dv, W, Wp, Wm, c_mk;
+   int K, len;
+
+   if (v == 0) {
+      bf[0] = '0';
+      *dp = 1;
+      return 1;
+   }
+   dv = _diyfp (v);
+   _diyfp_boundaries (dv, &Wm, &Wp);
+   c_mk = _cached_power (Wp.e, &K);
+   W = _diyfp_mul (_diyfp_normalize (dv, 0), c_mk);
+   Wp = _diyfp_mul (Wp, c_mk);
+   Wm = _diyfp_mul (Wm, c_mk);
+   ++Wm.f;
+   --Wp.f;
+   len = _digit_gen (W, Wp, Wp.f - Wm.f, bf, &K);
+
+   // Drop trailing zeros, they are implied by dp
+   while (len > 1 && bf[len-1] == '0')
+      --len;
+   *dp = len + K;
+   return len;
+}
+
+/*!
+ * Minimal big integer, used only to resolve exact ties when rounding
+ * the round trip digits or parsing. 1408 bits cover 2^1076 x 10^64 and
+ * 10^390 x 2^55.
+ */
+#define _BIG_WORDS      (44)
+typedef struct {
+   uint32_t w[_BIG_WORDS];
+   int      n;
+}_big_t;
+
+static void _big_set (_big_t *b, uint64_t v)
+{
+   b->w[0] = (uint32_t)v;
+   b->w[1] = (uint32_t)(v >> 32);
+   b->n = (b->w[1]) ? 2 : 1;
+}
+
+static void _big_mul (_big_t *b, uint32_t m)
+{
+   uint64_t c = 0;
+   int i;
+
+   for (i=0 ; i<b->n ; ++i) {
+      c += (uint64_t)b->w[i] * m;
+      b->w[i] = (uint32_t)c;
+      c >>= 32;
+   }
+   if (c && b->n < _BIG_WORDS)
+      b->w[b->n++] = (uint32_t)c;
+}
+
+static void _big_add (_big_t *b, uint32_t a)
+{
+   uint64_t c = a;
+   int i;
+
+   for (i=0 ; c && i<b->n ; ++i) {
+      c += b->w[i];
+      b->w[i] = (uint32_t)c;
+      c >>= 32;
+   }
+   if (c && b->n < _BIG_WORDS)
+      b->w[b->n++] = (uint32_t)c;
+}
+
+static void _big_shl (_big_t *b, int sh)
+{
+   int i, ws = sh / 32, bs = sh % 32;
+
+   for (i=b->n-1 ; i>=0 && bs ; --i) {
+      if (i == b->n-1 && (b->w[i] >> (32 - bs)) && b->n < _BIG_WORDS)
+         b->w[b->n++] = b->w[i] >> (32 - bs);
+      b->w[i] = (b->w[i] << bs) | ((i) ? b->w[i-1] >> (32 - bs) : 0);
+   }
+   if (ws && b->n + ws <= _BIG_WORDS) {
+      memmove ((void*)&b->w[ws], (const void*)b->w, b->n * sizeof (uint32_t));
+      memset ((void*)b->w, 0, ws * sizeof (uint32_t));
+      b->n += ws;
+   }
+}
+
+static void _big_pow10 (_big_t *b, int e)
+{
+   for ( ; e >= 9 ; e -= 9)
+      _big_mul (b, _pow10_32[9]);
+   if (e)
+      _big_mul (b, _pow10_32[e]);
+}
+
+static int _big_cmp (const _big_t *a, const _big_t *b)
+{
+   int i;
+
+   if (a->n != b->n)
+      return (a->n > b->n) ? 1 : -1;
+   for (i=a->n-1 ; i>=0 ; --i)
+      if (a->w[i] != b->w[i])
+         return (a->w[i] > b->w[i]) ? 1 : -1;
+   return 0;
+}
+
+/*!
+ * \brief
+ *    Exact compare of a double with a decimal 0.d1d2..dn x 10^dp
+ * \return  The sign of (v - decimal)
+ */
+static int _dcmp_exact (double v, const char *bf, int len, int dp)
+{
+   _diyfp_t dv = _diyfp (v);
+   _big_t l, r;
+   uint64_t D = 0;
+   int i, k = dp - len;
+
+   for (i=0 ; i<len ; ++i)
+      D = D*10 + (uint64_t)(bf[i] - '0');
+   // v = f x 2^e, decimal = D x 10^k. Bring both sides to integers
+   _big_set (&l, dv.f);
+   _big_set (&r, D);
+   if (dv.e > 0)  _big_shl (&l, dv.e);
+   else           _big_shl (&r, -dv.e);
+   if (k > 0)     _big_pow10 (&r, k);
+   else           _big_pow10 (&l, -k);
+   return _big_cmp (&l, &r);
+}
+
+/*!
+ * \brief
+ *    Correctly round the round trip digits of \a v to \a keep digits. Ties
+ *    of the digit string are resolved against the exact binary value,
+ *    and exact ties round to even. The digits that round to zero are
+ *    dropped and the decimal point position is updated on carry.
+ *
+ * \param   v     The value the digits came from
+ * \param   bf    Pointer to digit buffer, as returned from _dtoa_shortest()
+ * \param   len   The number of digits
+ * \param   dp    Pointer to decimal point position
+ * \param   keep  The number of digits to keep
+ * \return  The new number of digits (0 for zero result)
+ */
+__O3__ int _dround (double v, char *bf, int len, int *dp, int keep)
+{
+   int up, c;
+
+   if (keep >= len)
+      return len;
+   if (keep < 0)
+      return 0;
+   if (bf[keep] != '5')
+      up = (bf[keep] > '5');
+   else if (len > keep+1)
+      up = 1;
+   else if ((c = _dcmp_exact (v, bf, len, *dp)) != 0)
+      up = (c > 0);
+   else
+      up = (keep) ? (bf[keep-1] - '0') & 1 : 0;
+
+   len = keep;
+   if (up) {
+      while (len && bf[len-1] == '9')
+         --len;
+      if (len)
+         ++bf[len-1];
+      else {
+         bf[0] = '1';
+         len = 1;
+         ++*dp;
+      }
+   }
+   else {
+      while (len && bf[len-1] == '0')
+         --len;
+   }
+   return len;
+}
+
+/*
+ * ============================ String to number ============================
+ */
+
+#if defined (__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define _NC_SWAR     (1)      /*!< 8 digits at a time parsing, little endian only */
+#else
+#define _NC_SWAR     (0)
+#endif
+
+#define _nc_isdigit(_c)    ((unsigned)((_c) - '0') < 10)
+
+#if _NC_SWAR
+/*!
+ * \brief
+ *    Check if all 8 bytes of \a v are decimal digits.
+ */
+static inline int _is_8digits (uint64_t v)
+{
+   return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+/*!
+ * \brief
+ *    Convert 8 decimal digit bytes (little endian load) to their value
+ *    with 3 multiplications.
+ */
+static inline uint32_t _parse_8digits (uint64_t v)
+{
+   const uint64_t mask = 0x000000FF000000FFULL;
+   const uint64_t mul1 = 100 + (1000000ULL << 32);
+   const uint64_t mul2 = 1 + (10000ULL << 32);
+
+   v -= 0x3030303030303030ULL;
+   v = (v * 10) + (v >> 8);
+   v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+   return (uint32_t)v;
+}
+#endif
+
+/*!
+ * \brief
+ *    Accumulate decimal digits to \a *v, up to a value of 10^19-1. The
+ *    digits that do not fit are counted but not accumulated.
+ *
+ * \param   s        Pointer to the first character
+ * \param   end      Pointer to the end of input
+ * \param   v        Pointer to accumulator
+ * \param   nd       Pointer to return the accumulated digits (leading zeros excluded)
+ * \param   dropped  Pointer to return the number of dropped digits
+ * \param   sticky   Pointer to mark if there is a non zero dropped digit
+ * \return  Pointer to the first non digit character
+ */
+static const char* _scan_digits (const char *s, const char *end, uint64_t *v, int *nd, int *dropped, int *sticky)
+{
+   uint64_t r = *v;
+#if _NC_SWAR
+   uint64_t w;
+
+   // 8 digits at a time while they surely fit in 19 digits
+   while (end - s >= 8 && *nd <= 11) {
+      memcpy ((void*)&w, (const void*)s, 8);
+      if (!_is_8digits (w))
+         break;
+      r = r * 100000000 + _parse_8digits (w);
+      if (r)
+         *nd += (*nd) ? 8 : _count_digits32 ((uint32_t)r);
+      s += 8;
+   }
+#endif
+   for ( ; s < end && _nc_isdigit (*s) ; ++s) {
+      if (*nd < 19) {
+         r = r*10 + (uint64_t)(*s - '0');
+         if (r)
+            ++*nd;
+      }
+      else {
+         ++*dropped;
+         if (*s != '0')
+            *sticky = 1;
+      }
+   }
+   *v = r;
+   return s;
+}
+
+/*!
+ * \brief
+ *    Parse an unsigned decimal integer. Values that do not fit saturate
+ *    to UINT64_MAX.
+ *
+ * \param   s     Pointer to the first character
+ * \param   end   Pointer to the end of input
+ * \param   v     Pointer to return the value
+ * \return  The number of characters consumed, 0 for no number
+ */
+__O3__ int _atou64 (const char *s, const char *end, uint64_t *v)
+{
+   const char *p = s;
+   uint64_t r = 0;
+   unsigned d;
+   int ovf = 0;
+#if _NC_SWAR
+   uint64_t w;
+
+   while (end - p >= 8) {
+      memcpy ((void*)&w, (const void*)p, 8);
+      if (!_is_8digits (w) || r > 184467440736ULL)
+         break;
+      r = r * 100000000 + _parse_8digits (w);
+      p += 8;
+   }
+#endif
+   for ( ; p < end && _nc_isdigit (*p) ; ++p) {
+      d = (unsigned)(*p - '0');
+      if (r > (UINT64_MAX - d) / 10)
+         ovf = 1;
+      else
+         r = r*10 + d;
+   }
+   *v = (ovf) ? UINT64_MAX : r;
+   return (int)(p - s);
+}
+
+/*!
+ * \brief
+ *    Parse a signed decimal integer with an optional sign. Values that do
+ *    not fit saturate to INT64_MIN/INT64_MAX.
+ *
+ * \param   s     Pointer to the first character
+ * \param   end   Pointer to the end of input
+ * \param   v     Pointer to return the value
+ * \return  The number of characters consumed, 0 for no number
+ */
+__O3__ int _atoi64 (const char *s, const char *end, int64_t *v)
+{
+   const char *p = s;
+   uint64_t u;
+   int neg = 0, n;
+
+   if (p < end && (*p == '-' || *p == '+'))
+      neg = (*p++ == '-');
+   if ((n = _atou64 (p, end, &u)) == 0)
+      return 0;
+   if (neg)
+      *v = (u > (uint64_t)INT64_MAX + 1) ? INT64_MIN : (int64_t)(0 - u);
+   else
+      *v = (u > (uint64_t)INT64_MAX) ? INT64_MAX : (int64_t)u;
+   return (int)(p - s) + n;
+}
+
+/*!
+ * \brief
+ *    Parse an hexadecimal integer with an optional "0x" prefix. Values
+ *    that do not fit keep their lower 64 bits.
+ *
+ * \param   s     Pointer to the first character
+ * \param   end   Pointer to the end of input
+ * \param   v     Pointer to return the value
+ * \return  The number of characters consumed, 0 for no number
+ */
+__O3__ int _xtou64 (const char *s, const char *end, uint64_t *v)
+{
+   const char *p = s, *digits;
+   uint64_t r = 0;
+   unsigned d;
+
+   if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+      p += 2;
+   for (digits = p ; p < end ; ++p) {
+      if (_nc_isdigit (*p))            d = (unsigned)(*p - '0');
+      else if (*p >= 'a' && *p <= 'f') d = (unsigned)(*p - 'a' + 10);
+      else if (*p >= 'A' && *p <= 'F') d = (unsigned)(*p - 'A' + 10);
+      else
+         break;
+      r = (r << 4) | d;
+   }
+   if (p == s)
+      return 0;
+   if (p == digits && digits != s) {
+      // A bare prefix, only its '0' is a number, as with libc
+      *v = 0;
+      return 1;
+   }
+   *v = r;
+   return (int)(p - s);
+}
+
+/*!
+ * The exactly representable powers of ten
+ */
+static const double _exact_pow10[] = {
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*!
+ * 10^1 to 10^7 normalized, to complete the (step 8) cached powers
+ */
+static const _diyfp_t _small_pow10[] = {
+   {0xa000000000000000ULL, -60}, {0xc800000000000000ULL, -57},
+   {0xfa00000000000000ULL, -54}, {0x9c40000000000000ULL, -50},
+   {0xc350000000000000ULL, -47}, {0xf424000000000000ULL, -44},
+   {0x9896800000000000ULL, -40}
+};
+
+static _diyfp_t _diyfp_normalize_full (_diyfp_t x)
+{
+   if (!x.f)
+      return x;
+   while (!(x.f & 0x8000000000000000ULL)) {
+      x.f <<= 1;
+      --x.e;
+   }
+   return x;
+}
+
+/*!
+ * \brief
+ *    Build a double from a significand (with at most 53 significant bits)
+ *    and a binary exponent, handling subnormals and overflow.
+ */
+static double _diyfp_to_double (uint64_t f, int e)
+{
+   union { double d; uint64_t u; } u;
+   uint64_t be;
+
+   while (f > (_DP_HIDDEN_BIT << 1) - 1) {
+      f >>= 1;
+      ++e;
+   }
+   while (f && f < _DP_HIDDEN_BIT && e > _DP_MIN_EXPONENT + 1) {
+      f <<= 1;
+      --e;
+   }
+   if (!f || e < _DP_MIN_EXPONENT + 1) {
+      u.u = 0;
+      return u.d;
+   }
+   if (e >= 0x7FF - _DP_EXPONENT_BIAS) {
+      u.u = _DP_EXPONENT_MASK;      // INF
+      return u.d;
+   }
+   be = (e == _DP_MIN_EXPONENT + 1 && !(f & _DP_HIDDEN_BIT)) ? 0 : (uint64_t)(e + _DP_EXPONENT_BIAS);
+   u.u = (f & _DP_SIGNIFICAND_MASK) | (be << _DP_SIGNIFICAND_SIZE);
+   return u.d;
+}
+/*!
+ * \brief
+ *    Read the significand digits [s, end) (with an optional '.') to a big
+ *    integer, up to _NC_MAX_SIG_DIGITS significant digits.
+ *
+ * \param   b        Pointer to big integer
+ * \param   k        Pointer to the decimal exponent, adjusted for the read digits
+ * \param   sticky   Pointer to mark if there is a non zero digit left out
+ */
+static void _big_digits (_big_t *b, const char *s, const char *end, int *k, int *sticky)
+{
+   uint32_t chunk = 0;
+   int n = 0, nc = 0, frac = 0;
+
+   _big_set (b, 0);
+   for ( ; s < end ; ++s) {
+      if (*s == '.') {
+         frac = 1;
+         continue;
+      }
+      if (n >= _NC_MAX_SIG_DIGITS) {
+         if (*s != '0')    *sticky = 1;
+         if (!frac)        ++*k;
+         continue;
+      }
+      if (frac)
+         --*k;
+      if (!n && *s == '0')
+         continue;
+      chunk = chunk*10 + (uint32_t)(*s - '0');
+      ++n;
+      if (++nc == 9) {
+         _big_mul (b, _pow10_32[9]);
+         _big_add (b, chunk);
+         chunk = nc = 0;
+      }
+   }
+   if (nc) {
+      _big_mul (b, _pow10_32[nc]);
+      _big_add (b, chunk);
+   }
+}
+
+/*!
+ * \brief
+ *    Exact compare of a binary f x 2^e and a decimal D x 10^k.
+ * \return  The sign of (binary - decimal)
+ */
+static int _cmp_bin_dec (uint64_t f, int e, const _big_t *D, int k)
+{
+   _big_t l, r = *D;
+
+   _big_set (&l, f);
+   if (e > 0)     _big_shl (&l, e);
+   else           _big_shl (&r, -e);
+   if (k > 0)     _big_pow10 (&r, k);
+   else           _big_pow10 (&l, -k);
+   return _big_cmp (&l, &r);
+}
+
+/*!
+ * \brief
+ *    Approximate D x 10^k with a 64bit multiplication by a cached power
+ *    of ten and round it to double.
+ *
+ * \param   D        The decimal significand
+ * \param   k        The decimal exponent
+ * \param   sticky   D is truncated, the actual value is in (D, D+1)
+ * \param   sure     Pointer to return if the rounding is guaranteed correct
+ * \return  The approximated value, within one ulp from the correct one
+ */
+static double _approx_dec (uint64_t D, int k, int sticky, int *sure)
+{
+   _diyfp_t v = { D, 0 };
+   uint64_t half, low, err;
+   int idx, K, sh, nsh;
+
+   v = _diyfp_normalize_full (v);
+   nsh = v.e;
+   idx = (k + 348) / 8;
+   K = -348 + idx*8;
+   if (k != K)
+      v = _diyfp_mul (v, _small_pow10[k - K - 1]);
+   v = _diyfp_mul (v, (_diyfp_t){_cp_f[idx], _cp_e[idx]});
+   // Error in units of the last place: half from each rounded multiplication,
+   // half from the cached power, doubled for the final normalization. A truncated
+   // D adds less than 2^(64-nsh)/D ulp, we take the 64 - bits(D) bound.
+   err = (k != K) ? 4 : 3;
+   if (sticky)
+      err += 1ULL << (-nsh + 1);
+   v = _diyfp_normalize_full (v);
+   err <<= 1;
+
+   // Round to 53 bits (less for subnormals)
+   sh = 11;
+   if (v.e + 64 < -1021)
+      sh += -1021 - (v.e + 64);
+   if (sh >= 64) {
+      *sure = 0;
+      return 0;
+   }
+   half = 1ULL << (sh-1);
+   low = v.f & ((half << 1) - 1);
+   *sure = (low > half) ? (low - half > err) : (half - low > err);
+   D = v.f >> sh;
+   if (low >= half)
+      ++D;
+   return _diyfp_to_double (D, v.e + sh);
+}
+
+/*!
+ * \brief
+ *    Parse a decimal floating point number, with an optional sign, fractional
+ *    part and exponent, or INF/NaN. The conversion is correctly rounded
+ *    (round to nearest, ties to even) for up to _NC_MAX_SIG_DIGITS significant
+ *    digits. The digits beyond are used only as a sticky bit.
+ *
+ *    - Exact small cases use a double multiplication (Clinger's fast path).
+ *    - The rest use a 64bit multiplication with a cached power of ten of
+ *      the first 19 digits, which is enough unless the result is too close
+ *      to a halfway point.
+ *    - Only then the result is corrected with exact big integer compares
+ *      against the halfway points to its neighbours.
+ *
+ * \param   s     Pointer to the first character
+ * \param   end   Pointer to the end of input
+ * \param   v     Pointer to return the value
+ * \return  The number of characters consumed, 0 for no number
+ */
+__O3__ int _atod (const char *s, const char *end, double *v)
+{
+   const char *p = s, *q, *sig;
+   uint64_t D = 0, f;
+   int neg = 0, nd = 0, dropped = 0, sticky = 0, k = 0, ex = 0, exneg;
+   int c, e, i, digits, sure, kb;
+   _big_t B;
+   double r;
+   union { double d; uint64_t u; } u;
+
+   if (p < end && (*p == '-' || *p == '+'))
+      neg = (*p++ == '-');
+   // INF and NaN
+   if (end - p >= 3 && (p[0]|0x20) == 'i' && (p[1]|0x20) == 'n' && (p[2]|0x20) == 'f') {
+      p += 3;
+      if (end - p >= 5 && (p[0]|0x20) == 'i' && (p[1]|0x20) == 'n' && (p[2]|0x20) == 'i'
+                        && (p[3]|0x20) == 't' && (p[4]|0x20) == 'y')
+         p += 5;
+      u.u = _DP_EXPONENT_MASK;
+      *v = (neg) ? -u.d : u.d;
+      return (int)(p - s);
+   }
+   if (end - p >= 3 && (p[0]|0x20) == 'n' && (p[1]|0x20) == 'a' && (p[2]|0x20) == 'n') {
+      u.u = _DP_EXPONENT_MASK | (_DP_HIDDEN_BIT >> 1);
+      *v = (neg) ? -u.d : u.d;
+      return (int)(p + 3 - s);
+   }
+   // Significand
+   sig = q = p;
+   p = _scan_digits (p, end, &D, &nd, &dropped, &sticky);
+   k = dropped;
+   digits = (int)(p - q);
+   if (p < end && *p == '.') {
+      q = ++p;
+      dropped = 0;
+      p = _scan_digits (p, end, &D, &nd, &dropped, &sticky);
+      // The accumulated fractional digits, including leading zeros
+      k -= (int)(p - q) - dropped;
+      digits += (int)(p - q);
+   }
+   if (!digits)
+      return 0;
+   q = p;   // significand's end
+   // Exponent
+   if (p < end && (*p == 'e' || *p == 'E')) {
+      const char *x = p + 1;
+      exneg = 0;
+      if (x < end && (*x == '-' || *x == '+'))
+         exneg = (*x++ == '-');
+      if (x < end && _nc_isdigit (*x)) {
+         for ( ; x < end && _nc_isdigit (*x) ; ++x)
+            if (ex < 100000)
+               ex = ex*10 + (*x - '0');
+         if (exneg)
+            ex = -ex;
+         k += ex;
+         p = x;
+      }
+   }
+
+   // Conversion
+   if (!D)
+      r = 0;
+   else if (nd + k > 310)
+      r = _diyfp_to_double (_DP_HIDDEN_BIT, 0x7FF);
+   else if (nd + k < -326)
+      r = 0;
+   else if (!sticky && D <= (1ULL << 53) && k >= -22 && k <= 22)
+      r = (k < 0) ? (double)D / _exact_pow10[-k] : (double)D * _exact_pow10[k];
+   else if (r = _approx_dec (D, k, sticky, &sure), !sure) {
+      // Correct against the halfway points with all the digits
+      kb = ex;
+      sticky = 0;
+      _big_digits (&B, sig, q, &kb, &sticky);
+      for (i=0 ; i<4 ; ++i) {
+         u.d = r;
+         if (u.u >= _DP_EXPONENT_MASK)
+            u.u = _DP_EXPONENT_MASK - 1;  // Test from the largest finite
+         r = u.d;
+         e = (int)((u.u & _DP_EXPONENT_MASK) >> _DP_SIGNIFICAND_SIZE);
+         f = u.u & _DP_SIGNIFICAND_MASK;
+         if (e) { f |= _DP_HIDDEN_BIT;  e -= _DP_EXPONENT_BIAS; }
+         else   { e = _DP_MIN_EXPONENT + 1; }
+         // Upper halfway point (2f+1) x 2^(e-1)
+         c = _cmp_bin_dec (2*f + 1, e - 1, &B, kb);
+         if (c < 0 || (c == 0 && (sticky || (f & 1)))) {
+            ++u.u;
+            r = u.d;
+            if (u.u == _DP_EXPONENT_MASK)
+               break;
+            continue;
+         }
+         // Lower halfway point, closer at the binade's bottom
+         if (f == _DP_HIDDEN_BIT && e > _DP_MIN_EXPONENT + 1)
+            c = _cmp_bin_dec (4*f - 1, e - 2, &B, kb);
+         else if (f)
+            c = _cmp_bin_dec (2*f - 1, e - 1, &B, kb);
+         else
+            break;
+         if (c > 0 || (c == 0 && !sticky && (f & 1))) {
+            --u.u;
+            r = u.d;
+            continue;
+         }
+         break;
+      }
+   }
+   *v = (neg) ? -r : r;
+   return (int)(p - s);
+}
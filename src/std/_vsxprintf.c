@@ -23,140 +23,144 @@
  */
 #include <std/_vsxprintf.h>
 
-static inline void _shift_right (unsigned int *i);
-static inline void _shift_left (unsigned int *i);
-static int _floorlog10 (double d) __O3__ ;
-static double _pw10(int e) __O3__ ;
-
-static int _inschar (_putc_out_t _out, char* dst, char c) __Os__ ;
-static int _insnchar (_putc_out_t _out, char *dst, char c, int n) __Os__ ;
-static int _insstring (_putc_out_t _out, char *dst, const char *src, int length) __Os__ ;
-static int _insuint(_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned int value) __Os__ ;
-static int _insuint64 (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned long long value) __Os__;
-static int _insint (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, char min, int value) __Os__ ;
-static int _insint64 (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, char min, long long value) __Os__;
-static int _inshex (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned int value) __Os__ ;
-static int _inscoredouble (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value) __Os__ ;
-static int _insfdouble (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value) __Os__ ;
-static int _insedouble (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value) __Os__ ;
+static int _inschar (_io_sink_t *sk, char c) __Os__ ;
+static int _insnchar (_io_sink_t *sk, char c, int n) __Os__ ;
+static int _insstring (_io_sink_t *sk, const char *src, int length) __Os__ ;
+static int _inspad (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, int len) __O3__ ;
+static int _insdigits (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n) __O3__ ;
+static int _insuint(_io_sink_t *sk, _io_frm_spec_t *fs, unsigned int value) __O3__ ;
+static int _insuint64 (_io_sink_t *sk, _io_frm_spec_t *fs, unsigned long long value) __O3__ ;
+static int _insint (_io_sink_t *sk, _io_frm_spec_t *fs, int value) __O3__ ;
+static int _insint64 (_io_sink_t *sk, _io_frm_spec_t *fs, long long value) __O3__ ;
+static int _inshex (_io_sink_t *sk, _io_frm_spec_t *fs, unsigned long long value) __O3__ ;
+static int _insdecpart (_io_sink_t *sk, const char *d, int n, int from, int to) __O3__ ;
+static int _fmtexp (char *bf, char e, int exp) __Os__ ;
+static int _insfixed (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n, int dp, int frac) __Os__ ;
+static int _insexp (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n, int dp, int frac) __Os__ ;
+static int _insdouble (_io_sink_t *sk, _io_frm_spec_t *fs, double value) __O3__ ;
+static int _insarg (_io_sink_t *sk, _io_frm_spec_t *fs, const _io_arg_t *a) __O3__ ;
+static int _vsxprintf (_io_sink_t *sk, const char *frm, const _io_op_t *op, int nop, __VALIST ap) __O3__ ;
 //static double _va_args_double (__VALIST ap);
 
 
-/*!
- * Helper functions.
- */
 
-// Shift 1 bit to the right
-static inline void _shift_right (unsigned int *i) { *i >>= 1; }
-// Shift 1 bit to the left
-static inline void _shift_left (unsigned int *i) { *i <<= 1; }
+/*
+ * Tailoring functions
+ */
 
 /*!
  * \brief
- *    Calculates the integer floor (log10 (d)) of a double.
- *    For d>1 multiply a number and check it with a double
- *       the number is integer for small doubles  (<1e18)
- *       and double for big ones (>=1e18).
- *    For d<1 multiply the double and check it with an integer
- *
- *  \return  0 for wrong double (d<=0)
- *          -1 for huge values
+ *    insert a char to user defined output function
  */
-static int _floorlog10 (double d)
+inline int _putc_usr (char *dst, const char c)
 {
-   int lg=0;
-   register unsigned long long tenb=1;
+   return __putchar (c);
+}
 
-   if (d<=0)      // No Log10 for these numbers, return 0
-      return 0;
-   else if (d<1) {
-      do {
-         d *= 10;
-         --lg;
-      } while (d < 1);
-      return lg+1;
-      /*!
-       * \note
-       * Unfortunately here, we have to multiply the double.
-       * A better solution to replace that is well appreciated.
-       */
-   }
-   else {
-      if (d < _IO_MAX_FLOAT) {
-         while (tenb < d) {
-            tenb *= 10;
-            ++lg;
-         }
-         return lg-1;
-      }
-      else {
-         return -1;
-      }
-      /*!
-       *  \note
-       *  We search for the right number by integer multiplications when possible.
-       *  If the number is bigger than 1e18 (64 bit max decimal digits),
-       *  we do the loop with floating point arithmetic. sorry :(
-       */
-   }
+/*!
+ * \brief
+ *    insert a char to destination string.
+ */
+inline int _putc_dst (char *dst, const char c)
+{
+   *dst = c;
+   return 1;
 }
 
+/*!
+ * The user's block write function, \sa printf_link_write()
+ */
+static _io_write_ft _usr_write = 0;
 
 /*!
- *  \brief Calculates the power 10^(int)e
+ * \brief
+ *    Link a block write function for the user's device stdout. When linked
+ *    the printf family flushes its buffer with one call to it, instead of
+ *    a __putchar() call per character.
+ * \param   w     Pointer to write function, or null to use __putchar()
  */
-static double _pw10(int e)
-{
-   register unsigned long long p=1;
-   int s=1;
+void printf_link_write (_io_write_ft w) {
+   _usr_write = w;
+}
 
-   // Keep sign
-   if (e<0) {
-      s = -1;
-      e *= s;
-   }
-   // Calculate the power
-   while (e--)
-      p *= 10;
+/*!
+ * \brief
+ *    Write back end for the user's device stdout.
+ */
+int _write_usr (void *ctx, const char *src, size_t n)
+{
+   size_t i;
 
-   // return it as numerator or denominator.
-   if (s == 1) return (double)(p);
-   else        return (double)(1.0/p);
+   if (_usr_write)
+      return _usr_write (ctx, src, n);
+   for (i=0 ; i<n ; ++i)
+      __putchar (src[i]);
+   return (int)n;
 }
 
 
-/*
- * Tailoring functions
+
+/*!
+ * Sink functions.
  */
 
 /*!
  * \brief
- *    insert a char to user defined output function
+ *    Stream a character to the sink. When the sink's buffer is full, it
+ *    is flushed to the back-end. String sinks without back-end just drop
+ *    the characters that do not fit, but they still count them.
  */
-inline int _putc_usr (char *dst, const char c)
+static inline void _sink_putc (_io_sink_t *sk, char c)
 {
-   return __putchar (c);
+   if (sk->len >= sk->size && sk->write)
+      _sink_flush (sk);
+   if (sk->len < sk->size)
+      sk->buf[sk->len++] = c;
+   ++sk->count;
 }
 
 /*!
  * \brief
- *    insert a char to destination string.
+ *    Stream a block of characters to the sink, using memcpy().
  */
-inline int _putc_dst (char *dst, const char c)
+static void _sink_write (_io_sink_t *sk, const char *src, size_t n)
 {
-   *dst = c;
-   return 1;
+   size_t room;
+
+   sk->count += n;
+   while (n) {
+      if (sk->len >= sk->size) {
+         if (!sk->write)
+            return;
+         _sink_flush (sk);
+      }
+      room = sk->size - sk->len;
+      if (room > n)  room = n;
+      memcpy ((void*)&sk->buf[sk->len], (const void*)src, room);
+      sk->len += room;
+      src += room;
+      n -= room;
+   }
 }
 
 /*!
  * \brief
- *    insert a char to file output function
+ *    Legacy _putc_out_t back-end adapter for \sa vsxprintf().
  */
-inline int _putc_fil (char *dst, const char c)
+typedef struct {
+   _putc_out_t out;
+   char        *dst;
+}_putc_ctx_t;
+
+static int _write_putc (void *ctx, const char *src, size_t n)
 {
-   return 0;
-}
+   _putc_ctx_t *pc = (_putc_ctx_t*)ctx;
+   size_t i;
 
+   for (i=0 ; i<n ; ++i)
+      pc->out (pc->dst++, src[i]);
+   return (int)n;
+}
 
 
 /*!
@@ -165,554 +169,404 @@ inline int _putc_fil (char *dst, const char c)
 
 /*!
  * \brief
- *    Writes a character inside the given string. Returns 1.
+ *    Writes a character to the sink. Returns 1.
  *
- * \param  dst    destination string.
+ * \param  sk     Output sink.
  * \param  c      character to write.
  */
-static inline int _inschar(_putc_out_t _out, char *dst, char c) {
-   return _out (dst, c);
+static inline int _inschar(_io_sink_t *sk, char c) {
+   _sink_putc (sk, c);
+   return 1;
 }
 
 /*!
  * \brief
- *    Writes \a n characters inside the given string and Returns the number
+ *    Writes \a n characters to the sink and Returns the number
  *    of written characters.
  *
- * \param  dst  destination string.
+ * \param  sk   Output sink.
  * \param  c    character to write.
  * \param  n    number of characters to write.
  */
-static int _insnchar(_putc_out_t _out, char *dst, char c, int n)
+static int _insnchar(_io_sink_t *sk, char c, int n)
 {
    int nn;
-   for (nn=n ; nn ; --nn)
-      _out (dst++, c);
-   return n;
+   for (nn=n ; nn>0 ; --nn)
+      _sink_putc (sk, c);
+   return (n>0) ? n : 0;
 }
 
 /*!
  * \brief
- *    Writes a string inside the given string.
+ *    Writes a string to the sink.
  *
- * \param  dst    destination string.
+ * \param  sk     Output sink.
  * \param  src    source string.
  * \param  width  Minimum string width, or 0 for default.
  * \return The size of the written
  */
-static int _insstring(_putc_out_t _out, char *dst, const char *src, int length)
+static int _insstring(_io_sink_t *sk, const char *src, int length)
 {
-   int n=0;
+   int n = (int)strlen (src);
 
    // Send main string
-   for (n=0 ; *src ; ++n)
-      _out (dst++, *src++);
+   _sink_write (sk, src, (size_t)n);
    // Send remaining - if any
    if (length && length>n)
-      n += _insnchar (_out, dst, ' ', length-n);
+      n += _insnchar (sk, ' ', length-n);
    return n;
 }
-
-
 /*!
  * \brief
- *    Writes an unsigned int inside the given string, using the provided
- *    lead character & width parameters. To convert spreads an integer in
- *    to an array discarding one LBS at a time. After that takes the last
- *    digit of each and stream it to string.
+ *    Writes the padding and the sign of a number whose body (digits, point,
+ *    exponent) is \a len characters long. Using '0' as lead character the
+ *    sign goes first and the zeros after, otherwise the lead characters
+ *    go first. The sign counts in width.
  *
- *    For example the number 1234 will expand as:
- *      [0]: 1234
- *      [1]: 123
- *      [2]: 12
- *      [3]: 1
- *      [4]: 0
- *      After that it streams '1', '2', '3', and '4'
- *
- * \param  dst   destination string.
- * \param  lead  Leading character.
- * \param  width Minimum integer width.
- * \param  value Integer value.
+ * \param  sk     Output sink.
+ * \param  fs     The format specifier.
+ * \param  sign   The sign character or 0 for none.
+ * \param  len    The number's body length.
  *
  * \return The number of written characters.
  */
-static int _insuint(_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned int value)
+static int _inspad (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, int len)
 {
-   int num = 0, i, j;
-   unsigned int bf[_IO_MAX_INT_DIGITS];
-
-   // Spread value
-   for (i=0, bf[0]=value ; i<_IO_MAX_INT_DIGITS-1 ; ) {
-      bf[i+1] = bf[i]/10;
-      if (!bf[++i])
-         break;
-   }
-
-   // Write leading characters
-   for (j=i ; j<fs->width ; ++j)
-      num += _inschar (_out, dst++, fs->flags.lead);
-
-   // Write actual numbers
-   for ( ; i ; --i)
-      num += _inschar (_out, dst++, (bf[i-1] - bf[i]*10) + '0');
+   int num = 0, pad = fs->width - len - (sign != 0);
 
+   if (fs->flags.lead == '0') {
+      if (sign)
+         num += _inschar (sk, sign);
+      num += _insnchar (sk, '0', pad);
+   }
+   else {
+      num += _insnchar (sk, fs->flags.lead, pad);
+      if (sign)
+         num += _inschar (sk, sign);
+   }
    return num;
 }
 
 /*!
  * \brief
- *    Writes an unsigned long long int inside the given string, using the provided
- *    lead character & width parameters. To convert spreads an integer in
- *    to an array discarding one LBS at a time. After that takes the last
- *    digit of each and stream it to string.
+ *    Writes a digit string using the provided lead character, width
+ *    and sign, in one block.
  *
- *    For example the number 1234 will expand as:
- *      [0]: 1234
- *      [1]: 123
- *      [2]: 12
- *      [3]: 1
- *      [4]: 0
- *      After that it streams '1', '2', '3', and '4'
+ * \param  sk     Output sink.
+ * \param  fs     The format specifier.
+ * \param  sign   The sign character or 0 for none.
+ * \param  d      Pointer to digits.
+ * \param  n      The number of digits.
  *
- * \param  dst   destination string.
- * \param  lead  Leading character.
- * \param  width Minimum integer width.
+ * \return The number of written characters.
+ */
+static int _insdigits (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n)
+{
+   int num = _inspad (sk, fs, sign, n);
+
+   _sink_write (sk, d, (size_t)n);
+   return num + n;
+}
+
+/*!
+ * \brief
+ *    Writes an unsigned int, using the provided lead character & width
+ *    parameters. The digits are produced two at a time from a digit
+ *    pair table \sa _u32toa_r().
+ *
+ * \param  sk    Output sink.
+ * \param  fs    The format specifier.
  * \param  value Integer value.
  *
  * \return The number of written characters.
  */
-static int _insuint64 (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned long long value)
+static int _insuint(_io_sink_t *sk, _io_frm_spec_t *fs, unsigned int value)
 {
-   int num = 0, i, j;
-   unsigned int bf[_IO_MAX_INT64_DIGITS];
-
-   // Spread value
-   for (i=0, bf[0]=value ; i<_IO_MAX_INT64_DIGITS-1 ; ) {
-      bf[i+1] = bf[i]/10;
-      if (!bf[++i])
-         break;
-   }
+   char bf[_IO_MAX_INT_DIGITS];
+   char *end = &bf[_IO_MAX_INT_DIGITS];
+   char *p = _u32toa_r ((uint32_t)value, end);
 
-   // Write leading characters
-   for (j=i ; j<fs->width ; ++j)
-      num += _inschar (_out, dst++, fs->flags.lead);
+   return _insdigits (sk, fs, 0, p, (int)(end - p));
+}
 
-   // Write actual numbers
-   for ( ; i ; --i)
-      num += _inschar (_out, dst++, (bf[i-1] - bf[i]*10) + '0');
+/*!
+ * \brief
+ *    Writes an unsigned long long int, using the provided lead character &
+ *    width parameters. \sa _u64toa_r().
+ *
+ * \param  sk    Output sink.
+ * \param  fs    The format specifier.
+ * \param  value Integer value.
+ *
+ * \return The number of written characters.
+ */
+static int _insuint64 (_io_sink_t *sk, _io_frm_spec_t *fs, unsigned long long value)
+{
+   char bf[_IO_MAX_INT64_DIGITS];
+   char *end = &bf[_IO_MAX_INT64_DIGITS];
+   char *p = _u64toa_r ((uint64_t)value, end);
 
-   return num;
+   return _insdigits (sk, fs, 0, p, (int)(end - p));
 }
 
 /*!
  * \brief
- *    Writes a signed int inside the given string, using the provided
- *    lead characters & width parameters. To convert spreads an integer in
- *    to an array discarding one LBS at a time. After that takes the last
- *    digit of each and stream it to string.
- *
- *    For example the number 1234 will expand as:
- *      [0]: 1234
- *      [1]: 123
- *      [2]: 12
- *      [3]: 1
- *      [4]: 0
- *      After that it streams '1', '2', '3', and '4'
+ *    Writes a signed int, using the provided lead character, width &
+ *    sign parameters.
  *
- * \param dst    destination string.
- * \param lead   Leading character.
- * \param width  Minimum integer width.
- * \param sign   Always print sign flag.
- * \param min    Is a negative number, used if value is zero.
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
  * \param value  Signed integer value.
  *
  * \return The number of written characters.
  */
-static int _insint (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, char min, int value)
+static int _insint (_io_sink_t *sk, _io_frm_spec_t *fs, int value)
 {
-   int num = 0, i, j;
-   int bf[_IO_MAX_INT_DIGITS];
-   unsigned int absv, negative=min, scr;
-   void (*pshift) (unsigned int*);
+   char bf[_IO_MAX_INT_DIGITS];
+   char *end = &bf[_IO_MAX_INT_DIGITS];
+   char *p, sign = (fs->flags.plus) ? '+' : 0;
+   unsigned int absv = (unsigned int)value;
 
-   // Compute absolute value
    if (value < 0) {
-      negative=1;
-      absv = -value;
-   }
-   else
-      absv = value;
-
-   // Spread absolute value
-   for (i=0, bf[0]=absv ; i<_IO_MAX_INT_DIGITS-1 ; ) {
-      bf[i+1] = bf[i]/10;
-      if (!bf[++i])
-         break;
-   }
-   j = i + (fs->flags.plus || negative);
-
-   /*
-    *  Decide to run lead characters code or sign code first.
-    */
-   if (fs->flags.lead == '0')
-      pshift = _shift_left;
-   else
-      pshift = _shift_right;
-
-   for (scr=0x04 ; scr ; ) {
-      pshift (&scr);
-      switch (scr) {
-         case 0x01:
-         case 0x08:
-            // Write sign
-            if (negative)
-               num += _inschar (_out, dst++, '-');
-            else if (fs->flags.plus)
-               num += _inschar (_out, dst++, '+');
-            break;
-         case 0x02:
-         case 0x10:
-            // Write lead characters
-            for ( ; j<fs->width ; ++j)
-               num += _inschar (_out, dst++, fs->flags.lead);
-            break;
-         default:
-            scr = 0;
-            break;
-      }
+      sign = '-';
+      absv = 0U - absv;
    }
-
-   // Write actual numbers
-   for ( ; i ; --i)
-      num += _inschar (_out, dst++, (bf[i-1] - bf[i]*10) + '0');
-
-   return num;
+   p = _u32toa_r ((uint32_t)absv, end);
+   return _insdigits (sk, fs, sign, p, (int)(end - p));
 }
 
 /*!
  * \brief
- *    Writes a signed long long inside the given string, using the provided
- *    lead characters & width parameters. To convert spreads an integer in
- *    to an array discarding one LBS at a time. After that takes the last
- *    digit of each and stream it to string.
- *
- *    For example the number 1234 will expand as:
- *      [0]: 1234
- *      [1]: 123
- *      [2]: 12
- *      [3]: 1
- *      [4]: 0
- *      After that it streams '1', '2', '3', and '4'
+ *    Writes a signed long long, using the provided lead character, width &
+ *    sign parameters.
  *
- * \param dst    destination string.
- * \param lead   Leading character.
- * \param width  Minimum integer width.
- * \param sign   Always print sign flag.
- * \param min    Is a negative number, used if value is zero.
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
  * \param value  Signed integer value.
  *
  * \return The number of written characters.
  */
-static int _insint64 (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, char min, long long value)
+static int _insint64 (_io_sink_t *sk, _io_frm_spec_t *fs, long long value)
 {
-   int num = 0, i, j;
-   int bf[_IO_MAX_INT64_DIGITS];
-   unsigned long long absv;
-   unsigned int negative=min, scr;
-   void (*pshift) (unsigned int*);
+   char bf[_IO_MAX_INT64_DIGITS];
+   char *end = &bf[_IO_MAX_INT64_DIGITS];
+   char *p, sign = (fs->flags.plus) ? '+' : 0;
+   unsigned long long absv = (unsigned long long)value;
 
-   // Compute absolute value
    if (value < 0) {
-      negative=1;
-      absv = -value;
+      sign = '-';
+      absv = 0ULL - absv;
    }
-   else
-      absv = value;
-
-   // Spread absolute value
-   for (i=0, bf[0]=absv ; i<_IO_MAX_INT64_DIGITS-1 ; ) {
-      bf[i+1] = bf[i]/10;
-      if (!bf[++i])
-         break;
-   }
-   j = i + (fs->flags.plus || negative);
-
-   /*
-    *  Decide to run lead characters code or sign code first.
-    */
-   if (fs->flags.lead == '0')
-      pshift = _shift_left;
-   else
-      pshift = _shift_right;
-
-   for (scr=0x04 ; scr ; ) {
-      pshift (&scr);
-      switch (scr) {
-         case 0x01:
-         case 0x08:
-            // Write sign
-            if (negative)
-               num += _inschar (_out, dst++, '-');
-            else if (fs->flags.plus)
-               num += _inschar (_out, dst++, '+');
-            break;
-         case 0x02:
-         case 0x10:
-            // Write lead characters
-            for ( ; j<fs->width ; ++j)
-               num += _inschar (_out, dst++, fs->flags.lead);
-            break;
-         default:
-            scr = 0;
-            break;
-      }
-   }
-
-   // Write actual numbers
-   for ( ; i ; --i)
-      num += _inschar (_out, dst++, (bf[i-1] - bf[i]*10) + '0');
-
-   return num;
+   p = _u64toa_r ((uint64_t)absv, end);
+   return _insdigits (sk, fs, sign, p, (int)(end - p));
 }
 
 /*!
  * \brief
- *    Writes an hexadecimal value into a string, using the given lead
- *    character width & capital parameters. To convert spreads an integer in
- *    to an array discarding one LBS at a time (4bits). After that takes the last
- *    digit of each and stream it to string.
- *
- *    For example the number 1234 will expand as:
- *      [0]: 0x1234
- *      [1]: 0x123
- *      [2]: 0x12
- *      [3]: 0x1
- *      [4]: 0x0
- *      After that it streams '1', '2', '3', and '4'
+ *    Writes an hexadecimal value, using the given lead character width &
+ *    capital parameters. One nibble per digit \sa _u64tox_r().
  *
- * \param dst    destination string.
- * \param lead   Leading character.
- * \param width  Minimum integer width.
- * \param maj    Indicates if the letters must be printed in lower- or upper-case.
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
  * \param value  Hexadecimal value.
  *
  * \return  The number of char written
  */
-static int _inshex (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, unsigned int value)
+static int _inshex (_io_sink_t *sk, _io_frm_spec_t *fs, unsigned long long value)
 {
-   int num = 0, i, j;
-   unsigned int bf[_IO_MAX_INT_DIGITS];
-
-   // Spread value
-   for (i=0, bf[0]=value ; i<_IO_MAX_INT_DIGITS-1 ; ) {
-      bf[i+1] = bf[i]>>4;
-      if (!bf[++i])
-         break;
-   }
+   char bf[_IO_MAX_INT64_DIGITS];
+   char *end = &bf[_IO_MAX_INT64_DIGITS];
+   char *p = _u64tox_r ((uint64_t)value, end, fs->type == INT_X);
 
-   // Write lead characters
-   for (j=i ; j<fs->width ; ++j)
-      num += _inschar (_out, dst++, fs->flags.lead);
+   return _insdigits (sk, fs, 0, p, (int)(end - p));
+}
 
-   // Write actual numbers
-   for ( ; i ; --i) {
-      if ((bf[i-1] & 0xF) < 0xA)
-         num += _inschar (_out, dst++, (bf[i-1] & 0xF) + '0');
-      else if (fs->type == INT_X)
-         num += _inschar (_out, dst++, ((bf[i-1] & 0xF) - 0xA) + 'A');
-      else
-         num += _inschar (_out, dst++, ((bf[i-1] & 0xF) - 0xA) + 'a');
+/*!
+ * \brief
+ *    Writes the digits \a d[from, to) of a (digits, dp) decimal, filling
+ *    with zeros the positions outside the digit string.
+ *
+ * \param sk     Output sink.
+ * \param d      Pointer to digits.
+ * \param n      The number of digits.
+ * \param from   First position to write.
+ * \param to     One past the last position to write.
+ *
+ * \return  The number of char written
+ */
+static int _insdecpart (_io_sink_t *sk, const char *d, int n, int from, int to)
+{
+   int num = 0, run;
+
+   if (from < 0) {
+      run = (to < 0) ? to - from : -from;
+      num += _insnchar (sk, '0', run);
+      from += run;
+   }
+   if (from < n && from < to) {
+      run = ((to < n) ? to : n) - from;
+      _sink_write (sk, &d[from], (size_t)run);
+      num += run;
+      from += run;
    }
+   if (from < to)
+      num += _insnchar (sk, '0', to - from);
    return num;
 }
 
+/*!
+ * \brief
+ *    Writes an exponent, "e+4" style, in to \a bf.
+ * \return  The number of char written
+ */
+static int _fmtexp (char *bf, char e, int exp)
+{
+   char tmp[6];
+   char *end = &tmp[sizeof (tmp)];
+   char *p = _u32toa_r ((uint32_t)((exp < 0) ? -exp : exp), end);
+   int n = (int)(end - p);
+
+   bf[0] = e;
+   bf[1] = (exp < 0) ? '-' : '+';
+   memcpy ((void*)&bf[2], (const void*)p, (size_t)n);
+   return n + 2;
+}
 
 /*!
  * \brief
- *    Writes an floating point value into a string, using the given lead, width &
- *    sign parameters. The floating point is in decimal format.
+ *    Writes a (digits, dp) decimal in decimal format, with \a frac
+ *    fractional digits.
+ * \note
+ *    The decimal has to be already rounded to \a frac fractional digits.
  *
- * \param dst    destination string.
- * \param lead   Fill character.
- * \param width  Minimum integer width.
- * \param frac   Fractional width.
- * \param sign   Always print sign flag.
- * \param value  double value.
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
+ * \param sign   The sign character or 0 for none.
+ * \param d      Pointer to digits.
+ * \param n      The number of digits.
+ * \param dp     The decimal point position.
+ * \param frac   The fractional digits. The point is omitted for 0.
  *
  * \return  The number of char written
  */
-static int _inscoredouble (_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value)
+static int _insfixed (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n, int dp, int frac)
 {
-   int num, fr_num, n_int, n_dec, negative=0;
-   double absv, r_absv, scrl;
-   _io_frm_spec_t n_int_fs, n_dec_fs;
-
-   if (value<0) {
-      negative = 1;
-      absv = -value;
-   } else
-      absv = value;
-
-   // fix width
-   if (!fs->width)
-      fs->width = _IO_WIDTH;
-   // fix frac
-   if (!fs->frac)
-      fs->frac = _IO_FRACTIONAL_WIDTH;
-
-   // Calculate the n_int and n_dec parts
-   n_int = (int)absv;
-   scrl = _pw10 (fs->frac);   // Calculate the scroll multiplier
-   absv -= n_int;             // Cut the decimal part
-   absv *= scrl;              // Scroll the fractional part frac positions to the left
-   r_absv = round (absv);     // Round the scrolled frac part
-   if (r_absv >= scrl) {
-      // The rounding result, give us an integer "reminder"
-      ++n_int;
-      r_absv = 0;
+   int num, ilen = (dp > 0) ? dp : 1;
+
+   num = _inspad (sk, fs, sign, ilen + ((frac) ? frac+1 : 0));
+   num += _insdecpart (sk, d, n, (dp > 0) ? 0 : dp-1, dp);
+   if (frac) {
+      num += _inschar (sk, '.');
+      num += _insdecpart (sk, d, n, dp, dp + frac);
    }
-   n_dec = (int)r_absv;
-
-   /*
-    * Write the number
-    */
-   // Prepare n_int
-   n_int_fs.width = fs->width-fs->frac-1;
-   n_int_fs.frac = 0;
-   n_int_fs.flags.lead = fs->flags.lead;
-   n_int_fs.flags.plus = fs->flags.plus;
-   n_int_fs.flags.minus = n_int_fs.flags.sharp = 0;
-   // Prepare n_dec
-   n_dec_fs.width = fs->frac;
-   n_dec_fs.frac = 0;
-   n_dec_fs.flags.lead ='0';
-   n_dec_fs.flags.plus = n_int_fs.flags.minus = n_int_fs.flags.sharp = 0;
-
-   num = _insint (_out, dst, &n_int_fs, negative, n_int); // Insert the decimal part
-   dst += num;
-
-   num += _inschar (_out, dst++, '.');  // Insert point
-
-   fr_num = _insint (_out, dst, &n_dec_fs, 0, n_dec);  // Insert fractional
-   num += fr_num;          // Update counters
-   dst += fr_num;
-
-   // Write trailing zeros, if any
-   if (fr_num < fs->frac)
-      num += _insnchar (_out, dst, '0', fs->frac-fr_num);
    return num;
 }
 
 /*!
  * \brief
- *    Writes an floating point value into a string, using the given lead, width &
- *    sign parameters. The floating point is in decimal format.
- *    Supports also NaN and INF.
+ *    Writes a (digits, dp) decimal in scientific (exp) format, with
+ *    \a frac fractional digits.
+ * \note
+ *    The decimal has to be already rounded to \a frac+1 digits.
  *
- * \param dst    destination string.
- * \param lead   Fill character.
- * \param width  Minimum integer width.
- * \param frac   Fractional width.
- * \param sign   Always print sign flag.
- * \param value  double value.
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
+ * \param sign   The sign character or 0 for none.
+ * \param d      Pointer to digits.
+ * \param n      The number of digits.
+ * \param dp     The decimal point position.
+ * \param frac   The fractional digits. The point is omitted for 0.
  *
  * \return  The number of char written
  */
-static int _insfdouble(_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value)
+static int _insexp (_io_sink_t *sk, _io_frm_spec_t *fs, char sign, const char *d, int n, int dp, int frac)
 {
-   if ( isinf (value) )          // INF
-      return _insstring(_out, dst, "INF", 0);
-   else if ( isnan (value) )     // NAN
-      return _insstring(_out, dst, "NaN", 0);
-   else
-      return _inscoredouble (_out, dst, fs, value);
-   return 0;
+   char exp[8];
+   int num, nexp;
+   char e = (fs->type == FL_E || fs->type == FL_G) ? 'E' : 'e';
+
+   // Zero has exponent 0
+   nexp = _fmtexp (exp, e, (n && d[0] != '0') ? dp-1 : 0);
+   num = _inspad (sk, fs, sign, 1 + ((frac) ? frac+1 : 0) + nexp);
+   num += _insdecpart (sk, d, n, 0, 1);
+   if (frac) {
+      num += _inschar (sk, '.');
+      num += _insdecpart (sk, d, n, 1, 1 + frac);
+   }
+   _sink_write (sk, exp, (size_t)nexp);
+   return num + nexp;
 }
 
-
-
 /*!
  * \brief
- *    Writes an floating point value into a string, using the given lead, width &
- *    sign parameters. The floating point is in scientific (exp) format.
+ *    Writes a floating point value into a string, using the given lead,
+ *    width, frac & sign parameters. The value is converted to its round
+ *    trip digits \sa _dtoa_shortest() and then rounded to the requested
+ *    digits \sa _dround(), so there is no range limit and no precision loss.
  *    Supports also NaN and INF.
  *
- * \param dst    destination string.
- * \param lead   Fill character.
- * \param width  Minimum integer width.
- * \param frac   Fractional width.
- * \param sign   Always print sign flag.
+ *    - %f   Decimal format, default width 5 and 3 fractional digits.
+ *    - %e   Scientific format, default width 5 and 3 fractional digits.
+ *    - %g   With frac, frac significant digits in the shorter of %f, %e,
+ *           trailing zeros removed. Without frac, digits that read back to
+ *           the same double, almost always the shortest ones.
+ *
+ * \param sk     Output sink.
+ * \param fs     The format specifier.
  * \param value  double value.
  *
  * \return  The number of char written
  */
-static int _insedouble(_putc_out_t _out, char *dst, _io_frm_spec_t *fs, double value)
+static int _insdouble (_io_sink_t *sk, _io_frm_spec_t *fs, double value)
 {
-   int exp=0, num=0;
-   char exp_str[6];
-   int sexp, negative=0;
-   _io_frm_spec_t exp_fs;
+   char d[_NC_MAX_DIGITS];
+   char sign = (fs->flags.plus) ? '+' : 0;
+   int n, dp, P, X;
 
+   if (signbit (value)) {
+      sign = '-';
+      value = -value;
+   }
    if ( isinf (value) )          // INF
-      return _insstring(_out, dst, "INF", 0);
+      return _inspad (sk, fs, sign, 3) + _insstring (sk, "INF", 0);
    else if ( isnan (value) )     // NAN
-      return _insstring(_out, dst, "NaN", 0);
-   else if (value == 0)          // there is no such thing as Log10(0)
-      return _insstring(_out, dst, "0.0e0", 0);
-   else
-   {
-      if (value < 0) {
-         negative = 1;
-         exp = _floorlog10(-value);
-         if (value <-1 && (exp == -1 || exp > _IO_MAX_FLOAT_EXP))
-            return _insstring(_out, dst, "-BIG", 0);
-         if (value >-1 && exp < _IO_MIN_FLOAT_EXP)
-            return _insstring(_out, dst, "-0", 0);
+      return _inspad (sk, fs, 0, 3) + _insstring (sk, "NaN", 0);
+
+   n = _dtoa_shortest (value, d, &dp);
+   if (fs->type == FL_g || fs->type == FL_G) {
+      if (!fs->frac) {
+         // Round trip digits
+         P = _IO_G_SHORTEST_DIGITS;
+         if (fs->flags.sharp && P < n)
+            P = n;
       }
       else {
-         exp = _floorlog10(value);
-         if (value >1 && (exp == -1 || exp > _IO_MAX_FLOAT_EXP))
-            return _insstring(_out, dst, "+BIG", 0);
-         if (value <1 && exp < _IO_MIN_FLOAT_EXP)
-            return _insstring(_out, dst, "+0", 0);
+         P = fs->frac;
+         n = _dround (value, d, n, &dp, P);
       }
+      if (!n || d[0] == '0')
+         X = 0;
+      else
+         X = dp - 1;
+      if (!fs->flags.sharp)
+         P = (n) ? n : 1;
+      if (X < -4 || X >= ((fs->frac) ? fs->frac : _IO_G_SHORTEST_DIGITS))
+         return _insexp (sk, fs, sign, d, n, dp, P-1);
+      else
+         return _insfixed (sk, fs, sign, d, n, dp, (P-1-X > 0) ? P-1-X : 0);
+   }
 
-      value = value / _pw10(exp);
-      /*
-       * We don't use pow() and floor(log10()) ;-)
-       */
-
-      // Prepare exponential and use _putc_dst() for that.
-      exp_fs.width = exp_fs.frac = 0;
-      exp_fs.flags.lead = ' ';
-      exp_fs.flags.plus = 1;
-      exp_fs.flags.minus = exp_fs.flags.sharp = 0;
-      sexp = _inschar (_putc_dst, exp_str, 'e');   // Insert e
-      sexp += _insint (_putc_dst, &exp_str[1], &exp_fs, 0, exp);
-      exp_str[sexp]=0;
-
-
-      if (!fs->width)  fs->width = _IO_WIDTH;        // fix width
-      if (!fs->frac)   fs->frac = _IO_FRACTIONAL_WIDTH;   // fix frac
-      if (fs->width < sexp+fs->frac+2+(fs->flags.plus || negative))
-         fs->width = sexp+fs->frac+2+(fs->flags.plus || negative);
-      fs->width -= sexp;       // significant's width
-      /*
-       * Calculate width from users request (full number width)
-       *
-       * full width = sign(1) + int + dot(1) + frac + sexp
-       *                        |-------------------|
-       *                          significant width
-       *  int has minimum 1 size
-       */
-
-      // Insert results to string
-      num = _inscoredouble (_out, dst, fs, value);
-      dst += num;
-      num += _insstring(_out, dst, exp_str, 0);
-      return num;
+   // fix width and frac
+   if (!fs->width)   fs->width = _IO_WIDTH;
+   if (!fs->frac)    fs->frac = _IO_FRACTIONAL_WIDTH;
+   if (fs->type == FL_e || fs->type == FL_E) {
+      n = _dround (value, d, n, &dp, fs->frac+1);
+      return _insexp (sk, fs, sign, d, n, dp, fs->frac);
+   }
+   else {
+      n = _dround (value, d, n, &dp, dp + fs->frac);
+      return _insfixed (sk, fs, sign, d, n, dp, fs->frac);
    }
-   return 0;
 }
 
 /*!
@@ -739,6 +593,142 @@ static double _va_args_double(__VALIST ap) {
 }
  */
 
+/*!
+ * \brief
+ *    Type dispatcher. Writes an already fetched argument.
+ *
+ * \param sk      Output sink.
+ * \param fs      The format specifier.
+ * \param a       The argument, of \sa _io_arg_class() class.
+ *
+ * \return  The number of char written
+ */
+static int _insarg (_io_sink_t *sk, _io_frm_spec_t *fs, const _io_arg_t *a)
+{
+   _io_arg_class_en cl = _io_arg_class (fs);
+
+   if (cl == _IO_ARG_INT64)
+      return _insint64(sk, fs, a->ll);
+   else if (cl == _IO_ARG_UINT64) {
+      if (fs->type == INT_u)
+         return _insuint64(sk, fs, a->ull);
+      return _inshex(sk, fs, a->ull);
+   }
+   else if (fs->type == INT_d ||
+            fs->type == INT_i ||
+            fs->type == INT_l) {
+      // "hh" and "h" arguments are promoted, convert them back
+      if (fs->len == _IO_LEN_HH)       return _insint(sk, fs, (signed char)a->i);
+      else if (fs->len == _IO_LEN_H)   return _insint(sk, fs, (short)a->i);
+      return _insint(sk, fs, a->i);
+   }
+   else if (fs->type == INT_x ||
+            fs->type == INT_X ||
+            fs->type == INT_o) {
+      if (fs->len == _IO_LEN_HH)       return _inshex(sk, fs, (unsigned char)a->u);
+      else if (fs->len == _IO_LEN_H)   return _inshex(sk, fs, (unsigned short)a->u);
+      return _inshex(sk, fs, a->u);
+   }
+   else if (fs->type == INT_c)
+      return _inschar(sk, (char)a->u);
+   else if (fs->type == INT_s)
+      return _insstring (sk, a->s, fs->width);
+   else if (fs->type == FL_f ||
+            fs->type == FL_g ||
+            fs->type == FL_G ||
+            fs->type == FL_L ||
+            fs->type == FL_e ||
+            fs->type == FL_E)
+      return _insdouble (sk, fs, a->d);
+   else if (fs->len == _IO_LEN_HH)
+      return _insuint(sk, fs, (unsigned char)a->u);
+   else if (fs->len == _IO_LEN_H)
+      return _insuint(sk, fs, (unsigned short)a->u);
+   else  // INT_u and the wrong types as unsigned int
+      return _insuint(sk, fs, a->u);
+}
+
+/*!
+ * \brief
+ *    The formatting engine. The format comes either as a string \a frm,
+ *    parsed on the fly, or as a compiled op list \a op, if \a frm is null.
+ *
+ * \param sk      Output sink.
+ * \param frm     Format string, or null to use the op list.
+ * \param op      Compiled op list.
+ * \param nop     The number of ops.
+ * \param ap      Argument list.
+ *
+ * \return  The number of characters streamed.
+ */
+static int _vsxprintf (_io_sink_t *sk, const char *frm, const _io_op_t *op, int nop, __VALIST ap)
+{
+   _io_frm_obj_t obj;               /* object place holder */
+   _io_frm_obj_type_en  obj_type;   /* object type place holder */
+   _io_frm_spec_t *fs;              /* the current specifier */
+   _io_arg_t arg;                   /* the current argument */
+   const _io_op_t *end = op + nop;  /* op list end */
+   const char *lit;                 /* literal run start */
+   size_t start = sk->count;
+
+   while (1) {
+      if (frm) {
+         // Stream literal runs in one block
+         for (lit = frm ; *frm && IS_ALL_BUT_PC (*frm) ; ++frm)
+            ;
+         if (frm != lit)
+            _sink_write (sk, lit, (size_t)(frm - lit));
+         if (*frm == 0)
+            break;
+         frm += _io_read ((char*)frm, &obj, &obj_type);
+         fs = &obj.frm_specifier;
+      }
+      else {
+         if (op >= end)
+            break;
+         if (op->type == _IO_FRM_STREAM) {
+            _sink_write (sk, op->lit, (size_t)op->len);
+            ++op;
+            continue;
+         }
+         // Work on a copy, the inserters may fix width and frac
+         obj_type = op->type;
+         obj.frm_specifier = op->spec;
+         fs = &obj.frm_specifier;
+         ++op;
+      }
+      switch (obj_type) {
+         case _IO_FRM_STREAM:
+            _sink_putc (sk, obj.character);
+            break;
+         case _IO_FRM_SPECIFIER:
+            // Variable width reading
+            if (fs->flags.vwidth)
+               fs->width = va_arg(ap, signed int);
+            if (fs->flags.vfrac)
+               fs->frac = va_arg(ap, signed int);
+
+            // Fetch by class and dispatch
+            switch (_io_arg_class (fs)) {
+               case _IO_ARG_INT:    arg.i = va_arg(ap, signed int);     break;
+               case _IO_ARG_INT64:  arg.ll = va_arg(ap, long long);     break;
+               case _IO_ARG_UINT64: arg.ull = va_arg(ap, unsigned long long); break;
+               case _IO_ARG_DOUBLE: arg.d = va_arg(ap, double);         break;
+               case _IO_ARG_STR:    arg.s = va_arg(ap, char *);         break;
+               default:             arg.u = va_arg(ap, unsigned int);   break;
+            }
+            _insarg (sk, fs, &arg);
+            break;
+         case _IO_FRM_TERMINATOR:
+            _sink_putc (sk, 0);
+            break;
+         case _IO_FRM_CRAP:
+            break;
+      }
+   }
+   return (int)(sk->count - start);
+}
+
 /*
  * ============================ Public Functions ============================
  */
@@ -751,19 +741,173 @@ static double _va_args_double(__VALIST ap) {
 void _io_unused (void) {
    char tmp [2] = "0";
    _io_frm_spec_t tmp2 = {0};
+   _io_sink_t sk;
 
-   tbx_unused (_insint64 (_putc_usr, tmp, &tmp2, 0, 0) );
-   tbx_unused (_insuint64 (_putc_usr, tmp, &tmp2, 0));
+   _sink_init_str (&sk, tmp, sizeof (tmp));
+   tbx_unused (_insint64 (&sk, &tmp2, 0) );
+   tbx_unused (_insuint64 (&sk, &tmp2, 0));
 }
 
 /*!
  * \brief
- *    Stores the result of a formatted string into another string. Format
+ *    Initialize a string sink. Characters that do not fit in \a size-1
+ *    are dropped (but counted), so there is always room for the terminator.
+ *
+ * \param sk      Pointer to sink.
+ * \param dst     Destination string.
+ * \param size    The destination's size, including the terminator. Use
+ *                SIZE_MAX for unbounded destinations (sprintf family).
+ */
+void _sink_init_str (_io_sink_t *sk, char *dst, size_t size)
+{
+   sk->write = 0;
+   sk->ctx = 0;
+   sk->buf = dst;
+   sk->size = (size) ? size-1 : 0;
+   sk->len = sk->count = 0;
+   sk->term = (size) ? 1 : 0;
+}
+
+/*!
+ * \brief
+ *    Initialize a buffered sink.
+ *
+ * \param sk      Pointer to sink.
+ * \param write   The back-end's write function.
+ * \param ctx     The back-end's context, passed to write.
+ * \param buf     Pointer to the sink's buffer.
+ * \param size    The buffer's size.
+ */
+void _sink_init (_io_sink_t *sk, _io_write_ft write, void *ctx, char *buf, size_t size)
+{
+   sk->write = write;
+   sk->ctx = ctx;
+   sk->buf = buf;
+   sk->size = size;
+   sk->len = sk->count = 0;
+   sk->term = 0;
+}
+
+/*!
+ * \brief
+ *    Flush the sink's buffer to its back-end.
+ *
+ * \param sk      Pointer to sink.
+ * \return  The back-end's return value, or 0 if there was nothing to flush.
+ */
+int _sink_flush (_io_sink_t *sk)
+{
+   int ret = 0;
+
+   if (sk->write && sk->len)
+      ret = sk->write (sk->ctx, sk->buf, sk->len);
+   sk->len = 0;
+   return ret;
+}
+
+/*!
+ * \brief
+ *    Terminate a string sink's destination.
+ */
+void _sink_end_str (_io_sink_t *sk)
+{
+   if (sk->term)
+      sk->buf[sk->len] = 0;
+}
+
+/*!
+ * \brief
+ *    Stores the result of a formatted string to a sink. Format
  *    arguments are given in a va_list instance.
  *    First lexicon analysis is made to the frm
  *    Second the proper conversion function is called
- *    The procedure is continued until we reach \see PF_MAX_STRING_SIZE
- *    or NULL character..
+ *    The procedure is continued until we reach the NULL character.
+ * \note
+ *    The sink is not flushed or terminated. Use \sa _sink_flush() or
+ *    \sa _sink_end_str() when done.
+ *
+ * \param sk      Output sink.
+ * \param frm     Format string.
+ * \param ap      Argument list.
+ *
+ * \return  The number of characters streamed.
+ */
+int vsxprintf_sink (_io_sink_t *sk, const char *frm, __VALIST ap)
+{
+   return _vsxprintf (sk, frm, 0, 0, ap);
+}
+
+/*!
+ * \brief
+ *    Stores the result of a compiled format to a sink. Format arguments
+ *    are given in a va_list instance. The format is compiled on first
+ *    use if needed \sa io_frm_static(). If it does not fit in the op list
+ *    the format string is parsed instead.
+ * \note
+ *    The sink is not flushed or terminated. Use \sa _sink_flush() or
+ *    \sa _sink_end_str() when done.
+ *
+ * \param sk      Output sink.
+ * \param cf      Compiled format \sa _io_compile().
+ * \param ap      Argument list.
+ *
+ * \return  The number of characters streamed.
+ */
+int vsxprintf_frm (_io_sink_t *sk, _io_frm_t *cf, __VALIST ap)
+{
+   if (!cf->n && cf->frm && _io_compile (cf, cf->frm, cf->op, cf->size) < 0)
+      return _vsxprintf (sk, cf->frm, 0, 0, ap);
+   return _vsxprintf (sk, 0, cf->op, cf->n, ap);
+}
+
+/*!
+ * \brief
+ *    Stores the result of a compiled format to a sink, taking the arguments
+ *    from an array of already fetched ones. Each specifier takes one argument
+ *    of its \sa _io_arg_class(), plus one _IO_ARG_INT for each '*'. This is
+ *    the back-end of deferred formatting, where the arguments are captured
+ *    first and formatted later.
+ *
+ * \param sk      Output sink.
+ * \param cf      Compiled format \sa _io_compile().
+ * \param args    Pointer to the arguments.
+ * \param nargs   The number of arguments.
+ *
+ * \return  The number of characters streamed.
+ */
+int vsxprintf_args (_io_sink_t *sk, _io_frm_t *cf, const _io_arg_t *args, int nargs)
+{
+   const _io_op_t *op, *end;
+   _io_frm_spec_t fs;
+   size_t start = sk->count;
+
+   if (!cf->n && cf->frm && _io_compile (cf, cf->frm, cf->op, cf->size) < 0)
+      return 0;
+   for (op = cf->op, end = op + cf->n ; op < end ; ++op) {
+      if (op->type == _IO_FRM_STREAM)
+         _sink_write (sk, op->lit, (size_t)op->len);
+      else if (op->type == _IO_FRM_SPECIFIER) {
+         fs = op->spec;
+         if (fs.flags.vwidth && nargs-- > 0)
+            fs.width = (args++)->i;
+         if (fs.flags.vfrac && nargs-- > 0)
+            fs.frac = (args++)->i;
+         if (nargs-- <= 0)
+            break;
+         _insarg (sk, &fs, args++);
+      }
+   }
+   return (int)(sk->count - start);
+}
+
+/*!
+ * \brief
+ *    Stores the result of a formatted string into another string. Format
+ *    arguments are given in a va_list instance.
+ * \note
+ *    This is the legacy per character back-end interface. It forwards
+ *    to \sa vsxprintf_sink() with a string sink for _putc_dst and a
+ *    buffered sink for all the other back-ends.
  *
  * \param _out    callback function to use for output streaming
  * \param dst     Destination string (if any).
@@ -774,61 +918,20 @@ void _io_unused (void) {
  */
 int vsxprintf(_putc_out_t _out, char *dst, char *frm, __VALIST ap)
 {
-   _io_frm_obj_t obj;               /* object place holder */
-   _io_frm_obj_type_en  obj_type;   /* object type place holder */
-   char* dst_start = dst;           /* Destination starting address */
-
-   while (*frm != 0) {
-      frm += _io_read (frm, &obj, &obj_type);
-      switch (obj_type) {
-         case _IO_FRM_STREAM:
-            _out (dst++, obj.character);
-            break;
-         case _IO_FRM_SPECIFIER:
-            // Variable width reading
-            if (obj.frm_specifier.flags.vwidth)
-               obj.frm_specifier.width = va_arg(ap, signed int);
-            if (obj.frm_specifier.flags.vfrac)
-               obj.frm_specifier.frac = va_arg(ap, signed int);
-
-            // Type dispatcher
-            if (obj.frm_specifier.type == INT_d ||
-                obj.frm_specifier.type == INT_i ||
-                obj.frm_specifier.type == INT_l)
-               dst += _insint(_out, dst, &obj.frm_specifier, 0, va_arg(ap, signed int));
-            else if (obj.frm_specifier.type == INT_u)
-               dst += _insuint(_out, dst, &obj.frm_specifier, va_arg(ap, unsigned int));
-            else if (obj.frm_specifier.type == INT_x ||
-                     obj.frm_specifier.type == INT_X ||
-                     obj.frm_specifier.type == INT_o)
-               dst += _inshex(_out, dst, &obj.frm_specifier, va_arg(ap, unsigned int));
-            else if (obj.frm_specifier.type == INT_c)
-               dst += _inschar(_out, dst, va_arg(ap, unsigned int));
-            else if (obj.frm_specifier.type == INT_s)
-               dst += _insstring(_out, dst, va_arg(ap, char *), obj.frm_specifier.width);
-            else if (obj.frm_specifier.type == FL_f ||
-                     obj.frm_specifier.type == FL_g ||
-                     obj.frm_specifier.type == FL_G ||
-                     obj.frm_specifier.type == FL_L)
-               //dst += _insfdouble (_out, dst, &obj.frm_specifier, _va_args_double(ap)); // XXX
-               dst += _insfdouble (_out, dst, &obj.frm_specifier, va_arg(ap, double));
-            else if (obj.frm_specifier.type == FL_e ||
-                     obj.frm_specifier.type == FL_E)
-               //dst += _insedouble (_out, dst, &obj.frm_specifier, _va_args_double(ap)); // XXX
-               dst += _insedouble (_out, dst, &obj.frm_specifier, va_arg(ap, double)); // XXX
-            else  // eat the wrong type to unsigned int
-               dst += _insuint(_out, dst, &obj.frm_specifier, va_arg(ap, unsigned int));
-            break;
-            /*
-             * XXX: BUG workaround
-             */
-         case _IO_FRM_TERMINATOR:
-            _out (dst++, 0);
-            break;
-         case _IO_FRM_CRAP:
-            break;
-      }
+   _io_sink_t sk;
+   _putc_ctx_t pc = {_out, dst};
+   char bf[_IO_SINK_BUFFER_SIZE];
+   int ret;
+
+   if (_out == _putc_dst) {
+      _sink_init_str (&sk, dst, SIZE_MAX);
+      ret = vsxprintf_sink (&sk, frm, ap);
+      _sink_end_str (&sk);
+   }
+   else {
+      _sink_init (&sk, _write_putc, (void*)&pc, bf, sizeof (bf));
+      ret = vsxprintf_sink (&sk, frm, ap);
+      _sink_flush (&sk);
    }
-   _out (dst, 0); // NULL-terminated (final \0 is not counted)
-   return (int)(dst - dst_start);
+   return ret;
 }
@@ -23,21 +23,21 @@
  */
 #include <std/_vsxscanf.h>
 
-static int         _isspace (char c);
-static int          _isterm (char c);
-static int   _is_int_number (char c);
-static int   _is_hex_number (char c);
-static int  _is_real_number (char c);
+static int         _isspace (int c);
+static int          _isterm (int c);
+static int   _is_int_number (int c);
+static int   _is_hex_number (int c);
+static int  _is_real_number (int c);
 
 static int _stream_getfirst (_getc_in_t _in, const char *src, char **psrc);
-static int     _number_copy (_getc_in_t _in, _number_copy_type_en t, const char *src, char **psrc, char *dst);
+static int     _number_copy (_getc_in_t _in, _number_copy_type_en t, const char *src, char **psrc, char *dst, int size);
+
+static int   _parse_number (const char *s, const char *end, const _io_frm_spec_t *fs, _io_arg_t *a);
+static void     _store_arg (const _io_frm_spec_t *fs, void *p, const _io_arg_t *a);
 
 static int   _read_char (_getc_in_t _in, const char *src, char **psrc, char *ch);
-static int _read_string (_getc_in_t _in, const char *src, char **psrc, char *dst);
-static int   _read_uint (_getc_in_t _in, const char *src, char **psrc, unsigned int *dst);
-static int    _read_int (_getc_in_t _in, const char *src, char **psrc, int *dst);
-static int    _read_hex (_getc_in_t _in, const char *src, char **psrc, unsigned int *dst);
-static int _read_ffloat (_getc_in_t _in, const char *src, char **psrc, float *dst);
+static int _read_string (_getc_in_t _in, const char *src, char **psrc, char *dst, int width);
+static int _read_number (_getc_in_t _in, const char *src, char **psrc, const _io_frm_spec_t *fs, _io_arg_t *a);
 
 
 /*
@@ -55,7 +55,7 @@ static int _read_ffloat (_getc_in_t _in, const char *src, char **psrc, float *ds
  *    \arg  0  Non-whitespace
  *    \arg  1  Whitespace
  */
-static int _isspace (char c)
+static int _isspace (int c)
 {
    if (c == ' ' || c == '\t' || c == '\n' ||
        c == '\v' || c == '\f' || c == '\r')
@@ -68,14 +68,15 @@ static int _isspace (char c)
  * \brief
  *    Return true (1) if the given character \a c is a terminator.
  *   Terminator characters are:
- *       '\0' and EOF (-1)
+ *       '\0' and EOF (-1). Stream back ends return data bytes as
+ *       unsigned char, so a 0xFF byte is not a terminator.
  *
  * \param   c  The character to check
  * \return     The status of operation
  *    \arg  0  Non-terminator
  *    \arg  1  Terminator
  */
-static int _isterm (char c)
+static int _isterm (int c)
 {
    if (c == '\0' || c == -1)
       return 1;
@@ -92,7 +93,7 @@ static int _isterm (char c)
  *    \arg  0  Non number character
  *    \arg  1  Number character
  */
-static int _is_int_number (char c)
+static int _is_int_number (int c)
 {
    if ((c >= '0' && c <= '9') ||
        c == '-' || c == '+'
@@ -111,12 +112,12 @@ static int _is_int_number (char c)
  *    \arg  0  Non number character
  *    \arg  1  Number character
  */
-static int _is_hex_number (char c)
+static int _is_hex_number (int c)
 {
    if ((c >= '0' && c <= '9') ||
        (c >= 'A' && c <= 'F') ||
        (c >= 'a' && c <= 'f') ||
-       c == '-' || c == '+' || c == 'x'
+       c == '-' || c == '+' || c == 'x' || c == 'X'
       )
       return 1;
    else
@@ -132,7 +133,7 @@ static int _is_hex_number (char c)
  *    \arg  0  Non number character
  *    \arg  1  Number character
  */
-static int _is_real_number (char c)
+static int _is_real_number (int c)
 {
    if ((c >= '0' && c <= '9') ||
        c == '.' ||
@@ -171,18 +172,19 @@ static int _stream_getfirst (_getc_in_t _in, const char *src, char **psrc)
 /*!
  * \brief
  *    Copy the number characters from the stream to \a dst until
- *    a whitespace or termination character appears
+ *    a non number character appears or \a size characters are copied
  *
  * \param   _in   Callback function to use for input streaming
  * \param   src   Destination string (if any).
  * \param   dst   The pointer to return the first non-whitespace character
+ * \param   size  The maximum number of characters to copy
  *
  * \return        The number of number character from the stream
  */
-static int _number_copy (_getc_in_t _in, _number_copy_type_en t, const char *src, char **psrc, char *dst)
+static int _number_copy (_getc_in_t _in, _number_copy_type_en t, const char *src, char **psrc, char *dst, int size)
 {
    int ch, n=0;
-   int (*_isnumber) (char);
+   int (*_isnumber) (int);
 
    // Number type dispatch
    switch (t) {
@@ -198,7 +200,8 @@ static int _number_copy (_getc_in_t _in, _number_copy_type_en t, const char *src
    while ( _isnumber (ch) ) {
       *dst++ = ch;
       ch = _in (src, (char**)&src, _GETC_NEXT);
-      ++n;
+      if (++n > size)
+         break;
    }
    *dst = 0;               // Destination string termination
    *psrc = (char *)src;    // Update caller source pointer
@@ -236,11 +239,6 @@ inline int _getc_src (const char *src, char **psrc, _io_getc_read_en mode)
    }
 }
 
-inline int _getc_fil (const char *src, char **psrc, _io_getc_read_en mode)
-{
-   return 0;
-}
-
 
 
 
@@ -273,322 +271,248 @@ static int _read_char (_getc_in_t _in, const char *src, char **psrc, char *ch)
  * \param   src   Destination string (if any).
  * \param  psrc   Caller's source string pointer address
  * \param   dst   The pointer to return the string
+ * \param   width Maximum characters to read, 0 for no limit
  *
  * \return        The number of input stream characters read.
  */
-static int _read_string (_getc_in_t _in, const char *src, char **psrc, char *dst)
+static int _read_string (_getc_in_t _in, const char *src, char **psrc, char *dst, int width)
 {
    int ch, n=0;
    // Search for the first whitespace character
    ch = _in (src, (char**)&src, _GETC_HEAD);
-   ++n;
    while ( ! (_isspace (ch) || _isterm (ch)) ) {
       *dst++ = ch;
       ch = _in (src, (char**)&src, _GETC_NEXT);
-      ++n;
+      if (++n == width)
+         break;
    }
    *dst = 0;               // Destination string termination
    *psrc = (char *)src;    // Update caller source pointer
-   return n-1;
+   return n;
 }
 
 /*!
  * \brief
- *    Convert the unsigned int from input stream
+ *    Parse a number from a contiguous buffer based on the specifier's type.
  *
- * \param   _in   Callback function to use for input streaming
- * \param   src   Destination string (if any).
- * \param  psrc   Caller's source string pointer address
- * \param   dst   The pointer to return the number
+ * \param   s     Pointer to the first character
+ * \param   end   Pointer to the end of the input (or of the field width)
+ * \param   fs    Pointer to format specifier
+ * \param   a     Pointer to return the number
  *
- * \return        The number of input stream characters read.
+ * \return        The number of characters consumed, 0 for no number
  */
-static int _read_uint (_getc_in_t _in, const char *src, char **psrc, unsigned int *dst)
+__O3__ static int _parse_number (const char *s, const char *end, const _io_frm_spec_t *fs, _io_arg_t *a)
 {
-   char num_str[_IO_MAX_INT_DIGITS];      // number string
-   unsigned int result = 0;               // The converted value
-   int str_pos, num_pos;   // fake pointers
-   int n = 0;              // The read characters
-   char got_crap=0;        // Got crap flag
-
-   // Init pointers
-   num_pos = 1;
-   str_pos = _number_copy (_in, _INT, src, psrc, num_str);
-   if (str_pos == 0)
-      return 0;
-   else
-      --str_pos;
-
-   // Conversion loop
-   do {
-      if ( got_crap && IS_0TO9 (num_str[str_pos]) ) {
-         // Start over
-         got_crap = 0;
-         num_pos = 1;
-         result = (num_str[str_pos] - '0');
-      }
-      else if ( !got_crap && IS_0TO9 (num_str[str_pos]) )
-         result += (num_str[str_pos] - '0') * num_pos;
-      else {
-         // crap, start over
-         got_crap = 1;
-      }
-      // update pointers
-      num_pos *= 10;
-      ++n;
-   } while (str_pos--);
+   int sign=0, n;
+   int64_t i;
 
-   *dst = result;
-   return n;
+   switch (_io_arg_class (fs)) {
+      case _IO_ARG_INT:
+      case _IO_ARG_INT64:
+         n = _atoi64 (s, end, &i);
+         a->ll = i;
+         return n;
+
+      case _IO_ARG_DOUBLE:
+         return _atod (s, end, &a->d);
+
+      default:
+         // Unsigned numbers take an optional sign as strtoul() does
+         if (s < end && (IS_MINUS (*s) || IS_PLUS (*s)))
+            sign = 1;
+         if (fs->type == INT_x || fs->type == INT_X || fs->type == INT_o)
+            n = _xtou64 (s+sign, end, (uint64_t*)&a->ull);
+         else
+            n = _atou64 (s+sign, end, (uint64_t*)&a->ull);
+         if (!n)
+            return 0;
+         if (sign && IS_MINUS (*s))
+            a->ull = 0 - a->ull;
+         return n + sign;
+   }
 }
 
 /*!
  * \brief
- *    Convert the signed int from input stream
- *
- * \param   _in   Callback function to use for input streaming
- * \param   src   Destination string (if any).
- * \param  psrc   Caller's source string pointer address
- * \param   dst   The pointer to return the number
+ *    Store a parsed number to the argument's pointer based on the
+ *    specifier's type and length modifier.
  *
- * \return        The number of input stream characters read.
+ * \param   fs    Pointer to format specifier
+ * \param   p     The argument's pointer
+ * \param   a     Pointer to the parsed number
  */
-static int _read_int (_getc_in_t _in, const char *src, char **psrc, int *dst)
+static void _store_arg (const _io_frm_spec_t *fs, void *p, const _io_arg_t *a)
 {
-   char num_str[_IO_MAX_INT_DIGITS];   // number string
-   int result = 0;                     // The converted value
-   int str_pos, num_pos;   // fake pointers
-   int n = 0;              // The read characters
-   int sign = 1;           // The sign, start positive
-   char got_crap=0;        // Got crap flag
-
-   // Init pointers
-   num_pos = 1;
-   str_pos = _number_copy (_in, _INT, src, psrc, num_str);
-   if (str_pos == 0)
-      return 0;
-   else
-      --str_pos;
-
-   // Conversion loop
-   do {
-      if ( got_crap && IS_0TO9 (num_str[str_pos]) ) {
-         // Start over
-         got_crap = 0;
-         num_pos = sign = 1;
-         result = (num_str[str_pos] - '0');
-      }
-      else if ( !got_crap && IS_0TO9 (num_str[str_pos]) )
-         result += (num_str[str_pos] - '0') * num_pos;
-      else if (!got_crap && IS_MINUS (num_str[str_pos]) )
-         sign *= -1;
-      else if (!got_crap && IS_PLUS (num_str[str_pos]) )
-         ;  // Do not change sign
-      else {
-         // crap, start over
-         got_crap = 1;
-      }
-      // update pointers
-      num_pos *= 10;
-      ++n;
-   } while (str_pos--);
-
-   *dst = result * sign;
-   return n;
+   switch (_io_arg_class (fs)) {
+      case _IO_ARG_INT:
+      case _IO_ARG_INT64:
+         switch (fs->len) {
+            case _IO_LEN_HH:  *(signed char *)p = (signed char)a->ll;   break;
+            case _IO_LEN_H:   *(short *)p = (short)a->ll;               break;
+            case _IO_LEN_L:   *(long *)p = (long)a->ll;                 break;
+            case _IO_LEN_LL:  *(long long *)p = a->ll;                  break;
+            default:          *(int *)p = (int)a->ll;                   break;
+         }
+         break;
+      case _IO_ARG_DOUBLE:
+         if (fs->len == _IO_LEN_L || fs->len == _IO_LEN_LL)
+            *(double *)p = a->d;
+         else
+            *(float *)p = (float)a->d;
+         break;
+      default:
+         switch (fs->len) {
+            case _IO_LEN_HH:  *(unsigned char *)p = (unsigned char)a->ull;    break;
+            case _IO_LEN_H:   *(unsigned short *)p = (unsigned short)a->ull;  break;
+            case _IO_LEN_L:   *(unsigned long *)p = (unsigned long)a->ull;    break;
+            case _IO_LEN_LL:  *(unsigned long long *)p = a->ull;              break;
+            default:          *(unsigned int *)p = (unsigned int)a->ull;      break;
+         }
+         break;
+   }
 }
 
 /*!
  * \brief
- *    Convert the unsigned int (hexadimal) from input stream
+ *    Convert a number from input stream. The number characters are copied
+ *    to a local buffer first and then parsed \sa _parse_number().
  *
  * \param   _in   Callback function to use for input streaming
  * \param   src   Destination string (if any).
  * \param  psrc   Caller's source string pointer address
- * \param   dst   The pointer to return the number
+ * \param   fs    Pointer to format specifier
+ * \param   a     Pointer to return the number
  *
- * \return        The number of input stream characters read.
+ * \return        The number of input stream characters read, 0 for no number.
  */
-static int _read_hex (_getc_in_t _in, const char *src, char **psrc, unsigned int *dst)
+static int _read_number (_getc_in_t _in, const char *src, char **psrc, const _io_frm_spec_t *fs, _io_arg_t *a)
 {
-   char num_str[_IO_MAX_INT_DIGITS];      // number string
-   unsigned int result = 0;               // The converted value
-   int str_pos, num_pos;   // fake pointers
-   int n = 0;              // The read characters
-   enum {NORMAL, _X, _0, CRAP} state = NORMAL;
-
-   // Init pointers
-   num_pos = 1;
-   str_pos = _number_copy (_in, _HEX, src, psrc, num_str);
-   if (str_pos == 0)
+   char num_str[_IO_MAX_SCAN_DIGITS];  // number string
+   _number_copy_type_en t;
+   int n, size = _IO_MAX_SCAN_DIGITS-1;
+
+   switch (_io_arg_class (fs)) {
+      case _IO_ARG_DOUBLE:    t = _FLOAT; break;
+      case _IO_ARG_INT:
+      case _IO_ARG_INT64:     t = _INT;   break;
+      default:
+         t = (fs->type == INT_x || fs->type == INT_X || fs->type == INT_o) ? _HEX : _INT;
+         break;
+   }
+   if (fs->width && fs->width < size)
+      size = fs->width;
+   if ((n = _number_copy (_in, t, src, psrc, num_str, size)) == 0)
       return 0;
-   else
-      --str_pos;
-
-   // Conversion loop
-   do {
-      switch (state) {
-         default:
-         case NORMAL:
-            if ( IS_0TO9 (num_str[str_pos]) )
-               result += (num_str[str_pos] - '0') * num_pos;
-            else if ( IS_ATOF (num_str[str_pos]) )
-               result += (num_str[str_pos] - 'A' + 0x0A) * num_pos;
-            else if ( IS_aTOf (num_str[str_pos]) )
-               result += (num_str[str_pos] - 'a' + 0x0A) * num_pos;
-            else if (num_str[str_pos] == 'x')
-               state = _X;
-            else
-               state = CRAP;
-            break;
-         case _X:
-            if (num_str[str_pos] == '0')
-               state = _0;
-            else
-               state = CRAP;
-            break;
-         case _0:
-            // More character? CRAP
-            state = CRAP;
-            /*
-             * Do not break. Switch to CRAP NOW!!
-             */
-         case CRAP:
-            if ( IS_0TO9 (num_str[str_pos]) ) {
-               // Start over
-               state = NORMAL;
-               num_pos = 1;
-               result = (num_str[str_pos] - '0');
-            }
-            else if ( IS_ATOF (num_str[str_pos]) ) {
-               // Start over
-               state = NORMAL;
-               num_pos = 1;
-               result = (num_str[str_pos] - 'A' + 0x0A);
-            }
-            else if ( IS_aTOf (num_str[str_pos]) ) {
-               // Start over
-               state = NORMAL;
-               num_pos = 1;
-               result = (num_str[str_pos] - 'a' + 0x0A);
-            }
-            break;
-      }
-
-      // update pointers
-      num_pos *= 0x10;
-      ++n;
-   } while (str_pos--);
-
-   *dst = result;
-   return n;
+   return (_parse_number (num_str, num_str + n, fs, a)) ? n : 0;
 }
 
+/*!
+ * Format reader. Reads objects from a format string, or from a compiled
+ * op list expanding its literal runs to stream characters.
+ */
+typedef struct {
+   const char     *frm;    /*!< Format string, or null to use the op list */
+   const _io_op_t *op;     /*!< The current op */
+   const _io_op_t *end;    /*!< The op list's end */
+   const char     *lit;    /*!< The current literal run */
+   int            len;     /*!< The current literal run's remaining characters */
+}_frm_reader_t;
+
 /*!
  * \brief
- *    Convert the double from input stream
+ *    Read the next object of the format.
  *
- * \param   _in   Callback function to use for input streaming
- * \param   src   Destination string (if any).
- * \param  psrc   Caller's source string pointer address
- * \param   dst   The pointer to return the number
- *
- * \return        The number of input stream characters read.
+ * \param   rd    Pointer to format reader
+ * \param   obj   Pointer to return the read object
+ * \param   type  Pointer to return the read object type
+ * \return  The status of operation
+ *    \arg  0  End of format
+ *    \arg  1  Object read
  */
-static int _read_ffloat (_getc_in_t _in, const char *src, char **psrc, float *dst)
+static int _frm_next (_frm_reader_t *rd, _io_frm_obj_t *obj, _io_frm_obj_type_en *type)
 {
-   char num_str[_IO_MAX_DOUBLE_WIDTH];    // number string
-   int n;                                 // The read characters
-   int f;                                 // fractional index counters
-   int n_dec=0;                           // Decimal part
-   float n_frac=0;                        // Fractional part
-   float frac_pos = 0.1;                  // Fractional pos/multiplier
-
-   // Get string
-   n = _number_copy (_in, _FLOAT, src, psrc, num_str);
-   if (n == 0) return 0;
-   else        --n;
-
-   // Find dot if any
-   for (f=0; f<_IO_MAX_DOUBLE_WIDTH; ++f) {
-      if ( IS_DOT (num_str[f]) )
-         break;
+   if (rd->frm) {
+      if (*rd->frm == 0)
+         return 0;
+      rd->frm += _io_read ((char *)rd->frm, obj, type);
+      return 1;
    }
-
-   // Conversions
-   if (f != _IO_MAX_DOUBLE_WIDTH) {
-      // Fractional part conversion loop
-      ++f;
-      n_frac = 0;
-      do {
-         if ( IS_0TO9 (num_str[f]) )
-            n_frac += (num_str[f] - '0') * frac_pos;
-         else
-            break;
-         // update pointers
-         frac_pos *= 0.1;
-         ++f;
-      } while (num_str[f] && f<_IO_MAX_DOUBLE_WIDTH);
+   if (!rd->len) {
+      if (rd->op >= rd->end)
+         return 0;
+      if (rd->op->type != _IO_FRM_STREAM) {
+         *type = rd->op->type;
+         obj->frm_specifier = rd->op->spec;
+         ++rd->op;
+         return 1;
+      }
+      rd->lit = rd->op->lit;
+      rd->len = rd->op->len;
+      ++rd->op;
    }
-   _read_int (_getc_src, num_str, (char **)&num_str, &n_dec);
-
-   if (n_dec<0)
-      *dst = n_dec - n_frac;
-   else
-      *dst = n_dec + n_frac;
-   return n;
+   *type = _IO_FRM_STREAM;
+   obj->character = *rd->lit++;
+   --rd->len;
+   return 1;
 }
 
-/*
- * ============================ Public Functions ============================
- */
-
 /*!
  * \brief
- *    Stores the result of a formatted string into another string. Format
- *    arguments are given in a va_list instance.
- *    First lexicon analysis is made to the pfrm
- *    Second the proper conversion function is called
- *    The procedure is continued until we reach \see PF_MAX_STRING_SIZE
- *    or NULL character..
+ *    The scanning engine. The format comes from a format reader, so it
+ *    can be either a format string or a compiled op list.
+ *    When the input is a string (\sa _getc_src()) the engine works directly
+ *    on the string and the numbers are parsed in place, without the per
+ *    character callback and the copy to a local buffer.
  *
  * \param _in     callback function to use for input streaming
  * \param src     Destination string (if any).
- * \param frm     Format string.
+ * \param rd      Format reader.
  * \param ap      Argument list.
  *
- * \return  The number of characters read.
+ * \return  The number of parsed arguments.
  */
-
-
-int vsxscanf (_getc_in_t _in, const char *src, const char *frm, __VALIST ap)
+static int _vsxscanf (_getc_in_t _in, const char *src, _frm_reader_t *rd, __VALIST ap)
 {
    _io_frm_obj_t obj;               /* object place holder */
    _io_frm_obj_type_en  obj_type;   /* object type place holder */
+   _io_arg_t a;                     /* parsed number */
+   const char *end=0, *lim;         /* contiguous input's end and field's end */
+   char *p;
    int arg=0;                       /* Number of parsed arguments */
-   int ch=0;
+   int ch=0, n;
+   int fast = (_in == _getc_src);
 
-   while (*frm != 0) {
+   if (fast)
+      end = src + strlen (src);
+   while (1) {
       // Read the format string and skip spaces
-      while (1) {
-         frm += _io_read ((char *)frm, &obj, &obj_type);
-         if (obj_type != _IO_FRM_STREAM)
-            break;
-         else if (!_isspace (obj.character))
-            break;
-      }
+      do {
+         if (!_frm_next (rd, &obj, &obj_type))
+            return arg;
+      } while (obj_type == _IO_FRM_STREAM && _isspace (obj.character));
+
       // Skip source string's spaces
-      if ((ch = _stream_getfirst (_in, src, (char**)&src)) == 0)
+      if (fast) {
+         while (src < end && _isspace (*src))
+            ++src;
+         ch = (unsigned char)*src;
+      }
+      else
+         ch = _stream_getfirst (_in, src, (char**)&src);
+      if (ch == 0 || ch == -1)
          return arg;
 
       // Dispatch based on object type
       switch (obj_type) {
          case _IO_FRM_STREAM:
-            if (obj.character != ch) {
+            if (obj.character != (char)ch) {
                // Matching error
                return arg;
             }
             // Discard matching character
-            _in (src, (char**)&src, _GETC_NEXT);
+            if (fast)   ++src;
+            else        _in (src, (char**)&src, _GETC_NEXT);
             break;
 
          case _IO_FRM_SPECIFIER:
@@ -598,32 +522,32 @@ int vsxscanf (_getc_in_t _in, const char *src, const char *frm, __VALIST ap)
             if (obj.frm_specifier.flags.vfrac)
                obj.frm_specifier.frac = va_arg(ap, signed int);
 
-            // Type dispatcher
-            if (obj.frm_specifier.type == INT_d ||
-                obj.frm_specifier.type == INT_i ||
-                obj.frm_specifier.type == INT_l)
-               _read_int (_in, src, (char**)&src, va_arg(ap, int*));
-            else if (obj.frm_specifier.type == INT_u)
-               _read_uint (_in, src, (char**)&src, va_arg(ap, unsigned int*));
-            else if (obj.frm_specifier.type == INT_x ||
-                     obj.frm_specifier.type == INT_X ||
-                     obj.frm_specifier.type == INT_o)
-               _read_hex (_in, src, (char**)&src, va_arg(ap, unsigned int*));
-            else if (obj.frm_specifier.type == INT_c)
-               _read_char (_in, src, (char**)&src, va_arg(ap, char*));
-            else if (obj.frm_specifier.type == INT_s)
-               _read_string (_in, src, (char**)&src, va_arg(ap, char*));
-            else if (obj.frm_specifier.type == FL_f ||
-                     obj.frm_specifier.type == FL_g ||
-                     obj.frm_specifier.type == FL_G ||
-                     obj.frm_specifier.type == FL_L)
-               _read_ffloat (_in, src, (char**)&src, va_arg(ap, float*));
-            else if (obj.frm_specifier.type == FL_e ||
-                     obj.frm_specifier.type == FL_E)
-               _read_ffloat (_in, src, (char**)&src, va_arg(ap, float*));
-            else  // eat the wrong type to unsigned int
-               _read_uint (_in, src, (char**)&src, va_arg(ap, unsigned int*));
+            lim = end;
+            if (fast && obj.frm_specifier.width > 0 && obj.frm_specifier.width < end - src)
+               lim = src + obj.frm_specifier.width;
 
+            // Type dispatcher
+            if (obj.frm_specifier.type == INT_c) {
+               if (fast)   *va_arg(ap, char*) = *src++;
+               else        _read_char (_in, src, (char**)&src, va_arg(ap, char*));
+            }
+            else if (obj.frm_specifier.type == INT_s) {
+               if (fast) {
+                  for (p = va_arg(ap, char*) ; src < lim && !_isspace (*src) ; )
+                     *p++ = *src++;
+                  *p = 0;
+               }
+               else
+                  _read_string (_in, src, (char**)&src, va_arg(ap, char*), obj.frm_specifier.width);
+            }
+            else {
+               // Numbers, the unknown types are read as unsigned int
+               if (fast)   src += (n = _parse_number (src, lim, &obj.frm_specifier, &a));
+               else        n = _read_number (_in, src, (char**)&src, &obj.frm_specifier, &a);
+               if (!n)
+                  return arg;    // Matching failure
+               _store_arg (&obj.frm_specifier, va_arg(ap, void*), &a);
+            }
             ++arg;
             break;
 
@@ -634,5 +558,54 @@ int vsxscanf (_getc_in_t _in, const char *src, const char *frm, __VALIST ap)
             return arg;
       }
    }
-   return (int)arg;
+   return arg;
+}
+
+/*
+ * ============================ Public Functions ============================
+ */
+
+/*!
+ * \brief
+ *    Read formatted data from a stream. Format arguments are given in
+ *    a va_list instance.
+ *    First lexicon analysis is made to the pfrm
+ *    Second the proper conversion function is called
+ *    The procedure is continued until we reach the NULL character.
+ *
+ * \param _in     callback function to use for input streaming
+ * \param src     Source string (if any).
+ * \param frm     Format string.
+ * \param ap      Argument list.
+ *
+ * \return  The number of parsed arguments.
+ */
+int vsxscanf (_getc_in_t _in, const char *src, const char *frm, __VALIST ap)
+{
+   _frm_reader_t rd = {frm, 0, 0, 0, 0};
+   return _vsxscanf (_in, src, &rd, ap);
+}
+
+/*!
+ * \brief
+ *    Read formatted data from a stream using a compiled format. Format
+ *    arguments are given in a va_list instance. The format is compiled on
+ *    first use if needed \sa io_frm_static(). If it does not fit in the op
+ *    list the format string is parsed instead.
+ *
+ * \param _in     callback function to use for input streaming
+ * \param src     Source string (if any).
+ * \param cf      Compiled format \sa _io_compile().
+ * \param ap      Argument list.
+ *
+ * \return  The number of parsed arguments.
+ */
+int vsxscanf_frm (_getc_in_t _in, const char *src, _io_frm_t *cf, __VALIST ap)
+{
+   _frm_reader_t rd = {0, cf->op, 0, 0, 0};
+
+   if (!cf->n && cf->frm && _io_compile (cf, cf->frm, cf->op, cf->size) < 0)
+      rd.frm = cf->frm;
+   rd.end = cf->op + cf->n;
+   return _vsxscanf (_in, src, &rd, ap);
 }
@@ -0,0 +1,520 @@
+/*!
+ * \file fstdio.c
+ * \brief
+ *    Buffered file streams with printf/scanf families on top of FatFs.
+ *
+ * this file is part of toolbox (std part)
+ *
+ * Copyright (C) 2026 Houtouridis Christos <houtouridis.ch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <std/fstdio.h>
+
+/*
+ * ========= Static ============
+ */
+
+/*!
+ * \brief
+ *    Keep the first error of the stream.
+ */
+static FRESULT _error (fstream_t *s, FRESULT r)
+{
+   if (r != FR_OK && s->err == FR_OK)
+      s->err = r;
+   return r;
+}
+
+/*!
+ * \brief
+ *    The free space of the write buffer. The buffered data always end at
+ *    a buffer size boundary of the file, so after the first write-back
+ *    the writes are whole and sector aligned.
+ */
+static inline UINT _room (fstream_t *s)
+{
+   return _IO_FILE_BUFFER_SIZE - (UINT)(s->fp->fptr % _IO_FILE_BUFFER_SIZE) - s->len;
+}
+
+#if !_FS_READONLY
+/*!
+ * \brief
+ *    Write back the buffered data.
+ */
+static FRESULT _drain (fstream_t *s)
+{
+   FRESULT r = FR_OK;
+   UINT bw;
+
+   if (s->mode == _FSTREAM_WRITE && s->len) {
+      r = f_write (s->fp, s->buf, s->len, &bw);
+      if (r == FR_OK && bw < s->len)
+         r = FR_DENIED;    // Disk full
+   }
+   s->len = s->pos = 0;
+   s->mode = _FSTREAM_IDLE;
+   return _error (s, r);
+}
+#endif
+
+/*!
+ * \brief
+ *    Drop the read ahead data and move the file's pointer back to the
+ *    first unread byte.
+ */
+static FRESULT _unread (fstream_t *s)
+{
+   FRESULT r = FR_OK;
+
+   if (s->mode == _FSTREAM_READ && s->pos < s->len)
+      r = f_lseek (s->fp, s->fp->fptr - (s->len - s->pos));
+   s->len = s->pos = 0;
+   s->mode = _FSTREAM_IDLE;
+   return _error (s, r);
+}
+
+/*!
+ * \brief
+ *    Release the buffer, whatever its mode.
+ */
+static FRESULT _release (fstream_t *s)
+{
+#if !_FS_READONLY
+   if (s->mode == _FSTREAM_WRITE)
+      return _drain (s);
+#endif
+   return _unread (s);
+}
+
+/*!
+ * \brief
+ *    Read ahead up to the next buffer size boundary of the file.
+ * \return  The number of bytes read, 0 on end of file or error.
+ */
+static UINT _fill (fstream_t *s)
+{
+   UINT br = 0;
+
+   if (s->mode != _FSTREAM_READ)
+      _release (s);
+   s->len = 0;
+   if (_error (s, f_read (s->fp, s->buf, _room (s), &br)) != FR_OK)
+      br = 0;
+   s->len = br;
+   s->pos = 0;
+   s->mode = _FSTREAM_READ;
+   return br;
+}
+
+/*!
+ * \brief
+ *    Return the head character without consuming it, or -1 on end of file.
+ */
+static inline int _peek (fstream_t *s)
+{
+   if (s->mode != _FSTREAM_READ || s->pos >= s->len)
+      if (!_fill (s))
+         return -1;
+   return (unsigned char)s->buf[s->pos];
+}
+
+/*
+ * ============================ Public Functions ============================
+ */
+
+/*
+ * Link and Glue functions
+ */
+
+#if !_FS_READONLY
+/*!
+ * \brief
+ *    Block back end for the file printf family sinks. \a ctx is the stream.
+ */
+int _write_fil (void *ctx, const char *src, size_t n)
+{
+   return fstream_write ((fstream_t *)ctx, src, n);
+}
+#endif
+
+/*!
+ * \brief
+ *    Character back end for the file scanf family. \a src is the stream,
+ *    the stream keeps its own position so \a psrc is not used.
+ *    Data bytes are returned as unsigned char, so a 0xFF byte is not
+ *    mistaken for the end of file (-1).
+ */
+int _getc_fil (const char *src, char **psrc, _io_getc_read_en mode)
+{
+   fstream_t *s = (fstream_t *)src;
+   int ch;
+
+   tbx_unused (psrc);
+   switch (mode) {
+      case _GETC_HEAD:  return _peek (s);
+      default:
+      case _GETC_READ:
+         if ((ch = _peek (s)) != -1)
+            ++s->pos;
+         return ch;
+      case _GETC_NEXT:
+         if (_peek (s) != -1)
+            ++s->pos;
+         return _peek (s);
+   }
+}
+
+/*
+ * Set functions
+ */
+
+/*!
+ * \brief
+ *    Attach a stream to an opened FatFs file. The stream starts at the
+ *    file's current pointer.
+ *
+ * \param   s     Pointer to stream
+ * \param   fp    Pointer to the opened file
+ */
+void fstream_init (fstream_t *s, FIL *fp)
+{
+   s->fp = fp;
+   s->len = s->pos = 0;
+   s->mode = _FSTREAM_IDLE;
+   s->err = FR_OK;
+}
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Write back any buffered data and synchronize the file, or drop the
+ *    read ahead data. After that the FatFs file's pointer is the stream's
+ *    position and the file can be used directly.
+ *
+ * \param   s     Pointer to stream
+ * \return  The first error of the stream, FR_OK on success
+ */
+FRESULT fstream_flush (fstream_t *s)
+{
+   _release (s);
+#if !_FS_READONLY
+   _error (s, f_sync (s->fp));
+#endif
+   return s->err;
+}
+
+/*!
+ * \brief
+ *    Flush the stream and close its file.
+ *
+ * \param   s     Pointer to stream
+ * \return  The first error of the stream, FR_OK on success
+ */
+FRESULT fstream_close (fstream_t *s)
+{
+   _release (s);
+   _error (s, f_close (s->fp));
+   return s->err;
+}
+
+/*!
+ * \brief
+ *    Return the first error of the stream.
+ */
+FRESULT fstream_error (fstream_t *s) {
+   return s->err;
+}
+
+#if !_FS_READONLY
+/*!
+ * \brief
+ *    Write a block to the stream. Whole buffer sized, aligned parts of
+ *    large blocks are written directly without copying them.
+ *
+ * \param   s     Pointer to stream
+ * \param   src   Pointer to data
+ * \param   n     The number of bytes
+ * \return  The number of bytes written
+ */
+int fstream_write (fstream_t *s, const void *src, size_t n)
+{
+   const char *p = (const char *)src;
+   UINT r, c, bw;
+   size_t w = 0;
+
+   if (s->mode != _FSTREAM_WRITE) {
+      _release (s);
+      s->mode = _FSTREAM_WRITE;
+   }
+   while (w < n && s->err == FR_OK) {
+      if (!s->len && !(s->fp->fptr % _IO_FILE_BUFFER_SIZE) && n - w >= _IO_FILE_BUFFER_SIZE) {
+         // Direct, aligned write
+         c = (UINT)((n - w) - (n - w) % _IO_FILE_BUFFER_SIZE);
+         if (_error (s, f_write (s->fp, p + w, c, &bw)) == FR_OK && bw < c)
+            _error (s, FR_DENIED);
+         w += bw;
+      }
+      else {
+         r = _room (s);
+         c = (n - w < r) ? (UINT)(n - w) : r;
+         memcpy ((void*)&s->buf[s->len], (const void*)(p + w), c);
+         s->len += c;
+         w += c;
+         if (c == r) {
+            _drain (s);
+            s->mode = _FSTREAM_WRITE;
+         }
+      }
+   }
+   return (int)w;
+}
+
+/*!
+ * \brief
+ *    Write a character to the stream.
+ *
+ * \param   s     Pointer to stream
+ * \param   c     The character
+ * \return  The character written, or -1 on error
+ */
+int fstream_putc (fstream_t *s, char c)
+{
+   if (s->mode == _FSTREAM_WRITE && _room (s) > 1) {
+      s->buf[s->len++] = c;
+      return (unsigned char)c;
+   }
+   return (fstream_write (s, &c, 1) == 1) ? (unsigned char)c : -1;
+}
+
+/*!
+ * \brief
+ *    Write a string to the stream, without its terminator.
+ *
+ * \param   s     Pointer to stream
+ * \param   str   The string
+ * \return  The number of characters written
+ */
+int fstream_puts (fstream_t *s, const char *str)
+{
+   return fstream_write (s, str, strlen (str));
+}
+#endif
+
+/*!
+ * \brief
+ *    Read a block from the stream. Whole buffer sized, aligned parts of
+ *    large blocks are read directly without copying them.
+ *
+ * \param   s     Pointer to stream
+ * \param   dst   Pointer to destination
+ * \param   n     The number of bytes
+ * \return  The number of bytes read, less than \a n at the end of file
+ */
+int fstream_read (fstream_t *s, void *dst, size_t n)
+{
+   char *p = (char *)dst;
+   UINT c, br;
+   size_t r = 0;
+
+   if (s->mode != _FSTREAM_READ)
+      _release (s);
+   while (r < n && s->err == FR_OK) {
+      if (s->mode == _FSTREAM_READ && s->pos < s->len) {
+         c = s->len - s->pos;
+         if (c > n - r)
+            c = (UINT)(n - r);
+         memcpy ((void*)(p + r), (const void*)&s->buf[s->pos], c);
+         s->pos += c;
+         r += c;
+      }
+      else if (!(s->fp->fptr % _IO_FILE_BUFFER_SIZE) && n - r >= _IO_FILE_BUFFER_SIZE) {
+         // Direct, aligned read
+         c = (UINT)((n - r) - (n - r) % _IO_FILE_BUFFER_SIZE);
+         if (_error (s, f_read (s->fp, p + r, c, &br)) != FR_OK || !br)
+            break;
+         r += br;
+      }
+      else if (!_fill (s))
+         break;
+   }
+   return (int)r;
+}
+
+/*!
+ * \brief
+ *    Read a character from the stream.
+ *
+ * \param   s     Pointer to stream
+ * \return  The character read, or -1 on end of file
+ */
+int fstream_getc (fstream_t *s)
+{
+   int ch;
+
+   if ((ch = _peek (s)) != -1)
+      ++s->pos;
+   return ch;
+}
+
+/*!
+ * \brief
+ *    Read a line from the stream, including the '\\n', up to \a size-1
+ *    characters.
+ *
+ * \param   s     Pointer to stream
+ * \param   dst   Pointer to destination string
+ * \param   size  The size of destination, including the terminator
+ * \return  The status of operation
+ *    \arg  NULL on end of file, with no characters read.
+ *    \arg  pointer to the destination string.
+ */
+char* fstream_gets (fstream_t *s, char *dst, int size)
+{
+   int ch, n = 0;
+
+   while (n < size-1 && (ch = fstream_getc (s)) != -1) {
+      dst[n++] = (char)ch;
+      if (ch == '\n')
+         break;
+   }
+   if (size > 0)
+      dst[n] = 0;
+   return (n) ? dst : 0;
+}
+
+#if !_FS_READONLY
+/*!
+ * \brief
+ *    Outputs a formatted string to the stream. Format arguments are given
+ *    in a va_list instance.
+ *
+ * \param s       Pointer to stream
+ * \param frm     Format string.
+ * \param ap      Argument list.
+ * \return  The number of characters written
+ */
+int vfstream_printf (fstream_t *s, const char *frm, __VALIST ap)
+{
+   _io_sink_t sk;
+   char bf[_IO_SINK_BUFFER_SIZE];
+   int result;
+
+   _sink_init (&sk, _write_fil, (void*)s, bf, sizeof (bf));
+   result = vsxprintf_sink (&sk, frm, ap);
+   _sink_flush (&sk);
+   return result;
+}
+
+/*!
+ * \brief
+ *    Outputs a formatted string to the stream, using a variable number
+ *    of arguments.
+ *
+ * \param s       Pointer to stream
+ * \param frm     Format string.
+ * \return  The number of characters written
+ */
+__Os__ int fstream_printf (fstream_t *s, const char *frm, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, frm);
+   result = vfstream_printf (s, frm, ap);
+   va_end(ap);
+   return result;
+}
+
+/*!
+ * \brief
+ *    Outputs a compiled format to the stream. Format arguments are given
+ *    in a va_list instance.
+ *
+ * \param s       Pointer to stream
+ * \param cf      Compiled format \sa io_frm_static(), _io_compile().
+ * \param ap      Argument list.
+ * \return  The number of characters written
+ */
+int vfstream_printf_frm (fstream_t *s, _io_frm_t *cf, __VALIST ap)
+{
+   _io_sink_t sk;
+   char bf[_IO_SINK_BUFFER_SIZE];
+   int result;
+
+   _sink_init (&sk, _write_fil, (void*)s, bf, sizeof (bf));
+   result = vsxprintf_frm (&sk, cf, ap);
+   _sink_flush (&sk);
+   return result;
+}
+
+/*!
+ * \brief
+ *    Outputs a compiled format to the stream, using a variable number
+ *    of arguments.
+ *
+ * \param s       Pointer to stream
+ * \param cf      Compiled format \sa io_frm_static(), _io_compile().
+ * \return  The number of characters written
+ */
+__Os__ int fstream_printf_frm (fstream_t *s, _io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, cf);
+   result = vfstream_printf_frm (s, cf, ap);
+   va_end(ap);
+   return result;
+}
+#endif
+
+/*!
+ * \brief
+ *    Read formatted data from the stream. Format arguments are given
+ *    in a va_list instance.
+ *
+ * \param s       Pointer to stream
+ * \param frm     Format string.
+ * \param ap      Argument list.
+ * \return  The number of parsed arguments.
+ */
+int vfstream_scanf (fstream_t *s, const char *frm, __VALIST ap)
+{
+   return vsxscanf (_getc_fil, (const char *)s, frm, ap);
+}
+
+/*!
+ * \brief
+ *    Read formatted data from the stream, using a variable number of
+ *    arguments.
+ *
+ * \param s       Pointer to stream
+ * \param frm     Format string.
+ * \return  The number of parsed arguments.
+ */
+__Os__ int fstream_scanf (fstream_t *s, const char *frm, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, frm);
+   result = vfstream_scanf (s, frm, ap);
+   va_end(ap);
+   return result;
+}
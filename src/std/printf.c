@@ -33,16 +33,7 @@
  */
 __Os__ int puts(const char *dst)
 {
-   int num = 0;
-
-   while (*dst != 0)
-   {
-      if (__putchar(*dst) == -1)
-         return -1;
-      num++;
-      dst++;
-   }
-   return num;
+   return _write_usr (0, dst, strlen (dst));
 }
 
 /*!
@@ -53,10 +44,37 @@ __Os__ int puts(const char *dst)
  * \param pfrmt  Format string.
  * \param ap  Argument list.
  */
-inline int vprintf(const char *frm, __VALIST ap)
+int vprintf(const char *frm, __VALIST ap)
+{
+   _io_sink_t sk;
+   char bf[_IO_SINK_BUFFER_SIZE];
+   int result;
+
+   // Forward call with a stack buffer, flushed in chunks
+   _sink_init (&sk, _write_usr, 0, bf, sizeof (bf));
+   result = vsxprintf_sink (&sk, frm, ap);
+   _sink_flush (&sk);
+   return result;
+}
+
+/*!
+ * \brief
+ *    Outputs a compiled format on the DBGU stream. Format arguments are
+ *    given in a va_list instance.
+ *
+ * \param cf     Compiled format \sa io_frm_static(), _io_compile().
+ * \param ap     Argument list.
+ */
+int vprintf_frm(_io_frm_t *cf, __VALIST ap)
 {
-   // Forward call NO buffer ;-)
-   return vsxprintf (_putc_usr, (char *)0, (char *)frm, ap);
+   _io_sink_t sk;
+   char bf[_IO_SINK_BUFFER_SIZE];
+   int result;
+
+   _sink_init (&sk, _write_usr, 0, bf, sizeof (bf));
+   result = vsxprintf_frm (&sk, cf, ap);
+   _sink_flush (&sk);
+   return result;
 }
 
 /*!
@@ -79,3 +97,23 @@ __Os__ int printf(const char *frm, ...)
    return result;
 }
 
+/*!
+ * \brief
+ *    Outputs a compiled format on the DBGU stream, using a variable number
+ *    of arguments.
+ *
+ * \param  cf     Compiled format \sa io_frm_static(), _io_compile().
+ */
+__Os__ int printf_frm(_io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   // Forward call to vprintf_frm
+   va_start(ap, cf);
+   result = vprintf_frm(cf, ap);
+   va_end(ap);
+
+   return result;
+}
+
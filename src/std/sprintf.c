@@ -43,7 +43,78 @@ inline int vsprintf(char *dst, const char *frm, va_list ap)
    return vsxprintf(_putc_dst, dst, (char *)frm, ap);
 }
 
+/*!
+ * \brief
+ *    Stores the result of a formatted string into another string, writing
+ *    at most \a size characters including the terminator. Format
+ *    arguments are given in a va_list instance.
+ *
+ * \param dst      Destination string.
+ * \param size     Destination's size.
+ * \param frm      Format string.
+ * \param ap       Argument list.
+ *
+ * \return  The number of characters that would have been written if size
+ *          was big enough, not counting the terminator.
+ */
+int vsnprintf(char *dst, size_t size, const char *frm, __VALIST ap)
+{
+   _io_sink_t sk;
+   int result;
+
+   _sink_init_str (&sk, dst, size);
+   result = vsxprintf_sink (&sk, frm, ap);
+   _sink_end_str (&sk);
+   return result;
+}
+
+
+
+/*!
+ * \brief
+ *    Stores the result of a compiled format into another string. Format
+ *    arguments are given in a va_list instance.
+ *
+ * \param dst      Destination string.
+ * \param cf       Compiled format \sa io_frm_static(), _io_compile().
+ * \param ap       Argument list.
+ *
+ * \return  The number of characters written.
+ */
+int vsprintf_frm(char *dst, _io_frm_t *cf, __VALIST ap)
+{
+   _io_sink_t sk;
+   int result;
+
+   _sink_init_str (&sk, dst, SIZE_MAX);
+   result = vsxprintf_frm (&sk, cf, ap);
+   _sink_end_str (&sk);
+   return result;
+}
+
+/*!
+ * \brief
+ *    Stores the result of a compiled format into another string, writing
+ *    at most \a size characters including the terminator.
+ *
+ * \param dst      Destination string.
+ * \param size     Destination's size.
+ * \param cf       Compiled format \sa io_frm_static(), _io_compile().
+ * \param ap       Argument list.
+ *
+ * \return  The number of characters that would have been written if size
+ *          was big enough, not counting the terminator.
+ */
+int vsnprintf_frm(char *dst, size_t size, _io_frm_t *cf, __VALIST ap)
+{
+   _io_sink_t sk;
+   int result;
 
+   _sink_init_str (&sk, dst, size);
+   result = vsxprintf_frm (&sk, cf, ap);
+   _sink_end_str (&sk);
+   return result;
+}
 
 /*!
  * \brief
@@ -65,3 +136,70 @@ __Os__ int sprintf(char *dst, const char *frm, ...)
    return result;
 }
 
+
+/*!
+ * \brief
+ *    Writes a formatted string inside another string, writing at most
+ *    \a size characters including the terminator.
+ *
+ * \param dst    storage string.
+ * \param size   storage's size.
+ * \param frm    Format string.
+ * \return  The number of characters that would have been written if size
+ *          was big enough, not counting the terminator.
+ */
+__Os__ int snprintf(char *dst, size_t size, const char *frm, ...)
+{
+   __VALIST ap;
+   int result;
+
+   // Forward call to vsnprintf
+   va_start(ap, (char *)frm);
+   result = vsnprintf(dst, size, frm, ap);
+   va_end(ap);
+
+   return result;
+}
+
+/*!
+ * \brief
+ *    Writes a compiled format inside another string.
+ *
+ * \param dst    storage string.
+ * \param cf     Compiled format \sa io_frm_static(), _io_compile().
+ * \return  The number of characters written.
+ */
+__Os__ int sprintf_frm(char *dst, _io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, cf);
+   result = vsprintf_frm(dst, cf, ap);
+   va_end(ap);
+
+   return result;
+}
+
+/*!
+ * \brief
+ *    Writes a compiled format inside another string, writing at most
+ *    \a size characters including the terminator.
+ *
+ * \param dst    storage string.
+ * \param size   storage's size.
+ * \param cf     Compiled format \sa io_frm_static(), _io_compile().
+ * \return  The number of characters that would have been written if size
+ *          was big enough, not counting the terminator.
+ */
+__Os__ int snprintf_frm(char *dst, size_t size, _io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, cf);
+   result = vsnprintf_frm(dst, size, cf, ap);
+   va_end(ap);
+
+   return result;
+}
@@ -41,6 +41,22 @@ inline int vsscanf (const char *src, const char *frm, __VALIST ap)
    return vsxscanf (_getc_src, src, (char *)frm, ap);
 }
 
+/*!
+ * \brief
+ *    Read formatted data from string into variable argument list, using a
+ *    compiled format.
+ *
+ * \param src      Source string.
+ * \param cf       Compiled format \sa io_frm_static(), _io_compile().
+ * \param ap       Argument list.
+ *
+ * \return  The function returns the number of items in the argument list successfully filled.
+ */
+int vsscanf_frm (const char *src, _io_frm_t *cf, __VALIST ap)
+{
+   return vsxscanf_frm (_getc_src, src, cf, ap);
+}
+
 /*!
  * \brief
  *    Read formatted data from string.
@@ -64,3 +80,23 @@ int sscanf (const char *src, const char *frm, ...)
    return result;
 }
 
+/*!
+ * \brief
+ *    Read formatted data from string, using a compiled format.
+ *
+ * \param src     source string.
+ * \param cf      Compiled format \sa io_frm_static(), _io_compile().
+ *
+ * \return        The number of items in the argument list successfully filled
+ */
+int sscanf_frm (const char *src, _io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, cf);
+   result = vsscanf_frm (src, cf, ap);
+   va_end(ap);
+
+   return result;
+}
@@ -32,26 +32,6 @@
 
 #include <std/stime.h>
 
-/*!
- *  days per month -- nonleap!
- */
-static const int _spm[13] =
-{
-   0,
-   (31),
-   (31+28),
-   (31+28+31),
-   (31+28+31+30),
-   (31+28+31+30+31),
-   (31+28+31+30+31+30),
-   (31+28+31+30+31+30+31),
-   (31+28+31+30+31+30+31+31),
-   (31+28+31+30+31+30+31+31+30),
-   (31+28+31+30+31+30+31+31+30+31),
-   (31+28+31+30+31+30+31+31+30+31+30),
-   (31+28+31+30+31+30+31+31+30+31+30+31),
-};
-
 /*!
  *  Time struct for conversions
  */
@@ -127,11 +107,120 @@ __Os__ time_t smktime (struct tm *_t)
                      *60 + _t->tm_sec  );    /* finally add seconds */
 }
 
+/*!
+ * \brief
+ *    Fill the date fields of a tm structure from the days since
+ *    1970-01-01. Constant time, using the 400 year era algorithm of
+ *    H. Hinnant with the year starting in March, so the leap day is the
+ *    last day of the year.
+ *
+ * \param  days     The days since 1970-01-01, can be negative
+ * \param  _tm      Pointer to tm structure to fill
+ */
+static void _days2civil (int32_t days, struct tm *_tm)
+{
+   int32_t  z = days + 719468;                      // Days since 0000-03-01
+   int32_t  era = ((z >= 0) ? z : z - 146096) / 146097;
+   uint32_t doe = (uint32_t)(z - era * 146097);     // [0, 146096]
+   uint32_t yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;  // [0, 399]
+   uint32_t doy = doe - (365*yoe + yoe/4 - yoe/100);// [0, 365] from March 1st
+   uint32_t mp  = (5*doy + 2) / 153;                // [0, 11] from March
+   int32_t  y = (int32_t)yoe + era * 400;
+
+   _tm->tm_mday = (int)(doy - (153*mp + 2)/5 + 1);
+   if (mp < 10) {
+      _tm->tm_mon = (int)mp + 2;
+      _tm->tm_yday = (int)doy + 59 + isleap (y);
+   }
+   else {
+      _tm->tm_mon = (int)mp - 10;
+      _tm->tm_yday = (int)doy - 306;
+      ++y;
+   }
+   _tm->tm_year = _YEAR_2_TM_YEAR (y);
+   _tm->tm_wday = (int)((days % 7 + 11) % 7);       // Day one was Thursday
+}
+
+/*!
+ * \brief
+ *    Uses the value pointed by timer to fill a tm structure with the values
+ *    that represent the corresponding time, expressed as a UTC time
+ *    (i.e., the time at the GMT timezone). This is the reentrant version
+ *    of \sa sgmtime(). It runs in constant time and accepts times before
+ *    the EPOCH.
+ *
+ * \param  _timer    A pointer to an object of type time_t that contains a time value.
+ * \param  _result   A pointer to the tm structure to fill.
+ * \return           The \a _result pointer.
+ */
+__O3__ struct tm *sgmtime_r (const time_t *_timer, struct tm *_result)
+{
+   #define _SPD   (86400)
+   int32_t days = (int32_t)(*_timer / _SPD);
+   int32_t secs = (int32_t)(*_timer % _SPD);
+
+   if (secs < 0) {
+      secs += _SPD;
+      --days;
+   }
+   _result->tm_sec = secs % 60;     secs /= 60;
+   _result->tm_min = secs % 60;
+   _result->tm_hour = secs / 60;
+   _result->tm_isdst = 0;
+   _days2civil (days, _result);
+
+   #undef _SPD
+   return _result;
+}
+
+/*!
+ * \brief
+ *    Convert an array of times to tm structures. Consecutive times of the
+ *    same day, as in a log, share the date calculation.
+ *
+ * \param  _timers   Pointer to the array of times.
+ * \param  _results  Pointer to the array of tm structures to fill.
+ * \param  n         The number of times.
+ */
+__O3__ void sgmtime_batch (const time_t *_timers, struct tm *_results, size_t n)
+{
+   #define _SPD   (86400)
+   int32_t days, secs, last = 0;
+   size_t i;
+
+   for (i=0 ; i<n ; ++i) {
+      days = (int32_t)(_timers[i] / _SPD);
+      secs = (int32_t)(_timers[i] % _SPD);
+      if (secs < 0) {
+         secs += _SPD;
+         --days;
+      }
+      _results[i].tm_sec = secs % 60;  secs /= 60;
+      _results[i].tm_min = secs % 60;
+      _results[i].tm_hour = secs / 60;
+      _results[i].tm_isdst = 0;
+      if (i && days == last) {
+         _results[i].tm_mday = _results[i-1].tm_mday;
+         _results[i].tm_mon  = _results[i-1].tm_mon;
+         _results[i].tm_year = _results[i-1].tm_year;
+         _results[i].tm_wday = _results[i-1].tm_wday;
+         _results[i].tm_yday = _results[i-1].tm_yday;
+      }
+      else
+         _days2civil (days, &_results[i]);
+      last = days;
+   }
+   #undef _SPD
+}
+
 /*!
  * \brief
  *    Uses the value pointed by timer to fill a tm structure with the values
  *    that represent the corresponding time, expressed as a UTC time
  *    (i.e., the time at the GMT timezone).
+ * \note
+ *    The result is a static object shared by all calls. Use \sa sgmtime_r()
+ *    from multiple threads.
  *
  * \param  _timer    A pointer to an object of type time_t that contains a time value.
  * \return           A pointer to a tm structure with its members filled with the values that
@@ -151,39 +240,7 @@ __Os__ time_t smktime (struct tm *_t)
  */
 __Os__ struct tm *sgmtime  (const time_t *_timer)
 {
-   #define _SPD   (86400)
-   time_t i, k;
-   time_t work = *_timer%_SPD;
-
-   _rt.tm_sec = work%60;    work /= 60;
-   _rt.tm_min = work%60;
-   _rt.tm_hour = work/60;   work = *_timer/_SPD;
-   _rt.tm_wday = (4+work)%7;   // Day one was Thursday
-   // Find the year
-   for (i=1970; 1 ; ++i) {
-      k = isleap(i) ? 366:365;
-      if (work >= k)
-         work -= k;
-      else
-         break;
-   }
-   _rt.tm_year = _YEAR_2_TM_YEAR (i);
-   _rt.tm_yday = work;
-   _rt.tm_mday = 1;
-   if (isleap(i) && (work>58)) {
-      if (work==59)  // Add leap day
-         _rt.tm_mday = 2;
-      work -= 1;
-   }
-
-   // Find month and month-day using struct tm month format
-   for (i=11; i && (_spm[i]>work); --i)
-      ;
-   _rt.tm_mon = i;
-   _rt.tm_mday += (work - _spm[i]);
-
-   #undef _SPD
-   return (struct tm *)&_rt;
+   return sgmtime_r (_timer, &_rt);
 }
 
 
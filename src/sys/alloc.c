@@ -0,0 +1,301 @@
+/*
+ * \file alloc.c
+ * \brief
+ *    Arena and fixed block pool allocators, with a pluggable allocator
+ *    hook for the toolbox modules that allocate their state.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sys/alloc.h>
+
+/*
+ * ========= Static ============
+ */
+static void* _heap_alloc (void *ctx, size_t n, size_t size) {
+   tbx_unused (ctx);
+   return calloc (n, size);
+}
+static void _heap_free (void *ctx, void *p) {
+   tbx_unused (ctx);
+   free (p);
+}
+
+static void* _arena_alloc (void *ctx, size_t n, size_t size) {
+   return arena_calloc ((arena_t*)ctx, n, size);
+}
+
+static void* _pool_alloc (void *ctx, size_t n, size_t size) {
+   pool_t *p = (pool_t*)ctx;
+   byte_t *b;
+
+   if (n * size > p->bsize || (b = pool_alloc (p)) == NULL)
+      return NULL;
+   memset ((void*)b, 0, p->bsize);
+   return (void*)b;
+}
+static void _pool_free (void *ctx, void *b) {
+   pool_free ((pool_t*)ctx, b);
+}
+
+/*!
+ * The default allocator, calloc()/free() based unless linked otherwise
+ */
+static const alc_t _heap = { _heap_alloc, _heap_free, 0 };
+static const alc_t *_default = &_heap;
+
+
+/*
+ * ======================   Public functions   ======================
+ */
+
+/*
+ * Link and Glue functions
+ */
+
+/*!
+ * \brief
+ *    Link the allocator to use when a module gets a null allocator.
+ * \param   alc   Pointer to allocator, or null to restore calloc()/free()
+ */
+void alc_link_default (const alc_t *alc) {
+   _default = (alc != 0) ? alc : &_heap;
+}
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Allocate zeroed memory for an array of n elements of size bytes each,
+ *    using the allocator \a alc.
+ * \param   alc   Pointer to allocator, or null for the default allocator
+ * \param   n     Number of elements
+ * \param   size  Size of each element
+ * \return  Pointer to the memory or NULL on failure
+ */
+void* alc_calloc (const alc_t *alc, size_t n, size_t size)
+{
+   if (!alc)   alc = _default;
+   return alc->alloc (alc->ctx, n, size);
+}
+
+/*!
+ * \brief
+ *    Release memory allocated with \sa alc_calloc() using the same allocator.
+ * \note
+ *    Arenas do not support individual free, so this has no effect on them.
+ * \param   alc   Pointer to allocator, or null for the default allocator
+ * \param   p     Pointer to memory to release (can be null)
+ */
+void alc_free (const alc_t *alc, void *p)
+{
+   if (!alc)   alc = _default;
+   if (p && alc->free)
+      alc->free (alc->ctx, p);
+}
+
+
+/*!
+ * \brief
+ *    Initialize an arena on top of a user's memory block
+ *    (usually a static array sized at compile time).
+ * \param   a     Pointer to arena
+ * \param   mem   Pointer to the memory block
+ * \param   size  The size of memory block in bytes
+ */
+void arena_init (arena_t *a, void *mem, size_t size)
+{
+   size_t off = (size_t)(-(uintptr_t)mem & (ALC_ALIGN-1));
+
+   // Align the arena's base
+   if (off > size)   off = size;
+   a->base = (byte_t*)mem + off;
+   a->size = size - off;
+   a->top = 0;
+}
+
+/*!
+ * \brief
+ *    Allocate \a size bytes from the arena. The memory is not zeroed.
+ * \param   a     Pointer to arena
+ * \param   size  The number of bytes
+ * \return  Pointer to the memory or NULL if the arena is exhausted
+ */
+__O3__ void* arena_alloc (arena_t *a, size_t size)
+{
+   void *p;
+
+   size = _alc_align (size);
+   if (size > a->size - a->top)
+      return NULL;
+   p = (void*)(a->base + a->top);
+   a->top += size;
+   return p;
+}
+
+/*!
+ * \brief
+ *    Allocate zeroed memory for an array of n elements from the arena.
+ * \param   a     Pointer to arena
+ * \param   n     Number of elements
+ * \param   size  Size of each element
+ * \return  Pointer to the memory or NULL if the arena is exhausted
+ */
+void* arena_calloc (arena_t *a, size_t n, size_t size)
+{
+   void *p;
+
+   if (size && n > (size_t)-1 / size)
+      return NULL;
+   if ((p = arena_alloc (a, n * size)) != NULL)
+      memset (p, 0, n * size);
+   return p;
+}
+
+/*!
+ * \brief
+ *    Return the current arena position, to use with \sa arena_rollback().
+ */
+inline size_t arena_mark (arena_t *a) {
+   return a->top;
+}
+
+/*!
+ * \brief
+ *    Release all allocations made after \a mark.
+ */
+void arena_rollback (arena_t *a, size_t mark) {
+   if (mark <= a->top)
+      a->top = mark;
+}
+
+/*!
+ * \brief
+ *    Release all the arena's allocations at once.
+ */
+inline void arena_reset (arena_t *a) {
+   a->top = 0;
+}
+
+/*!
+ * \brief
+ *    Return the number of bytes allocated from the arena.
+ */
+inline size_t arena_used (arena_t *a) {
+   return a->top;
+}
+
+/*!
+ * \brief
+ *    Fill an allocator hook that allocates from the arena \a a.
+ * \param   a     Pointer to arena
+ * \param   alc   Pointer to allocator hook to fill
+ */
+void arena_alc (arena_t *a, alc_t *alc) {
+   alc->alloc = _arena_alloc;
+   alc->free = 0;
+   alc->ctx = (void*)a;
+}
+
+
+/*!
+ * \brief
+ *    Initialize a fixed block pool on top of a user's memory block.
+ * \param   p     Pointer to pool
+ * \param   mem   Pointer to the memory block
+ * \param   size  The size of memory block in bytes
+ * \param   bsize The block size in bytes
+ * \return  The number of blocks in pool
+ */
+uint32_t pool_init (pool_t *p, void *mem, size_t size, size_t bsize)
+{
+   size_t off = (size_t)(-(uintptr_t)mem & (ALC_ALIGN-1));
+
+   if (bsize < sizeof (void*))
+      bsize = sizeof (void*);
+   if (off > size)   off = size;
+   p->base = (byte_t*)mem + off;
+   p->bsize = _alc_align (bsize);
+   p->blocks = (uint32_t)((size - off) / p->bsize);
+   pool_reset (p);
+   return p->blocks;
+}
+
+/*!
+ * \brief
+ *    Get a block from the pool. The memory is not zeroed.
+ * \param   p     Pointer to pool
+ * \return  Pointer to the block or NULL if the pool is empty
+ */
+__O3__ void* pool_alloc (pool_t *p)
+{
+   void *b;
+
+   if ((b = p->head) != NULL) {
+      p->head = *(void**)b;
+      --p->nfree;
+   }
+   return b;
+}
+
+/*!
+ * \brief
+ *    Return a block to the pool.
+ * \param   p     Pointer to pool
+ * \param   b     Pointer to block (can be null)
+ */
+__O3__ void pool_free (pool_t *p, void *b)
+{
+   if (!b)
+      return;
+   *(void**)b = p->head;
+   p->head = b;
+   ++p->nfree;
+}
+
+/*!
+ * \brief
+ *    Return all blocks to the pool at once.
+ */
+void pool_reset (pool_t *p)
+{
+   uint32_t i;
+
+   p->head = NULL;
+   for (i=p->blocks ; i>0 ; --i) {
+      *(void**)(p->base + (i-1)*p->bsize) = p->head;
+      p->head = (void*)(p->base + (i-1)*p->bsize);
+   }
+   p->nfree = p->blocks;
+}
+
+/*!
+ * \brief
+ *    Fill an allocator hook that allocates from the pool \a p.
+ * \note
+ *    Requests bigger than the pool's block size fail.
+ * \param   p     Pointer to pool
+ * \param   alc   Pointer to allocator hook to fill
+ */
+void pool_alc (pool_t *p, alc_t *alc) {
+   alc->alloc = _pool_alloc;
+   alc->free = _pool_free;
+   alc->ctx = (void*)p;
+}
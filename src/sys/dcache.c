@@ -0,0 +1,459 @@
+/*!
+ * \file dcache.c
+ * \brief
+ *    A target independent sector cache for block devices, to sit
+ *    between FatFs's diskio layer and the drivers.
+ *
+ *    The cache is fully associative with LRU replacement and write-back
+ *    of dirty lines. Misses read the whole run of missing sectors with one
+ *    back-end call into adjacent lines, and sequential reads also fetch
+ *    DC_READ_AHEAD sectors ahead. Requests as big as the cache bypass it.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sys/dcache.h>
+
+static dc_drive_t _dc[DC_NUMBER_OF_DRIVES];
+
+/*
+ * tools
+ */
+#define _bad_drive(_dr)    ((_dr)<0 || (_dr)>=DC_NUMBER_OF_DRIVES) ? 1:0
+#define _line_mem(_d, _i)  ((_d)->mem + (size_t)(_i)*DC_SECTOR_SIZE)
+
+/*
+ * ========= Static ============
+ */
+
+/*!
+ * \brief
+ *    Search the cache for a sector
+ * \param   d        Pointer to the cached drive
+ * \param   sector   The sector to search
+ * \return           The line holding the sector, or -1
+ */
+static int _lookup (dc_drive_t *d, uint32_t sector)
+{
+   for (int i=0 ; i<d->lines ; ++i)
+      if (d->line[i].valid && d->line[i].sector == sector)
+         return i;
+   return -1;
+}
+
+/*!
+ * \brief
+ *    Write back the dirty lines of the window [i, i+n). Dirty lines
+ *    with adjacent sectors are written with a single back-end call.
+ * \param   drv   The cached drive
+ * \param   i     The first line of the window
+ * \param   n     The number of lines
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On back-end error.
+ *    \arg  DRV_READY   On success.
+ */
+static drv_status_en _writeback (int drv, int i, int n)
+{
+   dc_drive_t *d = &_dc[drv];
+   int k, end = i + n;
+
+   while (i < end) {
+      if (!d->line[i].valid || !d->line[i].dirty) {
+         ++i;
+         continue;
+      }
+      for (k=i+1 ; k<end && d->line[k].valid && d->line[k].dirty
+                 && d->line[k].sector == d->line[k-1].sector + 1 ; ++k)
+         ;
+      if (!d->write || d->write (drv, d->line[i].sector, _line_mem (d, i), k-i) != DRV_READY)
+         return DRV_ERROR;
+      for ( ; i<k ; ++i)
+         d->line[i].dirty = 0;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Select a window of \a n adjacent lines to replace. This is the window
+ *    whose most recently used line is the oldest. Empty lines count as never used.
+ * \param   d     Pointer to the cached drive
+ * \param   n     The number of lines, 1 to d->lines
+ * \return  The first line of the window
+ */
+static int _victim (dc_drive_t *d, int n)
+{
+   uint32_t age, a, best_age = (uint32_t)-1;
+   int i, j, best = 0;
+
+   for (i=0 ; i+n <= d->lines ; ++i) {
+      for (age=0, j=i ; j<i+n ; ++j) {
+         a = (d->line[j].valid) ? d->line[j].used + 1 : 0;
+         if (a > age)
+            age = a;
+      }
+      if (age < best_age) {
+         best_age = age;
+         best = i;
+      }
+   }
+   return best;
+}
+
+/*!
+ * \brief
+ *    Allocate a window of \a n adjacent lines for the sectors from \a sector.
+ *    The window's dirty lines are written back first.
+ * \param   drv      The cached drive
+ * \param   sector   The first sector
+ * \param   n        The number of sectors
+ * \return  The first line of the window, or -1 on back-end error
+ */
+static int _alloc (int drv, uint32_t sector, int n)
+{
+   dc_drive_t *d = &_dc[drv];
+   int i = _victim (d, n);
+
+   if (_writeback (drv, i, n) != DRV_READY)
+      return -1;
+   for (int j=0 ; j<n ; ++j) {
+      d->line[i+j].sector = sector + j;
+      d->line[i+j].valid = 0;
+      d->line[i+j].dirty = 0;
+      d->line[i+j].used = ++d->tick;
+   }
+   return i;
+}
+
+/*!
+ * \brief
+ *    Read \a n sectors from the back-end to a window of adjacent lines.
+ * \param   drv      The cached drive
+ * \param   sector   The first sector
+ * \param   n        The number of sectors
+ * \return  The first line of the window, or -1 on back-end error
+ */
+static int _fill (int drv, uint32_t sector, int n)
+{
+   dc_drive_t *d = &_dc[drv];
+   int i;
+
+   if ((i = _alloc (drv, sector, n)) < 0)
+      return -1;
+   if (d->read (drv, sector, _line_mem (d, i), n) != DRV_READY)
+      return -1;
+   for (int j=0 ; j<n ; ++j)
+      d->line[i+j].valid = 1;
+   d->misses += n;
+   return i;
+}
+
+/*!
+ * \brief
+ *    Drop all lines without writing them back.
+ */
+static void _drop (dc_drive_t *d)
+{
+   for (int i=0 ; i<d->lines ; ++i)
+      d->line[i].valid = d->line[i].dirty = 0;
+}
+
+
+/*
+ * ============================ Public Functions ============================
+ */
+
+/*
+ * Link and Glue functions
+ */
+void dc_link_read (int drv, dc_read_ft fun) {
+   if (_bad_drive(drv))
+      return;
+   _dc[drv].read = fun;
+}
+void dc_link_write (int drv, dc_write_ft fun) {
+   if (_bad_drive(drv))
+      return;
+   _dc[drv].write = fun;
+}
+void dc_link_ioctl (int drv, dc_ioctl_ft fun) {
+   if (_bad_drive(drv))
+      return;
+   _dc[drv].ioctl = fun;
+}
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Initialise the cache of a drive.
+ * \param   drv   The cached drive
+ * \param   mem   Pointer to memory for the cache lines
+ * \param   size  The size of \a mem. The cache gets size/DC_SECTOR_SIZE
+ *                lines, up to DC_MAX_LINES.
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en dc_init (int drv, void *mem, size_t size)
+{
+   dc_drive_t *d;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_dc[drv];
+   if (!d->read || !mem || size < DC_SECTOR_SIZE)
+      return d->status = DRV_ERROR;
+
+   d->mem = (uint8_t*)mem;
+   d->lines = (size / DC_SECTOR_SIZE > DC_MAX_LINES) ? DC_MAX_LINES : (int)(size / DC_SECTOR_SIZE);
+   memset ((void*)d->line, 0, sizeof (d->line));
+   d->tick = d->next = 0;
+   d->hits = d->misses = 0;
+   return d->status = DRV_READY;
+}
+
+/*!
+ * \brief
+ *    De-initialise the cache of a drive. Dirty lines are written back.
+ * \param   drv   The cached drive
+ */
+void dc_deinit (int drv)
+{
+   if (_bad_drive(drv))
+      return;
+   if (_dc[drv].status == DRV_READY)
+      _writeback (drv, 0, _dc[drv].lines);
+   memset ((void*)&_dc[drv], 0, sizeof (dc_drive_t));
+   /*!<
+    * This leaves the status = DRV_NOINIT
+    */
+}
+
+/*!
+ * \brief
+ *    Read sector(s) through the cache.
+ * \param   drv    The cached drive
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data buffer to store read data
+ * \param   count  Sector count
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en dc_read (int drv, uint32_t sector, uint8_t *buf, size_t count)
+{
+   dc_drive_t *d;
+   int i, n, ra, seq;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_dc[drv];
+   if (d->status != DRV_READY || !buf || !count)
+      return DRV_ERROR;
+
+   if (count >= (size_t)d->lines) {
+      // Streaming read, bypass the cache. Dirty lines are newer than the media
+      if (d->read (drv, sector, buf, count) != DRV_READY)
+         return DRV_ERROR;
+      for (i=0 ; i<d->lines ; ++i)
+         if (d->line[i].dirty && d->line[i].sector - sector < count)
+            memcpy ((void*)(buf + (size_t)(d->line[i].sector - sector)*DC_SECTOR_SIZE),
+                    (const void*)_line_mem (d, i), DC_SECTOR_SIZE);
+      d->misses += count;
+      d->next = sector + count;
+      return DRV_READY;
+   }
+
+   seq = (sector == d->next);
+   while (count) {
+      if ((i = _lookup (d, sector)) >= 0) {
+         memcpy ((void*)buf, (const void*)_line_mem (d, i), DC_SECTOR_SIZE);
+         d->line[i].used = ++d->tick;
+         ++d->hits;
+         ++sector;
+         buf += DC_SECTOR_SIZE;
+         --count;
+         continue;
+      }
+      // Miss, read the run of missing sectors
+      for (n=1 ; (size_t)n<count && _lookup (d, sector+n) < 0 ; ++n)
+         ;
+      // and on sequential access what follows
+      ra = 0;
+      if (seq && (size_t)n == count)
+         for ( ; ra<DC_READ_AHEAD && n+ra<d->lines && _lookup (d, sector+n+ra) < 0 ; ++ra)
+            ;
+      if ((i = _fill (drv, sector, n+ra)) < 0) {
+         // The read ahead may run off the media
+         if (!ra || (i = _fill (drv, sector, n)) < 0)
+            return DRV_ERROR;
+      }
+      memcpy ((void*)buf, (const void*)_line_mem (d, i), (size_t)n*DC_SECTOR_SIZE);
+      sector += n;
+      buf += (size_t)n*DC_SECTOR_SIZE;
+      count -= n;
+   }
+   d->next = sector;
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Write sector(s) through the cache. The data stay in the cache
+ *    until they are evicted or synced \sa dc_sync().
+ * \param   drv    The cached drive
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data to be written
+ * \param   count  Sector count
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en dc_write (int drv, uint32_t sector, const uint8_t *buf, size_t count)
+{
+   dc_drive_t *d;
+   int i, n;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_dc[drv];
+   if (d->status != DRV_READY || !d->write || !buf || !count)
+      return DRV_ERROR;
+
+   if (count >= (size_t)d->lines) {
+      // Streaming write, write through and refresh the cached copies
+      if (d->write (drv, sector, buf, count) != DRV_READY)
+         return DRV_ERROR;
+      for (i=0 ; i<d->lines ; ++i)
+         if (d->line[i].valid && d->line[i].sector - sector < count) {
+            memcpy ((void*)_line_mem (d, i),
+                    (const void*)(buf + (size_t)(d->line[i].sector - sector)*DC_SECTOR_SIZE), DC_SECTOR_SIZE);
+            d->line[i].dirty = 0;
+         }
+      return DRV_READY;
+   }
+
+   while (count) {
+      if ((i = _lookup (d, sector)) >= 0)
+         n = 1;
+      else {
+         // Keep a run of new sectors in adjacent lines, so they write back together
+         for (n=1 ; (size_t)n<count && _lookup (d, sector+n) < 0 ; ++n)
+            ;
+         if ((i = _alloc (drv, sector, n)) < 0)
+            return DRV_ERROR;
+      }
+      memcpy ((void*)_line_mem (d, i), (const void*)buf, (size_t)n*DC_SECTOR_SIZE);
+      for (int j=i ; j<i+n ; ++j) {
+         d->line[j].valid = d->line[j].dirty = 1;
+         d->line[j].used = ++d->tick;
+      }
+      sector += n;
+      buf += (size_t)n*DC_SECTOR_SIZE;
+      count -= n;
+   }
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Write back all the dirty lines and sync the back-end.
+ * \param   drv   The cached drive
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en dc_sync (int drv)
+{
+   if (_bad_drive(drv))    return DRV_ERROR;
+   if (_dc[drv].status != DRV_READY)
+      return DRV_ERROR;
+   if (_writeback (drv, 0, _dc[drv].lines) != DRV_READY)
+      return DRV_ERROR;
+   return (_dc[drv].ioctl) ? _dc[drv].ioctl (drv, CTRL_SYNC, 0) : DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Write back all the dirty lines and empty the cache.
+ * \param   drv   The cached drive
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en dc_invalidate (int drv)
+{
+   if (_bad_drive(drv))    return DRV_ERROR;
+   if (_dc[drv].status != DRV_READY)
+      return DRV_ERROR;
+   if (_writeback (drv, 0, _dc[drv].lines) != DRV_READY)
+      return DRV_ERROR;
+   _drop (&_dc[drv]);
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Cache aware ioctl. CTRL_SYNC writes back the dirty lines first.
+ *    Commands that change the media, re-initialise it or power it off,
+ *    write back and empty the cache first. Power status queries and
+ *    power on leave the cache intact. Everything goes to the back-end's ioctl.
+ * \param   drv   The cached drive
+ * \param   ctrl  The command
+ * \param   buf   Pointer to buffer for ioctl
+ * \return  The status of the operation
+ */
+drv_status_en dc_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
+{
+   dc_drive_t *d;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_dc[drv];
+   if (d->status == DRV_READY) {
+      switch (ctrl) {
+         case CTRL_SYNC:
+            if (_writeback (drv, 0, d->lines) != DRV_READY)
+               return DRV_ERROR;
+            break;
+         case CTRL_POWER:           // Sub code 0 is power off
+            if (!buf || *(byte_t*)buf != 0)
+               break;
+            if (dc_invalidate (drv) != DRV_READY)
+               return DRV_ERROR;
+            break;
+         case CTRL_INIT:            // The media may have changed
+         case CTRL_DEINIT:
+         case CTRL_EJECT:
+         case CTRL_FORMAT:
+         case CTRL_ERASE_SECTOR:
+         case CTRL_ERASE_PAGE:
+         case CTRL_ERASE_ALL:
+            if (dc_invalidate (drv) != DRV_READY)
+               return DRV_ERROR;
+            break;
+         default:
+            break;
+      }
+   }
+   if (d->ioctl)
+      return d->ioctl (drv, ctrl, buf);
+   return (ctrl == CTRL_SYNC) ? DRV_READY : DRV_ERROR;
+}
+
+#undef _bad_drive
+#undef _line_mem
@@ -0,0 +1,382 @@
+/*
+ * \file dlog.c
+ * \brief
+ *    Binary deferred logging. The hot path captures the format, a
+ *    timestamp and the raw arguments to a lock-free ring and the
+ *    formatting is done later by a background consumer.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sys/dlog.h>
+
+/*!
+ * Memory barrier between the ring's data and index updates
+ */
+#define _dlog_barrier()    __sync_synchronize ()
+
+/*!
+ * Record buffer, aligned for the header
+ */
+typedef union {
+   dlog_rec_t  h;
+   byte_t      b[DLOG_MAX_RECORD];
+}_dlog_bf_t;
+
+/*
+ * ========= Static ============
+ */
+
+/*!
+ * \brief
+ *    Copy \a n bytes in to the ring at index \a i, wrapping around.
+ */
+static void _ring_in (dlog_t *lg, uint32_t i, const void *src, uint32_t n)
+{
+   uint32_t first;
+
+   i &= lg->size - 1;
+   first = lg->size - i;
+   if (first > n)
+      first = n;
+   memcpy ((void*)&lg->buf[i], src, first);
+   memcpy ((void*)lg->buf, (const byte_t*)src + first, n - first);
+}
+
+/*!
+ * \brief
+ *    Copy \a n bytes out of the ring from index \a i, wrapping around.
+ */
+static void _ring_out (dlog_t *lg, uint32_t i, void *dst, uint32_t n)
+{
+   uint32_t first;
+
+   i &= lg->size - 1;
+   first = lg->size - i;
+   if (first > n)
+      first = n;
+   memcpy (dst, (const void*)&lg->buf[i], first);
+   memcpy ((byte_t*)dst + first, (const void*)lg->buf, n - first);
+}
+
+/*!
+ * \brief
+ *    Convert a timestamp to nsec
+ */
+static uint64_t _ts2nsec (dlog_t *lg, jiffy64_t ts)
+{
+   uint64_t f = lg->freq;
+
+   if (!f)
+      return jf_jiffy2nsec (ts);
+   return (ts / f) * 1000000000ULL + ((ts % f) * 1000000000ULL) / f;
+}
+
+/*
+ * =================== Public API =====================
+ */
+
+/*
+ * Link and Glue functions
+ */
+
+/*!
+ * \brief
+ *    Link a timestamp source. The default is \sa jf_get_jiffy64().
+ * \param   lg    Pointer to deferred log
+ * \param   clk   Pointer to the timestamp source, or null for the default
+ * \param   freq  The source's frequency, 0 for the jiffies one
+ */
+void dlog_link_clock (dlog_t *lg, jf_clock64_pt clk, uint32_t freq)
+{
+   lg->clock = (clk) ? clk : jf_get_jiffy64;
+   lg->freq = (clk) ? freq : 0;
+}
+
+/*
+ * Set functions
+ */
+
+/*!
+ * \brief
+ *    Enable or disable the "[sec.usec] " timestamp prefix of the
+ *    formatted records.
+ */
+inline void dlog_set_stamp (dlog_t *lg, uint8_t en) {
+   lg->stamp = en;
+}
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Initialize a deferred log.
+ *
+ * \param   lg    Pointer to deferred log
+ * \param   mem   Pointer to the ring's memory
+ * \param   size  The ring's size. Must be power of 2 and not smaller than DLOG_MAX_RECORD
+ * \return  The status of operation
+ *    \arg  0  Wrong size
+ *    \arg  1  Done
+ */
+int dlog_init (dlog_t *lg, void *mem, uint32_t size)
+{
+   if (!mem || !size || (size & (size-1)) || size < DLOG_MAX_RECORD)
+      return 0;
+   lg->buf = (byte_t*)mem;
+   lg->size = size;
+   lg->head = lg->tail = 0;
+   lg->dropped = 0;
+   lg->stamp = 0;
+   dlog_link_clock (lg, 0, 0);
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Return the number of records dropped since init.
+ */
+inline uint32_t dlog_dropped (dlog_t *lg) {
+   return lg->dropped;
+}
+
+/*!
+ * \brief
+ *    Capture a log record. No formatting is done here. The compiled
+ *    format gives the argument types, so the arguments are copied out
+ *    of the va_list as raw values.
+ *
+ * \param   lg    Pointer to deferred log (producer side)
+ * \param   cf    Compiled format \sa io_frm_static(), _io_compile()
+ * \param   ap    Argument list
+ * \return  The status of operation
+ *    \arg  0  Dropped, ring full or format too big
+ *    \arg  1  Done
+ */
+__O3__ int vdlog_frm (dlog_t *lg, _io_frm_t *cf, __VALIST ap)
+{
+   _dlog_bf_t r;
+   const _io_op_t *op, *end;
+   uint32_t p = sizeof (dlog_rec_t), head;
+   int nargs = 0, nv, i;
+   _io_arg_class_en cl[3];
+   _io_arg_t a;
+   const char *s;
+   size_t len;
+
+   r.h.ts = lg->clock ();
+   if (!cf->n && cf->frm && _io_compile (cf, cf->frm, cf->op, cf->size) < 0) {
+      ++lg->dropped;
+      return 0;
+   }
+   r.h.cf = cf;
+   r.h.flags = 0;
+   for (op = cf->op, end = op + cf->n ; op < end ; ++op) {
+      if (op->type != _IO_FRM_SPECIFIER)
+         continue;
+      // The '*' ones first
+      nv = 0;
+      if (op->spec.flags.vwidth)    cl[nv++] = _IO_ARG_INT;
+      if (op->spec.flags.vfrac)     cl[nv++] = _IO_ARG_INT;
+      cl[nv++] = _io_arg_class (&op->spec);
+      for (i=0 ; i<nv ; ++i) {
+         // Always consume the argument, capture it only if it fits
+         switch (cl[i]) {
+            case _IO_ARG_DOUBLE:
+               a.d = va_arg (ap, double);
+               len = sizeof (double);
+               break;
+            case _IO_ARG_INT64:
+            case _IO_ARG_UINT64:
+               a.ull = va_arg (ap, unsigned long long);
+               len = sizeof (long long);
+               break;
+            case _IO_ARG_STR:
+               s = va_arg (ap, const char*);
+               len = (s) ? strlen (s) : 0;
+               if (len > DLOG_MAX_STR)
+                  len = DLOG_MAX_STR;
+               break;
+            case _IO_ARG_INT:
+               a.i = va_arg (ap, int);
+               len = sizeof (int);
+               break;
+            default:
+               a.u = va_arg (ap, unsigned int);
+               len = sizeof (int);
+               break;
+         }
+         if (r.h.flags & DLOG_REC_TRUNC)
+            continue;
+         if (nargs >= DLOG_MAX_ARGS ||
+             p + len + ((cl[i] == _IO_ARG_STR) ? 2 : 0) > DLOG_MAX_RECORD) {
+            r.h.flags |= DLOG_REC_TRUNC;
+            continue;
+         }
+         if (cl[i] == _IO_ARG_STR) {
+            r.b[p++] = (byte_t)len;
+            if (len)
+               memcpy ((void*)&r.b[p], (const void*)s, len);
+            p += len;
+            r.b[p++] = 0;
+         }
+         else {
+            memcpy ((void*)&r.b[p], (const void*)&a, len);
+            p += len;
+         }
+         ++nargs;
+      }
+   }
+   r.h.nargs = (uint8_t)nargs;
+   r.h.size = (uint16_t)p;
+
+   // Push the record, all or nothing
+   head = lg->head;
+   if (lg->size - (head - lg->tail) < p) {
+      ++lg->dropped;
+      return 0;
+   }
+   _ring_in (lg, head, (const void*)r.b, p);
+   _dlog_barrier ();
+   lg->head = head + p;
+   return 1;
+}
+
+/*!
+ * \brief
+ *    Capture a log record, using a variable number of arguments.
+ *    \sa vdlog_frm()
+ */
+int dlog_frm (dlog_t *lg, _io_frm_t *cf, ...)
+{
+   __VALIST ap;
+   int result;
+
+   va_start(ap, cf);
+   result = vdlog_frm(lg, cf, ap);
+   va_end(ap);
+
+   return result;
+}
+
+/*!
+ * \brief
+ *    Pop the next raw record from the ring (consumer side). The record
+ *    can be formatted with \sa dlog_format() or sent as is to a host-side
+ *    decoder.
+ *
+ * \param   lg    Pointer to deferred log
+ * \param   rec   Pointer to record buffer
+ * \param   size  The buffer's size. Use at least DLOG_MAX_RECORD
+ * \return  The record's size, or 0 if there is no record (or it does not fit)
+ */
+uint32_t dlog_pop (dlog_t *lg, void *rec, uint32_t size)
+{
+   uint32_t tail = lg->tail;
+   dlog_rec_t h;
+
+   if (lg->head == tail)
+      return 0;
+   _dlog_barrier ();
+   _ring_out (lg, tail, (void*)&h, sizeof (h));
+   if (h.size > size)
+      return 0;
+   _ring_out (lg, tail, rec, h.size);
+   _dlog_barrier ();
+   lg->tail = tail + h.size;
+   return h.size;
+}
+
+/*!
+ * \brief
+ *    Format a popped record to a sink, using the vsxprintf engine.
+ *
+ * \param   lg    Pointer to deferred log
+ * \param   rec   Pointer to record, \sa dlog_pop()
+ * \param   sk    The output sink
+ * \return  The number of characters streamed
+ */
+int dlog_format (dlog_t *lg, const void *rec, _io_sink_t *sk)
+{
+   io_frm_static (_stamp_frm, "[%u.%06u] ");
+   const dlog_rec_t *h = (const dlog_rec_t *)rec;
+   const byte_t *b = (const byte_t *)rec;
+   _io_arg_t args[DLOG_MAX_ARGS];
+   const _io_op_t *op, *end;
+   uint32_t p = sizeof (dlog_rec_t);
+   uint64_t ns;
+   int n = 0, num = 0, nv, i;
+   _io_arg_class_en cl[3];
+
+   if (lg->stamp) {
+      ns = _ts2nsec (lg, h->ts);
+      args[0].u = (unsigned int)(ns / 1000000000ULL);
+      args[1].u = (unsigned int)((ns % 1000000000ULL) / 1000);
+      num = vsxprintf_args (sk, &_stamp_frm, args, 2);
+   }
+   // Unpack the arguments in the format's order
+   for (op = h->cf->op, end = op + h->cf->n ; op < end && n < h->nargs ; ++op) {
+      if (op->type != _IO_FRM_SPECIFIER)
+         continue;
+      nv = 0;
+      if (op->spec.flags.vwidth)    cl[nv++] = _IO_ARG_INT;
+      if (op->spec.flags.vfrac)     cl[nv++] = _IO_ARG_INT;
+      cl[nv++] = _io_arg_class (&op->spec);
+      for (i=0 ; i<nv && n < h->nargs ; ++i, ++n) {
+         if (cl[i] == _IO_ARG_STR) {
+            args[n].s = (const char*)&b[p+1];
+            p += b[p] + 2;
+         }
+         else if (cl[i] == _IO_ARG_DOUBLE) {
+            memcpy ((void*)&args[n].d, (const void*)&b[p], sizeof (double));
+            p += sizeof (double);
+         }
+         else if (cl[i] == _IO_ARG_INT64 || cl[i] == _IO_ARG_UINT64) {
+            memcpy ((void*)&args[n].ull, (const void*)&b[p], sizeof (long long));
+            p += sizeof (long long);
+         }
+         else {
+            memcpy ((void*)&args[n].u, (const void*)&b[p], sizeof (int));
+            p += sizeof (int);
+         }
+      }
+   }
+   return num + vsxprintf_args (sk, h->cf, args, n);
+}
+
+/*!
+ * \brief
+ *    Format all the pending records to a sink and flush it. This is the
+ *    background consumer.
+ *
+ * \param   lg    Pointer to deferred log
+ * \param   sk    The output sink
+ * \return  The number of formatted records
+ */
+int dlog_flush (dlog_t *lg, _io_sink_t *sk)
+{
+   _dlog_bf_t r;
+   int n;
+
+   for (n=0 ; dlog_pop (lg, (void*)r.b, sizeof (r)) ; ++n)
+      dlog_format (lg, (const void*)r.b, sk);
+   _sink_flush (sk);
+   return n;
+}
@@ -0,0 +1,386 @@
+/*!
+ * \file hostdisk.c
+ * \brief
+ *    RAM-disk and host image file block device, with I/O statistics and
+ *    timing injection, for testing and benchmarking the diskio path.
+ *
+ * This file is part of toolbox
+ *
+ * Copyright (C) 2026 Houtouridis Christos (http://www.houtouridis.net)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if defined (__linux__)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE    200809L
+#endif
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <sys/hostdisk.h>
+
+static hd_drive_t _hd[HD_NUMBER_OF_DRIVES];
+
+/*
+ * tools
+ */
+#define _bad_drive(_dr)    ((_dr)<0 || (_dr)>=HD_NUMBER_OF_DRIVES) ? 1:0
+
+/*
+ * ========= Static ============
+ */
+
+//! Busy wait for \p nsec. No wait without a time base, it would never end
+static void _delay_ns (uint64_t nsec)
+{
+   uint64_t end;
+
+   if (!nsec || !jf_get_freq64 ())
+      return;
+   end = jf_get_nsec64 () + nsec;
+   while (jf_get_nsec64 () < end)
+      ;
+}
+
+/*!
+ * \brief
+ *    Apply the timing model to an access and update the statistics
+ * \param   drv      The host disk
+ * \param   write    Write access flag
+ * \param   sector   The first sector of the access
+ * \param   count    The sector count
+ * \param   start    The access's start time
+ */
+static void _account (int drv, uint8_t write, uint32_t sector, size_t count, uint64_t start)
+{
+   hd_drive_t *d = &_hd[drv];
+   uint8_t seq = (sector == d->next);
+   uint32_t nsec;
+   int b;
+
+   _delay_ns ((uint64_t)d->timing.cmd_nsec
+            + ((seq) ? 0 : d->timing.seek_nsec)
+            + (uint64_t)count * ((write) ? d->timing.wr_nsec : d->timing.rd_nsec));
+   nsec = (uint32_t)(jf_get_nsec64 () - start);
+
+   for (b=0 ; b<HD_HIST_SIZE-1 && (count >> (b+1)) ; ++b)
+      ;
+   ++d->stats.hist[b];
+   if (write) {
+      ++d->stats.writes;
+      d->stats.wr_sectors += count;
+      d->stats.wr_seq += seq;
+      d->stats.wr_nsec += nsec;
+      if (nsec > d->stats.wr_max_nsec)  d->stats.wr_max_nsec = nsec;
+   }
+   else {
+      ++d->stats.reads;
+      d->stats.rd_sectors += count;
+      d->stats.rd_seq += seq;
+      d->stats.rd_nsec += nsec;
+      if (nsec > d->stats.rd_max_nsec)  d->stats.rd_max_nsec = nsec;
+   }
+   d->next = sector + count;
+   if (d->trace)
+      d->trace (drv, write, sector, count, nsec);
+}
+
+//! \return True if the access is outside of the disk
+static int _out_of_range (hd_drive_t *d, uint32_t sector, size_t count)
+{
+   return (sector >= d->sectors || count > d->sectors - sector);
+}
+
+
+/*
+ * ============================ Public Functions ============================
+ */
+
+/*
+ * Link and Glue functions
+ */
+void hd_link_trace (int drv, hd_trace_ft fun) {
+   if (_bad_drive(drv))
+      return;
+   _hd[drv].trace = fun;
+}
+
+/*
+ * Set functions
+ */
+
+/*!
+ * \brief
+ *    Set the timing model of a disk. The delays need a jiffy time base,
+ *    \sa jf_link_clock64(); without one they are skipped.
+ * \param   drv   The host disk
+ * \param   t     Pointer to timing model, or NULL for no delays
+ */
+void hd_set_timing (int drv, const hd_timing_t *t) {
+   if (_bad_drive(drv))
+      return;
+   if (t)   _hd[drv].timing = *t;
+   else     memset ((void*)&_hd[drv].timing, 0, sizeof (hd_timing_t));
+}
+
+/*!
+ * \brief
+ *    Set the write protect flag of a disk
+ */
+void hd_set_wp (int drv, uint8_t on) {
+   if (_bad_drive(drv))
+      return;
+   _hd[drv].wp = on;
+}
+
+/*
+ * User Functions
+ */
+
+/*!
+ * \brief
+ *    Initialise a RAM disk
+ * \param   drv      The host disk
+ * \param   mem      Pointer to the disk's memory
+ * \param   sectors  The disk's size in sectors
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en hd_init_ram (int drv, void *mem, uint32_t sectors)
+{
+   if (_bad_drive(drv))    return DRV_ERROR;
+   if (!mem || !sectors)   return DRV_ERROR;
+   hd_deinit (drv);
+   _hd[drv].mem = (uint8_t*)mem;
+   _hd[drv].sectors = sectors;
+   _hd[drv].fd = -1;
+   return _hd[drv].status = DRV_READY;
+}
+
+#if defined (__linux__)
+/*!
+ * \brief
+ *    Initialise a disk on a host image file. The file is mapped to memory
+ *    and extended to \a sectors if it is smaller.
+ * \param   drv      The host disk
+ * \param   path     The image file's path
+ * \param   sectors  The disk's size in sectors, or 0 to use the file's size
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en hd_init_file (int drv, const char *path, uint32_t sectors)
+{
+   struct stat st;
+   void *m;
+   int fd;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   if ((fd = open (path, O_RDWR | O_CREAT, 0644)) < 0)
+      return DRV_ERROR;
+   if (fstat (fd, &st) < 0)
+      goto _error;
+   if (!sectors)
+      sectors = (uint32_t)(st.st_size / HD_SECTOR_SIZE);
+   if (!sectors)
+      goto _error;
+   if (st.st_size < (off_t)sectors * HD_SECTOR_SIZE
+       && ftruncate (fd, (off_t)sectors * HD_SECTOR_SIZE) < 0)
+      goto _error;
+   m = mmap (0, (size_t)sectors * HD_SECTOR_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (m == MAP_FAILED)
+      goto _error;
+
+   hd_deinit (drv);
+   _hd[drv].mem = (uint8_t*)m;
+   _hd[drv].sectors = sectors;
+   _hd[drv].fd = fd;
+   return _hd[drv].status = DRV_READY;
+
+_error:
+   close (fd);
+   return DRV_ERROR;
+}
+#endif
+
+/*!
+ * \brief
+ *    De-initialise a disk. Image files are synced and unmapped. The timing,
+ *    the trace and the write protect settings are kept.
+ * \param   drv   The host disk
+ */
+void hd_deinit (int drv)
+{
+   if (_bad_drive(drv))
+      return;
+#if defined (__linux__)
+   if (_hd[drv].status == DRV_READY && _hd[drv].fd >= 0) {
+      msync ((void*)_hd[drv].mem, (size_t)_hd[drv].sectors * HD_SECTOR_SIZE, MS_SYNC);
+      munmap ((void*)_hd[drv].mem, (size_t)_hd[drv].sectors * HD_SECTOR_SIZE);
+      close (_hd[drv].fd);
+   }
+#endif
+   _hd[drv].mem = 0;
+   _hd[drv].sectors = _hd[drv].next = 0;
+   _hd[drv].fd = -1;
+   memset ((void*)&_hd[drv].stats, 0, sizeof (hd_stats_t));
+   _hd[drv].status = DRV_NOINIT;
+}
+
+/*!
+ * \brief
+ *    Read sector(s)
+ * \param   drv    The host disk
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data buffer to store read data
+ * \param   count  Sector count
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en hd_read (int drv, uint32_t sector, uint8_t *buf, size_t count)
+{
+   hd_drive_t *d;
+   uint64_t start;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_hd[drv];
+   if (d->status != DRV_READY || !buf || !count || _out_of_range (d, sector, count))
+      return DRV_ERROR;
+
+   start = jf_get_nsec64 ();
+   memcpy ((void*)buf, (const void*)(d->mem + (size_t)sector*HD_SECTOR_SIZE), count*HD_SECTOR_SIZE);
+   _account (drv, 0, sector, count, start);
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Write sector(s)
+ * \param   drv    The host disk
+ * \param   sector Start sector number (LBA)
+ * \param   buf    Pointer to the data to be written
+ * \param   count  Sector count
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en hd_write (int drv, uint32_t sector, const uint8_t *buf, size_t count)
+{
+   hd_drive_t *d;
+   uint64_t start;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_hd[drv];
+   if (d->status != DRV_READY || d->wp || !buf || !count || _out_of_range (d, sector, count))
+      return DRV_ERROR;
+
+   start = jf_get_nsec64 ();
+   memcpy ((void*)(d->mem + (size_t)sector*HD_SECTOR_SIZE), (const void*)buf, count*HD_SECTOR_SIZE);
+   _account (drv, 1, sector, count, start);
+   return DRV_READY;
+}
+
+/*!
+ * \brief
+ *    Disk control
+ * \param   drv   The host disk
+ * \param   ctrl  The command
+ *    \arg CTRL_SYNC
+ *    \arg CTRL_GET_SECTOR_COUNT
+ *    \arg CTRL_GET_SECTOR_SIZE
+ *    \arg CTRL_GET_BLOCK_SIZE
+ *    \arg CTRL_ERASE_SECTOR     buf points to the start and end sectors (uint32_t[2])
+ *    \arg CTRL_DEINIT
+ * \param   buf   Pointer to buffer for ioctl
+ * \return  The status of the operation
+ *    \arg  DRV_ERROR   On error.
+ *    \arg  DRV_READY   On success.
+ */
+drv_status_en hd_ioctl (int drv, ioctl_cmd_t ctrl, ioctl_buf_t buf)
+{
+   hd_drive_t *d;
+   uint32_t *r = (uint32_t*)buf;
+
+   if (_bad_drive(drv))    return DRV_ERROR;
+   d = &_hd[drv];
+   if (d->status != DRV_READY)
+      return DRV_ERROR;
+
+   switch (ctrl) {
+      case CTRL_SYNC:
+#if defined (__linux__)
+         if (d->fd >= 0 && msync ((void*)d->mem, (size_t)d->sectors * HD_SECTOR_SIZE, MS_SYNC) < 0)
+            return DRV_ERROR;
+#endif
+         if (buf)
+            *(drv_status_en*)buf = DRV_READY;
+         return DRV_READY;
+
+      case CTRL_GET_SECTOR_COUNT:
+         *(uint32_t*)buf = d->sectors;
+         return DRV_READY;
+
+      case CTRL_GET_SECTOR_SIZE:
+         *(uint16_t*)buf = HD_SECTOR_SIZE;
+         return DRV_READY;
+
+      case CTRL_GET_BLOCK_SIZE:
+         *(uint32_t*)buf = 1;
+         return DRV_READY;
+
+      case CTRL_ERASE_SECTOR:
+         if (d->wp || r[0] > r[1] || r[1] >= d->sectors)
+            return DRV_ERROR;
+         memset ((void*)(d->mem + (size_t)r[0]*HD_SECTOR_SIZE), 0xFF, (size_t)(r[1] - r[0] + 1)*HD_SECTOR_SIZE);
+         return DRV_READY;
+
+      case CTRL_DEINIT:
+         hd_deinit (drv);
+         return DRV_READY;
+
+      default:
+         return DRV_ERROR;
+   }
+}
+
+/*!
+ * \brief
+ *    Get a copy of the disk's I/O statistics
+ * \param   drv   The host disk
+ * \param   st    Pointer to statistics to fill
+ */
+void hd_get_stats (int drv, hd_stats_t *st) {
+   if (_bad_drive(drv) || !st)
+      return;
+   *st = _hd[drv].stats;
+}
+
+/*!
+ * \brief
+ *    Clear the disk's I/O statistics
+ * \param   drv   The host disk
+ */
+void hd_clear_stats (int drv) {
+   if (_bad_drive(drv))
+      return;
+   memset ((void*)&_hd[drv].stats, 0, sizeof (hd_stats_t));
+}
+
+#undef _bad_drive
@@ -21,6 +21,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#if defined (__linux__)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE    199309L
+#endif
+#include <time.h>
+#endif
 #include <sys/jiffies.h>
 
 static jf_t _jf;
@@ -54,6 +60,32 @@ void jf_link_value (jiffy_t* v) {
    _jf.value = (v != 0) ? v : 0;
 }
 
+/*!
+ * \brief
+ *    Connect an optional free running 64bit clock source to jiffy struct.
+ *    When linked, the 64bit time base uses this instead of the wrap counted
+ *    jiffy timer.
+ * \param   pfun  Pointer to the clock read function (0 to un-link)
+ * \param   freq  The clock's frequency in Hz
+ */
+void jf_link_clock64 (jf_clock64_pt pfun, uint32_t freq) {
+   _jf.clock64 = (pfun != 0) ? pfun : 0;
+   _jf.freq64 = (pfun != 0) ? freq : 0;
+}
+
+/*!
+ * \brief
+ *    Connect an optional critical section to jiffy struct. It guards the
+ *    wrap counting of the 64bit time base, when jf_get_jiffy64() is called
+ *    from more than one context (ex: interrupt and thread).
+ * \param   lock     Pointer to the enter function (0 to un-link)
+ * \param   unlock   Pointer to the exit function (0 to un-link)
+ */
+void jf_link_lock (jf_lock_pt lock, jf_lock_pt unlock) {
+   _jf.lock = (lock != 0 && unlock != 0) ? lock : 0;
+   _jf.unlock = (lock != 0 && unlock != 0) ? unlock : 0;
+}
+
 
 
 /*
@@ -367,3 +399,106 @@ __O3__ int jf_check_100nsec (jtime_t _100nsec)
       return 0;   // do not wait any more
    }
 }
+
+
+/*
+ * 64bit monotonic time base
+ */
+
+/*!
+ * \brief
+ *    Return the current 64bit monotonic jiffy value.
+ *    If there is a linked 64bit clock source, its value is returned.
+ *    Otherwise the jiffy timer is extended by counting its wraps.
+ * \note
+ *    In the wrap counted case this function has to be called at least
+ *    once every timer period, or else a wrap is lost. The update runs
+ *    inside the linked critical section, if any, \sa jf_link_lock().
+ * \return  The extended jiffy value or zero if there is no linked timer
+ */
+__O3__ jiffy64_t jf_get_jiffy64 (void)
+{
+   jiffy_t     v;
+   jiffy64_t   r;
+
+   if (_jf.clock64)
+      return _jf.clock64 ();
+   if (!_jf.value)
+      return 0;
+
+   if (_jf.lock)
+      _jf.lock ();
+   v = *_jf.value;
+   if (v >= _jf.last)   _jf.ext += v - _jf.last;
+   else                 _jf.ext += (jiffy64_t)_jf.jiffies + 1 - _jf.last + v;
+   _jf.last = v;
+   r = _jf.ext;
+   if (_jf.unlock)
+      _jf.unlock ();
+   return r;
+}
+
+/*!
+ * \brief
+ *    Return the frequency of the 64bit time base in Hz.
+ */
+inline uint32_t jf_get_freq64 (void) {
+   return (_jf.clock64) ? _jf.freq64 : _jf.freq;
+}
+
+/*!
+ * \brief
+ *    Convert a 64bit jiffy value (or difference) to nsec.
+ * \note
+ *    The calculation is split in whole seconds and remainder, so there is
+ *    no overflow for the entire 64bit range of the result.
+ * \param   j     The jiffies to convert
+ * \return  The time in nsec, or zero if the time base has no frequency
+ */
+__O3__ uint64_t jf_jiffy2nsec (jiffy64_t j)
+{
+   uint64_t f = jf_get_freq64 ();
+
+   if (!f)  return 0;
+   return (j / f) * 1000000000ULL + ((j % f) * 1000000000ULL) / f;
+}
+
+/*!
+ * \brief
+ *    Convert nsec to 64bit jiffies, rounded down.
+ * \param   nsec  The time in nsec
+ * \return  The corresponding jiffies of the 64bit time base
+ */
+__O3__ jiffy64_t jf_nsec2jiffy (uint64_t nsec)
+{
+   uint64_t f = jf_get_freq64 ();
+
+   return (nsec / 1000000000ULL) * f + ((nsec % 1000000000ULL) * f) / 1000000000ULL;
+}
+
+/*!
+ * \brief
+ *    Return the current 64bit monotonic time in nsec.
+ */
+inline uint64_t jf_get_nsec64 (void) {
+   return jf_jiffy2nsec (jf_get_jiffy64 ());
+}
+
+#if defined (__linux__)
+/*!
+ * \brief
+ *    A 64bit clock source for linux targets, with nsec resolution.
+ *    Use it as:
+ *    \code
+ *       jf_link_clock64 (jf_clock64_monotonic, 1000000000);
+ *    \endcode
+ * \return  The CLOCK_MONOTONIC_RAW time in nsec
+ */
+jiffy64_t jf_clock64_monotonic (void)
+{
+   struct timespec ts;
+
+   clock_gettime (CLOCK_MONOTONIC_RAW, &ts);
+   return (jiffy64_t)ts.tv_sec * 1000000000ULL + (jiffy64_t)ts.tv_nsec;
+}
+#endif